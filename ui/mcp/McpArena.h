@@ -0,0 +1,277 @@
+//---------------------------------------------------------------------------
+// McpArena.h — Per-request arena for the server's call bookkeeping
+//
+// A request allocates a handful of small shared objects (the call record,
+// tool context, cancellation token, response promise, batch state) that
+// all die together when the response has been sent. TMcpArena hands them
+// out from one bump-allocated chunk and frees the whole chunk in one go
+// when the last of them is released - on whichever thread that happens.
+// Chunks are recycled per thread, so a steady stream of requests does not
+// touch the heap for these objects at all.
+// Pure C++ - NO VCL dependencies.
+//---------------------------------------------------------------------------
+
+#ifndef McpArenaH
+#define McpArenaH
+
+//---------------------------------------------------------------------------
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace Mcp {
+
+//---------------------------------------------------------------------------
+// TMcpArena — reference-counted bump allocator
+//
+// Every allocation holds a reference; deallocation only drops it, and the
+// memory is reclaimed when the count reaches zero. Allocation is for the
+// thread that made the arena current (see TMcpArenaScope); releasing is
+// thread-safe.
+//---------------------------------------------------------------------------
+class TMcpArena
+{
+public:
+    static constexpr size_t ChunkSize = 4096;
+    static constexpr size_t MaxCachedChunks = 16;     // per thread
+
+private:
+    struct TChunk
+    {
+        TChunk *Next;
+        size_t Size;
+    };
+
+    struct TChunkCache
+    {
+        TChunk *Head = nullptr;
+        size_t Count = 0;
+
+        ~TChunkCache()
+        {
+            while (Head)
+            {
+                TChunk *next = Head->Next;
+                ::operator delete(Head);
+                Head = next;
+            }
+        }
+    };
+
+    static constexpr size_t Alignment = alignof(std::max_align_t);
+
+    std::atomic<size_t> FRefs{1};
+    TChunk *FChunks;                // newest first; the last one holds *this
+    char *FCursor;
+    char *FEnd;
+
+    TMcpArena(TChunk *chunk, char *cursor, char *end)
+        : FChunks(chunk), FCursor(cursor), FEnd(end)
+    {}
+
+    ~TMcpArena() = default;
+
+public:
+    TMcpArena(const TMcpArena&) = delete;
+    TMcpArena& operator=(const TMcpArena&) = delete;
+
+    // Returns an arena holding one reference, for the caller to Release
+    static TMcpArena* Create()
+    {
+        TChunk *chunk = TakeChunk(ChunkSize);
+        char *base = reinterpret_cast<char*>(chunk) + AlignUp(sizeof(TChunk));
+        char *end = reinterpret_cast<char*>(chunk) + ChunkSize;
+        return new (base) TMcpArena(chunk, base + AlignUp(sizeof(TMcpArena)), end);
+    }
+
+    // The arena current on this thread, or nullptr
+    static TMcpArena*& Current()
+    {
+        thread_local TMcpArena *current = nullptr;
+        return current;
+    }
+
+    void* Allocate(size_t bytes)
+    {
+        bytes = AlignUp(bytes);
+        if (bytes > static_cast<size_t>(FEnd - FCursor))
+            Grow(bytes);
+        void *p = FCursor;
+        FCursor += bytes;
+        AddRef();
+        return p;
+    }
+
+    void AddRef() { FRefs.fetch_add(1, std::memory_order_relaxed); }
+
+    void Release()
+    {
+        if (FRefs.fetch_sub(1, std::memory_order_acq_rel) != 1)
+            return;
+
+        TChunk *chunk = FChunks;
+        this->~TMcpArena();
+        while (chunk)
+        {
+            TChunk *next = chunk->Next;
+            GiveChunk(chunk);
+            chunk = next;
+        }
+    }
+
+private:
+    static size_t AlignUp(size_t size)
+    {
+        return (size + Alignment - 1) & ~(Alignment - 1);
+    }
+
+    void Grow(size_t bytes)
+    {
+        size_t header = AlignUp(sizeof(TChunk));
+        size_t size = header + bytes > ChunkSize ? header + bytes : ChunkSize;
+        TChunk *chunk = TakeChunk(size);
+        chunk->Next = FChunks;
+        FChunks = chunk;
+        FCursor = reinterpret_cast<char*>(chunk) + header;
+        FEnd = reinterpret_cast<char*>(chunk) + size;
+    }
+
+    static TChunkCache& Cache()
+    {
+        thread_local TChunkCache cache;
+        return cache;
+    }
+
+    static TChunk* TakeChunk(size_t size)
+    {
+        TChunkCache &cache = Cache();
+        TChunk *chunk;
+        if (size == ChunkSize && cache.Head)
+        {
+            chunk = cache.Head;
+            cache.Head = chunk->Next;
+            cache.Count--;
+        }
+        else
+        {
+            chunk = static_cast<TChunk*>(::operator new(size));
+        }
+        chunk->Next = nullptr;
+        chunk->Size = size;
+        return chunk;
+    }
+
+    static void GiveChunk(TChunk *chunk)
+    {
+        TChunkCache &cache = Cache();
+        if (chunk->Size != ChunkSize || cache.Count >= MaxCachedChunks)
+        {
+            ::operator delete(chunk);
+            return;
+        }
+        chunk->Next = cache.Head;
+        cache.Head = chunk;
+        cache.Count++;
+    }
+};
+
+//---------------------------------------------------------------------------
+// TMcpArenaAllocator — standard allocator over a TMcpArena
+//
+// A null arena falls back to the global heap, so containers and
+// allocate_shared can use it whether or not an arena is current.
+//---------------------------------------------------------------------------
+template<typename T>
+class TMcpArenaAllocator
+{
+private:
+    TMcpArena *FArena;
+
+public:
+    using value_type = T;
+
+    explicit TMcpArenaAllocator(TMcpArena *arena = TMcpArena::Current()) noexcept
+        : FArena(arena)
+    {}
+
+    template<typename U>
+    TMcpArenaAllocator(const TMcpArenaAllocator<U> &other) noexcept
+        : FArena(other.GetArena())
+    {}
+
+    TMcpArena* GetArena() const noexcept { return FArena; }
+
+    T* allocate(size_t count)
+    {
+        if (!FArena)
+            return static_cast<T*>(::operator new(count * sizeof(T)));
+        return static_cast<T*>(FArena->Allocate(count * sizeof(T)));
+    }
+
+    void deallocate(T *p, size_t) noexcept
+    {
+        if (!FArena)
+            ::operator delete(p);
+        else
+            FArena->Release();
+    }
+
+    template<typename U>
+    bool operator==(const TMcpArenaAllocator<U> &other) const noexcept
+    {
+        return FArena == other.GetArena();
+    }
+
+    template<typename U>
+    bool operator!=(const TMcpArenaAllocator<U> &other) const noexcept
+    {
+        return FArena != other.GetArena();
+    }
+};
+
+//---------------------------------------------------------------------------
+// TMcpArenaScope — makes a fresh arena current for the enclosing scope
+//
+// Nested scopes keep the outer arena. The scope's own reference is dropped
+// on exit; objects still alive keep the arena until they are released.
+//---------------------------------------------------------------------------
+class TMcpArenaScope
+{
+private:
+    TMcpArena *FArena = nullptr;
+
+public:
+    TMcpArenaScope()
+    {
+        if (TMcpArena::Current())
+            return;
+        FArena = TMcpArena::Create();
+        TMcpArena::Current() = FArena;
+    }
+
+    ~TMcpArenaScope()
+    {
+        if (!FArena)
+            return;
+        TMcpArena::Current() = nullptr;
+        FArena->Release();
+    }
+
+    TMcpArenaScope(const TMcpArenaScope&) = delete;
+    TMcpArenaScope& operator=(const TMcpArenaScope&) = delete;
+};
+
+// make_shared from the current arena (the heap when there is none)
+template<typename T, typename... TArgs>
+std::shared_ptr<T> McpMakeShared(TArgs&&... args)
+{
+    return std::allocate_shared<T>(TMcpArenaAllocator<T>(), std::forward<TArgs>(args)...);
+}
+
+} // namespace Mcp
+
+//---------------------------------------------------------------------------
+#endif // McpArenaH
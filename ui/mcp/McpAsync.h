@@ -0,0 +1,479 @@
+//---------------------------------------------------------------------------
+// McpAsync.h — Building blocks for asynchronous MCP tools
+//
+// TMcpTimerService runs delayed callbacks on one shared thread, and
+// TMcpCounterWaiter completes waiters when a published counter reaches
+// their target. Together they let a tool wait for application events
+// without holding a thread per waiting call. TMcpCancellationToken tells
+// running work that its request was cancelled, and TMcpConcurrencyLimiter
+// caps how many calls of one kind run at once.
+// Pure C++ - NO VCL dependencies.
+//---------------------------------------------------------------------------
+
+#ifndef McpAsyncH
+#define McpAsyncH
+
+//---------------------------------------------------------------------------
+#include <cstdint>
+#include <chrono>
+#include <map>
+#include <list>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <string>
+#include <atomic>
+
+namespace Mcp {
+
+//---------------------------------------------------------------------------
+// TMcpTimerService — one thread firing scheduled callbacks in due order
+//
+// Callbacks run on the timer thread, outside the service lock, and must
+// not block it for long. Pending callbacks are dropped on destruction.
+//---------------------------------------------------------------------------
+class TMcpTimerService
+{
+public:
+    using TClock = std::chrono::steady_clock;
+    using TTimerId = uint64_t;
+
+private:
+    struct TKey
+    {
+        TClock::time_point Due;
+        TTimerId Id;
+
+        bool operator<(const TKey &other) const
+        {
+            return Due < other.Due || (Due == other.Due && Id < other.Id);
+        }
+    };
+
+    std::map<TKey, std::function<void()>> FTimers;
+    std::map<TTimerId, TClock::time_point> FDueById;
+    TTimerId FNextId = 1;
+    std::mutex FMutex;
+    std::condition_variable FCondition;
+    bool FStopping = false;
+    std::thread FThread;
+
+public:
+    TMcpTimerService()
+        : FThread([this]() { TimerLoop(); })
+    {}
+
+    ~TMcpTimerService()
+    {
+        {
+            std::lock_guard<std::mutex> lock(FMutex);
+            FStopping = true;
+        }
+        FCondition.notify_all();
+        FThread.join();
+    }
+
+    TMcpTimerService(const TMcpTimerService&) = delete;
+    TMcpTimerService& operator=(const TMcpTimerService&) = delete;
+
+    TTimerId Schedule(std::chrono::milliseconds delay, std::function<void()> func)
+    {
+        TTimerId id;
+        {
+            std::lock_guard<std::mutex> lock(FMutex);
+            id = FNextId++;
+            TClock::time_point due = TClock::now() + delay;
+            FTimers.emplace(TKey{due, id}, std::move(func));
+            FDueById.emplace(id, due);
+        }
+        FCondition.notify_one();
+        return id;
+    }
+
+    // Returns true if the callback was removed before it started
+    bool Cancel(TTimerId id)
+    {
+        std::function<void()> func;  // destroyed outside the lock
+        {
+            std::lock_guard<std::mutex> lock(FMutex);
+            auto it = FDueById.find(id);
+            if (it == FDueById.end())
+                return false;
+            auto timerIt = FTimers.find(TKey{it->second, id});
+            func = std::move(timerIt->second);
+            FTimers.erase(timerIt);
+            FDueById.erase(it);
+        }
+        return true;
+    }
+
+private:
+    void TimerLoop()
+    {
+        std::unique_lock<std::mutex> lock(FMutex);
+        while (!FStopping)
+        {
+            if (FTimers.empty())
+            {
+                FCondition.wait(lock);
+                continue;
+            }
+
+            auto first = FTimers.begin();
+            TClock::time_point due = first->first.Due;  // the node may be cancelled while waiting
+            if (due > TClock::now())
+            {
+                FCondition.wait_until(lock, due);
+                continue;
+            }
+
+            std::function<void()> func = std::move(first->second);
+            FDueById.erase(first->first.Id);
+            FTimers.erase(first);
+
+            lock.unlock();
+            func();
+            lock.lock();
+        }
+    }
+};
+
+//---------------------------------------------------------------------------
+// TMcpCounterWaiter — waits on a monotonic application counter
+//
+// The application publishes the counter (e.g. the number of events)
+// whenever it changes; each waiter completes once the value reaches its
+// target, or with reached=false when its timeout expires. Progress
+// callbacks fire on every published change below the target. All
+// callbacks run outside the lock, on the publishing or timer thread.
+//---------------------------------------------------------------------------
+class TMcpCounterWaiter
+{
+public:
+    using TOnDone = std::function<void(bool reached, int64_t value)>;
+    using TOnProgress = std::function<void(int64_t value)>;
+
+private:
+    struct TWaiter
+    {
+        uint64_t Id = 0;
+        int64_t Target = 0;
+        TOnDone OnDone;
+        TOnProgress OnProgress;
+        TMcpTimerService::TTimerId TimerId = 0;
+    };
+
+    struct TState
+    {
+        std::mutex Mutex;
+        int64_t Value = 0;
+        uint64_t NextWaiterId = 1;
+        std::list<TWaiter> Waiters;
+    };
+
+    TMcpTimerService &FTimers;
+    std::shared_ptr<TState> FState;
+
+public:
+    explicit TMcpCounterWaiter(TMcpTimerService &timers)
+        : FTimers(timers)
+        , FState(std::make_shared<TState>())
+    {}
+
+    ~TMcpCounterWaiter()
+    {
+        CancelAll();
+    }
+
+    TMcpCounterWaiter(const TMcpCounterWaiter&) = delete;
+    TMcpCounterWaiter& operator=(const TMcpCounterWaiter&) = delete;
+
+    // Completes every pending waiter with reached=false, e.g. before the
+    // transport shuts down and waits for its connections
+    void CancelAll()
+    {
+        std::list<TWaiter> waiters;
+        int64_t value;
+        {
+            std::lock_guard<std::mutex> lock(FState->Mutex);
+            waiters.swap(FState->Waiters);
+            value = FState->Value;
+        }
+        for (auto &w : waiters)
+        {
+            FTimers.Cancel(w.TimerId);
+            w.OnDone(false, value);
+        }
+    }
+
+    int64_t GetValue() const
+    {
+        std::lock_guard<std::mutex> lock(FState->Mutex);
+        return FState->Value;
+    }
+
+    void Publish(int64_t value)
+    {
+        std::list<TWaiter> reached;
+        std::vector<TOnProgress> progress;
+        {
+            std::lock_guard<std::mutex> lock(FState->Mutex);
+            if (value == FState->Value)
+                return;
+            FState->Value = value;
+
+            for (auto it = FState->Waiters.begin(); it != FState->Waiters.end(); )
+            {
+                auto next = std::next(it);
+                if (value >= it->Target)
+                    reached.splice(reached.end(), FState->Waiters, it);
+                else if (it->OnProgress)
+                    progress.push_back(it->OnProgress);
+                it = next;
+            }
+        }
+
+        for (auto &w : reached)
+        {
+            FTimers.Cancel(w.TimerId);
+            w.OnDone(true, value);
+        }
+        for (auto &p : progress)
+            p(value);
+    }
+
+    // Completes immediately (on the calling thread) if the target is
+    // already reached, returning 0; otherwise returns an id for Cancel
+    uint64_t Wait(int64_t target, std::chrono::milliseconds timeout, TOnDone onDone,
+        TOnProgress onProgress = nullptr)
+    {
+        std::unique_lock<std::mutex> lock(FState->Mutex);
+        if (FState->Value >= target)
+        {
+            int64_t value = FState->Value;
+            lock.unlock();
+            onDone(true, value);
+            return 0;
+        }
+
+        uint64_t waiterId = FState->NextWaiterId++;
+        FState->Waiters.push_back(
+            TWaiter{waiterId, target, std::move(onDone), std::move(onProgress), 0});
+
+        // The timer only holds a weak reference: a waiter that completes
+        // first removes itself, and the timer then finds nothing to do
+        std::weak_ptr<TState> weakState = FState;
+        FState->Waiters.back().TimerId = FTimers.Schedule(timeout, [weakState, waiterId]() {
+            if (auto state = weakState.lock())
+                Expire(*state, waiterId);
+        });
+        return waiterId;
+    }
+
+    // Completes a pending waiter with reached=false (e.g. when its request
+    // is cancelled); a no-op once it has completed
+    void Cancel(uint64_t waiterId)
+    {
+        TMcpTimerService::TTimerId timerId = Expire(*FState, waiterId);
+        if (timerId != 0)
+            FTimers.Cancel(timerId);
+    }
+
+private:
+    // Removes and completes one waiter; returns its timer id, or 0 when
+    // it was no longer pending
+    static TMcpTimerService::TTimerId Expire(TState &state, uint64_t waiterId)
+    {
+        std::list<TWaiter> expired;
+        int64_t value;
+        {
+            std::lock_guard<std::mutex> lock(state.Mutex);
+            for (auto it = state.Waiters.begin(); it != state.Waiters.end(); ++it)
+            {
+                if (it->Id == waiterId)
+                {
+                    expired.splice(expired.end(), state.Waiters, it);
+                    break;
+                }
+            }
+            value = state.Value;
+        }
+        if (expired.empty())
+            return 0;
+        expired.front().OnDone(false, value);
+        return expired.front().TimerId;
+    }
+};
+
+//---------------------------------------------------------------------------
+// TMcpCancellationToken — cancellation flag shared with a running request
+//
+// Polling code checks IsCancelled; waiting code registers an OnCancel
+// callback so it can complete early. Callbacks run once, on the thread
+// that calls Cancel.
+//---------------------------------------------------------------------------
+class TMcpCancellationToken
+{
+private:
+    std::atomic<bool> FCancelled{false};
+    mutable std::mutex FMutex;
+    std::string FReason;
+    std::map<uint64_t, std::function<void()>> FCallbacks;
+    uint64_t FNextId = 1;
+
+public:
+    TMcpCancellationToken() = default;
+
+    TMcpCancellationToken(const TMcpCancellationToken&) = delete;
+    TMcpCancellationToken& operator=(const TMcpCancellationToken&) = delete;
+
+    bool IsCancelled() const { return FCancelled.load(std::memory_order_acquire); }
+
+    std::string GetReason() const
+    {
+        std::lock_guard<std::mutex> lock(FMutex);
+        return FReason;
+    }
+
+    void Cancel(const std::string &reason = std::string())
+    {
+        std::map<uint64_t, std::function<void()>> callbacks;
+        {
+            std::lock_guard<std::mutex> lock(FMutex);
+            if (FCancelled.load(std::memory_order_relaxed))
+                return;
+            FReason = reason;
+            FCancelled.store(true, std::memory_order_release);
+            callbacks.swap(FCallbacks);
+        }
+        for (auto &pair : callbacks)
+            pair.second();
+    }
+
+    // Runs func right away when already cancelled (and returns 0);
+    // otherwise returns an id for RemoveOnCancel
+    uint64_t OnCancel(std::function<void()> func)
+    {
+        {
+            std::lock_guard<std::mutex> lock(FMutex);
+            if (!FCancelled.load(std::memory_order_relaxed))
+            {
+                uint64_t id = FNextId++;
+                FCallbacks.emplace(id, std::move(func));
+                return id;
+            }
+        }
+        func();
+        return 0;
+    }
+
+    void RemoveOnCancel(uint64_t id)
+    {
+        std::lock_guard<std::mutex> lock(FMutex);
+        FCallbacks.erase(id);
+    }
+};
+
+//---------------------------------------------------------------------------
+// TMcpConcurrencyLimiter — runs at most Limit jobs at a time, FIFO
+//
+// A job that cannot start right away is queued without holding a thread.
+// Every job that started must call Release once its work is done; the next
+// queued job then starts on the releasing thread. Jobs released while
+// another Release on the same thread is starting one are run after it
+// returns, so a run of synchronous jobs does not recurse.
+//---------------------------------------------------------------------------
+class TMcpConcurrencyLimiter
+{
+private:
+    unsigned FLimit;
+    unsigned FRunning = 0;
+    std::deque<std::function<void()>> FQueue;
+    std::mutex FMutex;
+
+public:
+    explicit TMcpConcurrencyLimiter(unsigned limit)
+        : FLimit(limit > 0 ? limit : 1)
+    {}
+
+    TMcpConcurrencyLimiter(const TMcpConcurrencyLimiter&) = delete;
+    TMcpConcurrencyLimiter& operator=(const TMcpConcurrencyLimiter&) = delete;
+
+    unsigned GetLimit() const { return FLimit; }
+
+    size_t GetQueued()
+    {
+        std::lock_guard<std::mutex> lock(FMutex);
+        return FQueue.size();
+    }
+
+    // Runs job on the calling thread when a slot is free, else queues it
+    void Run(std::function<void()> job)
+    {
+        {
+            std::lock_guard<std::mutex> lock(FMutex);
+            if (FRunning >= FLimit)
+            {
+                FQueue.push_back(std::move(job));
+                return;
+            }
+            FRunning++;
+        }
+        job();
+    }
+
+    void Release()
+    {
+        std::function<void()> next;
+        {
+            std::lock_guard<std::mutex> lock(FMutex);
+            if (FQueue.empty())
+            {
+                FRunning--;
+                return;
+            }
+            next = std::move(FQueue.front());  // the slot passes to it
+            FQueue.pop_front();
+        }
+
+        std::deque<std::function<void()>> *&pending = PendingOnThisThread();
+        if (pending)
+        {
+            pending->push_back(std::move(next));
+            return;
+        }
+
+        struct TPendingScope
+        {
+            std::deque<std::function<void()>> *&Pending;
+            ~TPendingScope() { Pending = nullptr; }
+        } scope{pending};
+
+        std::deque<std::function<void()>> local;
+        local.push_back(std::move(next));
+        pending = &local;
+        while (!local.empty())
+        {
+            std::function<void()> job = std::move(local.front());
+            local.pop_front();
+            job();
+        }
+    }
+
+private:
+    // Jobs handed over by nested Release calls, shared by all limiters
+    static std::deque<std::function<void()>>*& PendingOnThisThread()
+    {
+        static thread_local std::deque<std::function<void()>> *pending = nullptr;
+        return pending;
+    }
+};
+
+} // namespace Mcp
+
+//---------------------------------------------------------------------------
+#endif // McpAsyncH
@@ -0,0 +1,376 @@
+//---------------------------------------------------------------------------
+// McpEnvelopeScanner.h — Single-pass SAX pre-scan of JSON-RPC requests
+//
+// Pulls jsonrpc, id, method and params.name out of a request body with
+// nlohmann's SAX interface and builds a DOM for params only. Requests
+// that end in a cheap error (bad version, unknown method, unknown tool)
+// stop building anything as soon as the answer is known; the rest is
+// only checked for well-formedness.
+// Pure C++ with nlohmann::json - NO VCL dependencies.
+//---------------------------------------------------------------------------
+
+#ifndef McpEnvelopeScannerH
+#define McpEnvelopeScannerH
+
+//---------------------------------------------------------------------------
+#include <string>
+#include <vector>
+#include <functional>
+
+#include "../../external/nlohmann/json.hpp"
+
+namespace Mcp {
+
+using json = nlohmann::json;
+
+//---------------------------------------------------------------------------
+// TMcpEnvelope — JSON-RPC request envelope (top-level object fields)
+//---------------------------------------------------------------------------
+struct TMcpEnvelope
+{
+    json Id;                       // null when absent
+    bool HasId = false;
+    bool HasVersion = false;
+    bool VersionOk = false;        // "jsonrpc" is the string "2.0"
+    bool HasMethod = false;        // "method" present and a string
+    std::string Method;
+    const json *Params = nullptr;  // nullptr when absent
+
+    bool IsNotification() const { return !HasId || Id.is_null(); }
+};
+
+//---------------------------------------------------------------------------
+// TMcpEnvelopeScanner — SAX consumer producing a TMcpEnvelope
+//
+// The caller guarantees the top-level value is an object (body starts
+// with '{'). Values other than params and a structured id are skipped
+// without being materialized. With an id already seen, the scan decides
+// early on a bad version, an unknown method or, for tools/call, an
+// unknown params.name; the envelope then holds what was read so far,
+// which is enough for the dispatcher to produce the same error. The rest
+// of the body is still read, without being looked at, so malformed JSON
+// remains a parse error whatever came before it.
+//---------------------------------------------------------------------------
+class TMcpEnvelopeScanner : public nlohmann::json_sax<json>
+{
+public:
+    using TNamePredicate = std::function<bool(const std::string &name)>;
+
+private:
+    enum class TTopKey { None, Version, Id, Method, Params, Other };
+
+    TNamePredicate FIsKnownMethod;
+    TNamePredicate FIsKnownTool;
+
+    TMcpEnvelope FEnvelope;
+    json FParams;
+    bool FHasParams = false;
+
+    int FDepth = 0;                 // nesting depth of skipped values
+    TTopKey FTopKey = TTopKey::None;
+
+    // Subtree capture (params or a structured id)
+    json *FCaptureRoot = nullptr;
+    std::vector<json*> FStack;
+    json *FObjectElement = nullptr;
+    bool FParamsNameKey = false;    // next value is params.name
+    bool FSkipParams = false;       // method is known to be unknown
+
+    bool FDecided = false;          // skip to the end, see Decide
+    std::string FErrorMessage;
+
+public:
+    TMcpEnvelopeScanner(TNamePredicate isKnownMethod, TNamePredicate isKnownTool)
+        : FIsKnownMethod(std::move(isKnownMethod))
+        , FIsKnownTool(std::move(isKnownTool))
+    {}
+
+    // Returns false on malformed JSON (see GetErrorMessage)
+    bool Scan(const std::string &body)
+    {
+        if (!json::sax_parse(body, this))
+            return false;
+        FEnvelope.Params = FHasParams ? &FParams : nullptr;
+        return true;
+    }
+
+    const TMcpEnvelope& GetEnvelope() const { return FEnvelope; }
+    const std::string& GetErrorMessage() const { return FErrorMessage; }
+
+    //-----------------------------------------------------------------------
+    // json_sax interface
+    //-----------------------------------------------------------------------
+    bool null() override { return FDecided || Scalar(nullptr); }
+    bool boolean(bool val) override { return FDecided || Scalar(val); }
+    bool number_integer(number_integer_t val) override { return FDecided || Scalar(val); }
+    bool number_unsigned(number_unsigned_t val) override { return FDecided || Scalar(val); }
+    bool number_float(number_float_t val, const string_t &) override { return FDecided || Scalar(val); }
+    bool binary(binary_t &val) override { return FDecided || Scalar(std::move(val)); }
+
+    bool string(string_t &val) override
+    {
+        if (FDecided)
+            return true;
+        if (FCaptureRoot)
+        {
+            bool known = !FParamsNameKey || CheckToolName(val);
+            FParamsNameKey = false;
+            Capture(std::move(val));
+            return known || Decide();
+        }
+        if (FDepth != 1)
+            return true;
+
+        switch (FTopKey)
+        {
+        case TTopKey::Version:
+            FEnvelope.HasVersion = true;
+            FEnvelope.VersionOk = (val == "2.0");
+            return FEnvelope.VersionOk || !FEnvelope.HasId || Decide();
+        case TTopKey::Id:
+            FEnvelope.HasId = true;
+            FEnvelope.Id = std::move(val);
+            return CheckAfterId();
+        case TTopKey::Method:
+            FEnvelope.HasMethod = true;
+            FEnvelope.Method = std::move(val);
+            return CheckMethod();
+        default:
+            return true;
+        }
+    }
+
+    bool start_object(std::size_t) override
+    {
+        if (FDecided)
+            return true;
+        if (FCaptureRoot)
+            return CaptureStart(json::object());
+        if (FDepth == 0)
+        {
+            FDepth = 1;
+            return true;
+        }
+        if (FDepth == 1 && BeginCapture())
+            return CaptureStart(json::object());
+        FDepth++;
+        return true;
+    }
+
+    bool key(string_t &val) override
+    {
+        if (FDecided)
+            return true;
+        if (FCaptureRoot)
+        {
+            FParamsNameKey = (FCaptureRoot == &FParams && FStack.size() == 1 &&
+                val == "name");
+            FObjectElement = &(*FStack.back())[val];
+            return true;
+        }
+        if (FDepth != 1)
+            return true;
+
+        if (val == "jsonrpc")
+            FTopKey = TTopKey::Version;
+        else if (val == "id")
+            FTopKey = TTopKey::Id;
+        else if (val == "method")
+            FTopKey = TTopKey::Method;
+        else if (val == "params")
+            FTopKey = TTopKey::Params;
+        else
+            FTopKey = TTopKey::Other;
+        return true;
+    }
+
+    bool end_object() override
+    {
+        if (FDecided)
+            return true;
+        if (FCaptureRoot)
+            return CaptureEnd();
+        FDepth--;
+        return true;
+    }
+
+    bool start_array(std::size_t) override
+    {
+        if (FDecided)
+            return true;
+        if (FCaptureRoot)
+            return CaptureStart(json::array());
+        if (FDepth == 1 && BeginCapture())
+            return CaptureStart(json::array());
+        FDepth++;
+        return true;
+    }
+
+    bool end_array() override
+    {
+        if (FDecided)
+            return true;
+        if (FCaptureRoot)
+            return CaptureEnd();
+        FDepth--;
+        return true;
+    }
+
+    bool parse_error(std::size_t, const std::string &,
+        const nlohmann::detail::exception &ex) override
+    {
+        FErrorMessage = ex.what();
+        return false;
+    }
+
+private:
+    // The answer is known: the parser goes on to the end of the body, to
+    // reject malformed JSON, but nothing else is built or checked
+    bool Decide()
+    {
+        FDecided = true;
+        return true;
+    }
+
+    // Non-string scalar at any level
+    template<typename T>
+    bool Scalar(T &&val)
+    {
+        if (FCaptureRoot)
+        {
+            FParamsNameKey = false;
+            return Capture(std::forward<T>(val));
+        }
+        if (FDepth != 1)
+            return true;
+
+        switch (FTopKey)
+        {
+        case TTopKey::Version:
+            FEnvelope.HasVersion = true;
+            FEnvelope.VersionOk = false;
+            return !FEnvelope.HasId || Decide();
+        case TTopKey::Id:
+            FEnvelope.HasId = true;
+            FEnvelope.Id = json(std::forward<T>(val));
+            return CheckAfterId();
+        case TTopKey::Method:
+            FEnvelope.HasMethod = false;
+            return true;
+        case TTopKey::Params:
+            FHasParams = true;
+            FParams = json(std::forward<T>(val));
+            return true;
+        default:
+            return true;
+        }
+    }
+
+    // A structured value directly under the top-level object: capture it
+    // when it is params (and worth building) or the id
+    bool BeginCapture()
+    {
+        if (FTopKey == TTopKey::Params)
+        {
+            FHasParams = true;
+            if (FSkipParams)
+                return false;
+            FCaptureRoot = &FParams;
+            return true;
+        }
+        if (FTopKey == TTopKey::Id)
+        {
+            FEnvelope.HasId = true;
+            FCaptureRoot = &FEnvelope.Id;
+            return true;
+        }
+        return false;
+    }
+
+    template<typename T>
+    bool Capture(T &&val)
+    {
+        if (FStack.empty())
+        {
+            *FCaptureRoot = json(std::forward<T>(val));
+            return true;
+        }
+        json &parent = *FStack.back();
+        if (parent.is_array())
+            parent.emplace_back(std::forward<T>(val));
+        else
+            *FObjectElement = json(std::forward<T>(val));
+        return true;
+    }
+
+    bool CaptureStart(json container)
+    {
+        json *slot;
+        if (FStack.empty())
+        {
+            *FCaptureRoot = std::move(container);
+            slot = FCaptureRoot;
+        }
+        else if (FStack.back()->is_array())
+        {
+            FStack.back()->emplace_back(std::move(container));
+            slot = &FStack.back()->back();
+        }
+        else
+        {
+            *FObjectElement = std::move(container);
+            slot = FObjectElement;
+        }
+        FStack.push_back(slot);
+        return true;
+    }
+
+    bool CaptureEnd()
+    {
+        FStack.pop_back();
+        if (FStack.empty())
+            FCaptureRoot = nullptr;
+        return true;
+    }
+
+    // Early answers need the id (for the error) and a valid version
+    // (which the dispatcher checks first)
+    bool CanAnswerEarly() const
+    {
+        return FEnvelope.HasId && !FEnvelope.Id.is_null() && FEnvelope.VersionOk;
+    }
+
+    bool CheckAfterId()
+    {
+        if (FEnvelope.HasVersion && !FEnvelope.VersionOk)
+            return Decide();
+        if (FSkipParams && CanAnswerEarly())
+            return Decide();
+        return true;
+    }
+
+    bool CheckMethod()
+    {
+        if (FIsKnownMethod && !FIsKnownMethod(FEnvelope.Method))
+        {
+            FSkipParams = true;
+            if (CanAnswerEarly())
+                return Decide();
+        }
+        return true;
+    }
+
+    bool CheckToolName(const std::string &name)
+    {
+        if (!FEnvelope.HasMethod || FEnvelope.Method != "tools/call")
+            return true;
+        if (!CanAnswerEarly())
+            return true;
+        return !FIsKnownTool || FIsKnownTool(name);
+    }
+};
+
+} // namespace Mcp
+
+//---------------------------------------------------------------------------
+#endif // McpEnvelopeScannerH
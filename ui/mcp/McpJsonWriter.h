@@ -0,0 +1,298 @@
+//---------------------------------------------------------------------------
+// McpJsonWriter.h — Appending JSON writer for responses
+//
+// Responses are mostly pre-serialized pieces (ids, results, cached
+// payloads) joined by a little punctuation. TMcpJsonWriter appends those
+// pieces, escaped strings and json values straight into one buffer, so no
+// temporary DOM or intermediate string is built for them. Output is
+// byte-for-byte what json::dump with error_handler_t::replace produces:
+// invalid UTF-8 becomes U+FFFD, keys come out in the DOM's order.
+// Pure C++ with nlohmann::json - NO VCL dependencies.
+//---------------------------------------------------------------------------
+
+#ifndef McpJsonWriterH
+#define McpJsonWriterH
+
+//---------------------------------------------------------------------------
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <cstring>
+#include <charconv>
+
+#include "../../external/nlohmann/json.hpp"
+
+namespace Mcp {
+
+using json = nlohmann::json;
+
+//---------------------------------------------------------------------------
+// TMcpJsonWriter — builds one JSON text; every call appends
+//---------------------------------------------------------------------------
+class TMcpJsonWriter
+{
+private:
+    std::string FOut;
+
+public:
+    TMcpJsonWriter() = default;
+
+    explicit TMcpJsonWriter(size_t reserve)
+    {
+        FOut.reserve(reserve);
+    }
+
+    // Continue in buffer (its contents are kept), e.g. a reused scratch
+    // string whose capacity is already there
+    explicit TMcpJsonWriter(std::string &&buffer)
+        : FOut(std::move(buffer))
+    {}
+
+    void Reserve(size_t size) { FOut.reserve(size); }
+
+    // JSON text that is already serialized, or punctuation
+    TMcpJsonWriter& Raw(std::string_view jsonText)
+    {
+        FOut.append(jsonText.data(), jsonText.size());
+        return *this;
+    }
+
+    TMcpJsonWriter& Raw(char c)
+    {
+        FOut += c;
+        return *this;
+    }
+
+    // A quoted, escaped string
+    TMcpJsonWriter& String(std::string_view text)
+    {
+        FOut += '"';
+        AppendEscaped(FOut, text);
+        FOut += '"';
+        return *this;
+    }
+
+    TMcpJsonWriter& Integer(int64_t value)
+    {
+        char buffer[24];
+        auto end = std::to_chars(buffer, buffer + sizeof(buffer), value).ptr;
+        FOut.append(buffer, end - buffer);
+        return *this;
+    }
+
+    // A json value, as compact dump() would write it
+    TMcpJsonWriter& Value(const json &value)
+    {
+        switch (value.type())
+        {
+        case json::value_t::null:
+            FOut += "null";
+            break;
+        case json::value_t::boolean:
+            FOut += value.get<bool>() ? "true" : "false";
+            break;
+        case json::value_t::string:
+            String(value.get_ref<const std::string&>());
+            break;
+        case json::value_t::number_integer:
+            Integer(value.get<int64_t>());
+            break;
+        case json::value_t::number_unsigned:
+        {
+            char buffer[24];
+            auto end = std::to_chars(buffer, buffer + sizeof(buffer), value.get<uint64_t>()).ptr;
+            FOut.append(buffer, end - buffer);
+            break;
+        }
+        case json::value_t::object:
+        {
+            FOut += '{';
+            bool first = true;
+            for (const auto &pair : value.get_ref<const json::object_t&>())
+            {
+                if (!first)
+                    FOut += ',';
+                first = false;
+                String(pair.first);
+                FOut += ':';
+                Value(pair.second);
+            }
+            FOut += '}';
+            break;
+        }
+        case json::value_t::array:
+        {
+            FOut += '[';
+            bool first = true;
+            for (const json &item : value.get_ref<const json::array_t&>())
+            {
+                if (!first)
+                    FOut += ',';
+                first = false;
+                Value(item);
+            }
+            FOut += ']';
+            break;
+        }
+        default:
+            // Floats (shortest round-trip formatting), binary, discarded
+            FOut += value.dump(-1, ' ', false, json::error_handler_t::replace);
+            break;
+        }
+        return *this;
+    }
+
+    const std::string& GetText() const { return FOut; }
+
+    // The text written so far; the writer is empty afterwards
+    std::string Take() { return std::move(FOut); }
+
+    static std::string ToString(const json &value)
+    {
+        TMcpJsonWriter writer;
+        writer.Value(value);
+        return writer.Take();
+    }
+
+    //-----------------------------------------------------------------------
+    // Appends text escaped for a JSON string (without the quotes). Runs of
+    // plain ASCII are found eight bytes at a time, valid UTF-8 sequences
+    // extend the run, and each run is copied in one go; only control
+    // characters, '"', '\\' and invalid UTF-8 (replaced by U+FFFD, one per
+    // broken sequence) interrupt it.
+    //-----------------------------------------------------------------------
+    static void AppendEscaped(std::string &out, std::string_view text)
+    {
+        static const char Replacement[] = "\xEF\xBF\xBD";
+
+        const char *p = text.data();
+        const char *end = p + text.size();
+        const char *run = p;
+
+        while (p < end)
+        {
+            while (end - p >= 8 && !WordNeedsEscape(p))
+                p += 8;
+            if (p == end)
+                break;
+
+            unsigned char c = static_cast<unsigned char>(*p);
+            if (c >= 0x80)
+            {
+                size_t invalidLength;
+                size_t length = Utf8SequenceLength(p, end, invalidLength);
+                if (length)
+                {
+                    p += length;
+                    continue;
+                }
+                out.append(run, p - run);
+                out.append(Replacement, 3);
+                p += invalidLength;
+                run = p;
+            }
+            else if (c < 0x20 || c == '"' || c == '\\')
+            {
+                out.append(run, p - run);
+                AppendEscapedAscii(out, c);
+                run = ++p;
+            }
+            else
+                p++;
+        }
+        out.append(run, p - run);
+    }
+
+private:
+    // Whether any of the 8 bytes at p is < 0x20, '"', '\\' or >= 0x80
+    static bool WordNeedsEscape(const char *p)
+    {
+        constexpr uint64_t Ones = 0x0101010101010101ull;
+        constexpr uint64_t High = 0x8080808080808080ull;
+
+        uint64_t word;
+        std::memcpy(&word, p, sizeof(word));
+
+        uint64_t quote = word ^ (Ones * '"');
+        uint64_t backslash = word ^ (Ones * '\\');
+        uint64_t control = (word - Ones * 0x20) & ~word;
+        uint64_t hasQuote = (quote - Ones) & ~quote;
+        uint64_t hasBackslash = (backslash - Ones) & ~backslash;
+        return ((control | hasQuote | hasBackslash | word) & High) != 0;
+    }
+
+    // Length (2 to 4) of the valid UTF-8 sequence at p, or 0 if it is
+    // invalid; invalidLength then counts the bytes up to the one that broke
+    // it, where json::dump resumes
+    static size_t Utf8SequenceLength(const char *p, const char *end, size_t &invalidLength)
+    {
+        unsigned char lead = static_cast<unsigned char>(*p);
+        size_t length;
+        unsigned char low = 0x80, high = 0xBF;    // range of the second byte
+        if (lead >= 0xC2 && lead <= 0xDF)
+            length = 2;
+        else if (lead >= 0xE0 && lead <= 0xEF)
+        {
+            length = 3;
+            if (lead == 0xE0)
+                low = 0xA0;                       // no overlong forms
+            else if (lead == 0xED)
+                high = 0x9F;                      // no surrogates
+        }
+        else if (lead >= 0xF0 && lead <= 0xF4)
+        {
+            length = 4;
+            if (lead == 0xF0)
+                low = 0x90;
+            else if (lead == 0xF4)
+                high = 0x8F;                      // nothing above U+10FFFF
+        }
+        else
+        {
+            invalidLength = 1;
+            return 0;
+        }
+
+        for (size_t i = 1; i < length; i++)
+        {
+            if (p + i == end)
+            {
+                invalidLength = i;
+                return 0;
+            }
+            unsigned char c = static_cast<unsigned char>(p[i]);
+            if (c < (i == 1 ? low : 0x80) || c > (i == 1 ? high : 0xBF))
+            {
+                invalidLength = i;
+                return 0;
+            }
+        }
+        return length;
+    }
+
+    static void AppendEscapedAscii(std::string &out, unsigned char c)
+    {
+        switch (c)
+        {
+        case '"':  out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\b': out += "\\b"; break;
+        case '\t': out += "\\t"; break;
+        case '\n': out += "\\n"; break;
+        case '\f': out += "\\f"; break;
+        case '\r': out += "\\r"; break;
+        default:
+        {
+            static const char Hex[] = "0123456789abcdef";
+            char escape[6] = {'\\', 'u', '0', '0', Hex[c >> 4], Hex[c & 0xF]};
+            out.append(escape, sizeof(escape));
+            break;
+        }
+        }
+    }
+};
+
+} // namespace Mcp
+
+//---------------------------------------------------------------------------
+#endif // McpJsonWriterH
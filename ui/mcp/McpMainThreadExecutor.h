@@ -0,0 +1,143 @@
+//---------------------------------------------------------------------------
+// McpMainThreadExecutor.h — Batched executor for the application's main thread
+//
+// Work items posted from any thread go onto a lock-free queue. The first
+// item posted to an empty queue asks the application (through the wake
+// function) for one Drain call on the main thread, which then runs every
+// item queued by that time. Readers arriving together share a single hop
+// instead of paying one blocking round trip each.
+// Pure C++ - NO VCL dependencies; the application supplies the wake-up.
+//---------------------------------------------------------------------------
+
+#ifndef McpMainThreadExecutorH
+#define McpMainThreadExecutorH
+
+//---------------------------------------------------------------------------
+#include <atomic>
+#include <functional>
+#include <future>
+#include <memory>
+#include <type_traits>
+
+namespace Mcp {
+
+//---------------------------------------------------------------------------
+// TMcpMainThreadExecutor — multi-producer queue drained in batches
+//
+// Producers push onto an atomic stack with one CAS; Drain takes the whole
+// stack with one exchange and runs it oldest first. Items posted while a
+// batch runs wake a new Drain, so the message loop runs in between.
+//---------------------------------------------------------------------------
+class TMcpMainThreadExecutor
+{
+public:
+    using TWake = std::function<void()>;          // arrange one Drain call on the main thread
+    using TIsMainThread = std::function<bool()>;
+
+private:
+    struct TNode
+    {
+        std::function<void()> Func;
+        TNode *Next = nullptr;
+    };
+
+    std::atomic<TNode*> FHead{nullptr};
+    TWake FWake;
+    TIsMainThread FIsMainThread;
+
+public:
+    TMcpMainThreadExecutor(TWake wake, TIsMainThread isMainThread)
+        : FWake(std::move(wake))
+        , FIsMainThread(std::move(isMainThread))
+    {}
+
+    // Items still queued are dropped without running
+    ~TMcpMainThreadExecutor()
+    {
+        TNode *node = FHead.exchange(nullptr, std::memory_order_acquire);
+        while (node)
+        {
+            TNode *next = node->Next;
+            delete node;
+            node = next;
+        }
+    }
+
+    TMcpMainThreadExecutor(const TMcpMainThreadExecutor&) = delete;
+    TMcpMainThreadExecutor& operator=(const TMcpMainThreadExecutor&) = delete;
+
+    bool IsMainThread() const { return FIsMainThread && FIsMainThread(); }
+
+    // Never blocks. func must not throw; use Submit for work that may.
+    void Post(std::function<void()> func)
+    {
+        TNode *node = new TNode{std::move(func), nullptr};
+        TNode *head = FHead.load(std::memory_order_relaxed);
+        do
+        {
+            node->Next = head;
+        }
+        while (!FHead.compare_exchange_weak(head, node,
+            std::memory_order_release, std::memory_order_relaxed));
+
+        if (!head)
+            FWake();
+    }
+
+    // Runs func on the main thread; the future carries its result or exception
+    template<typename Func>
+    auto Submit(Func func) -> std::future<typename std::invoke_result<Func>::type>
+    {
+        using TResult = typename std::invoke_result<Func>::type;
+        auto task = std::make_shared<std::packaged_task<TResult()>>(std::move(func));
+        std::future<TResult> future = task->get_future();
+        Post([task]() { (*task)(); });
+        return future;
+    }
+
+    // Blocking form of Submit; runs inline when called on the main thread
+    template<typename Func>
+    auto Invoke(Func func) -> typename std::invoke_result<Func>::type
+    {
+        if (IsMainThread())
+            return func();
+        return Submit(std::move(func)).get();
+    }
+
+    // Called on the main thread; returns the number of items run
+    size_t Drain()
+    {
+        TNode *node = FHead.exchange(nullptr, std::memory_order_acquire);
+
+        TNode *fifo = nullptr;
+        while (node)
+        {
+            TNode *next = node->Next;
+            node->Next = fifo;
+            fifo = node;
+            node = next;
+        }
+
+        size_t count = 0;
+        while (fifo)
+        {
+            std::unique_ptr<TNode> current(fifo);
+            fifo = fifo->Next;
+            try
+            {
+                current->Func();
+            }
+            catch (...)
+            {
+                // Nowhere to report it; keep the rest of the batch running
+            }
+            count++;
+        }
+        return count;
+    }
+};
+
+} // namespace Mcp
+
+//---------------------------------------------------------------------------
+#endif // McpMainThreadExecutorH
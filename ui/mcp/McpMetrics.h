@@ -0,0 +1,186 @@
+//---------------------------------------------------------------------------
+// McpMetrics.h — Call counters and latency histograms for the MCP server
+//
+// Recording is a handful of relaxed atomic increments, so it stays on for
+// every call. Readers take a consistent-enough snapshot without locking.
+// Pure C++ with nlohmann::json - NO VCL dependencies.
+//---------------------------------------------------------------------------
+
+#ifndef McpMetricsH
+#define McpMetricsH
+
+//---------------------------------------------------------------------------
+#include <cstdint>
+#include <atomic>
+#include <array>
+#include <chrono>
+#include <algorithm>
+
+#include "../../external/nlohmann/json.hpp"
+
+namespace Mcp {
+
+using json = nlohmann::json;
+
+//---------------------------------------------------------------------------
+// TMcpLatencyHistogram — log-linear (HDR-style) histogram of microseconds
+//
+// Values below 16 us get exact buckets; above that every power of two is
+// split into 16 sub-buckets, so percentiles are within ~6%. Values beyond
+// 2^40 us (about 12 days) land in the last bucket.
+//---------------------------------------------------------------------------
+class TMcpLatencyHistogram
+{
+private:
+    static constexpr unsigned SubBucketBits = 4;
+    static constexpr unsigned SubBuckets = 1u << SubBucketBits;
+    static constexpr unsigned MaxExponent = 40;
+    static constexpr unsigned BucketCount = (MaxExponent - SubBucketBits + 2) * SubBuckets;
+
+    std::array<std::atomic<uint64_t>, BucketCount> FBuckets{};
+    std::atomic<uint64_t> FCount{0};
+    std::atomic<uint64_t> FSum{0};
+    std::atomic<uint64_t> FMax{0};
+
+public:
+    void Record(uint64_t micros)
+    {
+        FBuckets[BucketIndex(micros)].fetch_add(1, std::memory_order_relaxed);
+        FCount.fetch_add(1, std::memory_order_relaxed);
+        FSum.fetch_add(micros, std::memory_order_relaxed);
+
+        uint64_t max = FMax.load(std::memory_order_relaxed);
+        while (micros > max &&
+               !FMax.compare_exchange_weak(max, micros, std::memory_order_relaxed))
+        {}
+    }
+
+    void Record(std::chrono::steady_clock::duration elapsed)
+    {
+        auto micros = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+        Record(static_cast<uint64_t>(micros > 0 ? micros : 0));
+    }
+
+    uint64_t GetCount() const { return FCount.load(std::memory_order_relaxed); }
+
+    // Value at or below which the given fraction (0..1) of samples fall;
+    // reported as the midpoint of the matching bucket, capped at the max
+    uint64_t Percentile(double fraction) const
+    {
+        uint64_t total = GetCount();
+        if (total == 0)
+            return 0;
+
+        uint64_t target = static_cast<uint64_t>(fraction * total + 0.5);
+        if (target < 1)
+            target = 1;
+
+        uint64_t seen = 0;
+        for (unsigned i = 0; i < BucketCount; i++)
+        {
+            seen += FBuckets[i].load(std::memory_order_relaxed);
+            if (seen >= target)
+                return std::min(BucketMidpoint(i), FMax.load(std::memory_order_relaxed));
+        }
+        return FMax.load(std::memory_order_relaxed);
+    }
+
+    json ToJson() const
+    {
+        uint64_t count = GetCount();
+        json j;
+        j["count"] = count;
+        j["meanUs"] = count ? FSum.load(std::memory_order_relaxed) / count : 0;
+        j["p50Us"] = Percentile(0.50);
+        j["p95Us"] = Percentile(0.95);
+        j["p99Us"] = Percentile(0.99);
+        j["maxUs"] = FMax.load(std::memory_order_relaxed);
+        return j;
+    }
+
+private:
+    static unsigned HighestBit(uint64_t value)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        return 63u - static_cast<unsigned>(__builtin_clzll(value));
+#else
+        unsigned bit = 0;
+        while (value >>= 1)
+            bit++;
+        return bit;
+#endif
+    }
+
+    static unsigned BucketIndex(uint64_t value)
+    {
+        if (value < SubBuckets)
+            return static_cast<unsigned>(value);
+
+        unsigned exponent = HighestBit(value);
+        if (exponent > MaxExponent)
+            return BucketCount - 1;
+
+        unsigned shift = exponent - SubBucketBits;
+        unsigned mantissa = static_cast<unsigned>(value >> shift) - SubBuckets;
+        return (shift + 1) * SubBuckets + mantissa;
+    }
+
+    static uint64_t BucketMidpoint(unsigned index)
+    {
+        if (index < SubBuckets)
+            return index;
+
+        unsigned shift = index / SubBuckets - 1;
+        uint64_t mantissa = SubBuckets + index % SubBuckets;
+        uint64_t lower = mantissa << shift;
+        return lower + ((uint64_t(1) << shift) >> 1);
+    }
+};
+
+//---------------------------------------------------------------------------
+// TMcpCallStats — counters for one tool or method
+//
+// Wait covers time the call spent blocked on another thread (for UI tools,
+// the VCL main thread), as reported through TMcpToolContext::RecordWait.
+// CacheHits and Coalesced count calls answered from a tool's result cache
+// or by sharing an identical call already running; both are also counted
+// in Calls.
+//---------------------------------------------------------------------------
+struct TMcpCallStats
+{
+    std::atomic<uint64_t> Calls{0};
+    std::atomic<uint64_t> Errors{0};
+    std::atomic<uint64_t> CacheHits{0};
+    std::atomic<uint64_t> Coalesced{0};
+    TMcpLatencyHistogram Latency;
+    TMcpLatencyHistogram Wait;
+
+    void Record(bool success, std::chrono::steady_clock::duration elapsed)
+    {
+        Calls.fetch_add(1, std::memory_order_relaxed);
+        if (!success)
+            Errors.fetch_add(1, std::memory_order_relaxed);
+        Latency.Record(elapsed);
+    }
+
+    json ToJson() const
+    {
+        json j;
+        j["calls"] = Calls.load(std::memory_order_relaxed);
+        j["errors"] = Errors.load(std::memory_order_relaxed);
+        j["latency"] = Latency.ToJson();
+        if (CacheHits.load(std::memory_order_relaxed) || Coalesced.load(std::memory_order_relaxed))
+        {
+            j["cacheHits"] = CacheHits.load(std::memory_order_relaxed);
+            j["coalesced"] = Coalesced.load(std::memory_order_relaxed);
+        }
+        if (Wait.GetCount() > 0)
+            j["wait"] = Wait.ToJson();
+        return j;
+    }
+};
+
+} // namespace Mcp
+
+//---------------------------------------------------------------------------
+#endif // McpMetricsH
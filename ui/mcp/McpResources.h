@@ -0,0 +1,278 @@
+//---------------------------------------------------------------------------
+// McpResources.h — MCP resources: listing, reading and subscriptions
+//
+// A resource is addressed by URI and read on demand by its reader. Fixed
+// resources are listed by resources/list; a template covers a family of
+// URIs under one prefix (e.g. one per event) and is listed by
+// resources/templates/list. Clients subscribe to a URI and get
+// notifications/resources/updated when the application reports a change,
+// instead of polling for it.
+// Pure C++ with nlohmann::json - NO VCL dependencies.
+//---------------------------------------------------------------------------
+
+#ifndef McpResourcesH
+#define McpResourcesH
+
+//---------------------------------------------------------------------------
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <memory>
+#include <mutex>
+#include <functional>
+#include <algorithm>
+
+#include "../../external/nlohmann/json.hpp"
+
+namespace Mcp {
+
+using json = nlohmann::json;
+
+//---------------------------------------------------------------------------
+// TMcpResource — an entry of resources/list
+//---------------------------------------------------------------------------
+struct TMcpResource
+{
+    std::string Uri;
+    std::string Name;
+    std::string Description;
+    std::string MimeType = "application/json";
+
+    json ToJson() const
+    {
+        json j;
+        j["uri"] = Uri;
+        j["name"] = Name;
+        if (!Description.empty())
+            j["description"] = Description;
+        j["mimeType"] = MimeType;
+        return j;
+    }
+};
+
+//---------------------------------------------------------------------------
+// TMcpResourceTemplate — an entry of resources/templates/list
+// (UriTemplate is RFC 6570, e.g. "clabot://events/{index}")
+//---------------------------------------------------------------------------
+struct TMcpResourceTemplate
+{
+    std::string UriTemplate;
+    std::string Name;
+    std::string Description;
+    std::string MimeType = "application/json";
+
+    json ToJson() const
+    {
+        json j;
+        j["uriTemplate"] = UriTemplate;
+        j["name"] = Name;
+        if (!Description.empty())
+            j["description"] = Description;
+        j["mimeType"] = MimeType;
+        return j;
+    }
+};
+
+//---------------------------------------------------------------------------
+// TMcpResourceContents — one element of a resources/read result
+//---------------------------------------------------------------------------
+struct TMcpResourceContents
+{
+    std::string Uri;
+    std::string MimeType = "application/json";
+    std::string Text;
+
+    json ToJson() const
+    {
+        return json{{"uri", Uri}, {"mimeType", MimeType}, {"text", Text}};
+    }
+};
+
+// Fills contents for uri; returns false when uri names nothing. Runs on
+// the transport thread that handles resources/read.
+using TMcpResourceReader = std::function<bool(const std::string &uri,
+    TMcpResourceContents &contents)>;
+
+//---------------------------------------------------------------------------
+// TMcpResourceRegistry — resources, their readers and subscriptions
+//
+// Subscriptions belong to client sessions (see TMcpServer::HandleRequest);
+// an update goes to the sessions subscribed to its URI. Only fixed
+// resources can be subscribed, and a query names the whole resource: a
+// subscription to "clabot://events?offset=5" is one to clabot://events.
+// All members are thread-safe.
+//---------------------------------------------------------------------------
+class TMcpResourceRegistry
+{
+private:
+    using TReaderPtr = std::shared_ptr<const TMcpResourceReader>;
+
+    mutable std::mutex FMutex;
+    std::vector<TMcpResource> FResources;
+    std::vector<TMcpResourceTemplate> FTemplates;
+    std::map<std::string, TReaderPtr> FReaders;            // by exact URI
+    std::vector<std::pair<std::string, TReaderPtr>> FPrefixReaders;
+    std::map<std::string, std::set<std::string>> FSubscribers;  // URI -> sessions
+    std::set<std::string> FPending;                        // update not yet sent
+
+public:
+    // Adds or replaces the resource with this URI
+    void Add(const TMcpResource &resource, TMcpResourceReader reader)
+    {
+        std::lock_guard<std::mutex> lock(FMutex);
+        auto it = std::find_if(FResources.begin(), FResources.end(),
+            [&](const TMcpResource &r) { return r.Uri == resource.Uri; });
+        if (it != FResources.end())
+            *it = resource;
+        else
+            FResources.push_back(resource);
+        FReaders[resource.Uri] = std::make_shared<const TMcpResourceReader>(std::move(reader));
+    }
+
+    // URIs starting with uriPrefix are read by reader; the longest
+    // matching prefix wins
+    void AddTemplate(const TMcpResourceTemplate &resourceTemplate,
+        const std::string &uriPrefix, TMcpResourceReader reader)
+    {
+        std::lock_guard<std::mutex> lock(FMutex);
+        FTemplates.push_back(resourceTemplate);
+        FPrefixReaders.emplace_back(uriPrefix,
+            std::make_shared<const TMcpResourceReader>(std::move(reader)));
+    }
+
+    bool IsEmpty() const
+    {
+        std::lock_guard<std::mutex> lock(FMutex);
+        return FResources.empty() && FTemplates.empty();
+    }
+
+    json ListJson() const
+    {
+        std::lock_guard<std::mutex> lock(FMutex);
+        json list = json::array();
+        for (const TMcpResource &resource : FResources)
+            list.push_back(resource.ToJson());
+        return json{{"resources", std::move(list)}};
+    }
+
+    json ListTemplatesJson() const
+    {
+        std::lock_guard<std::mutex> lock(FMutex);
+        json list = json::array();
+        for (const TMcpResourceTemplate &resourceTemplate : FTemplates)
+            list.push_back(resourceTemplate.ToJson());
+        return json{{"resourceTemplates", std::move(list)}};
+    }
+
+    // False when no reader covers uri or the reader does not know it.
+    // The reader runs outside the registry lock.
+    bool Read(const std::string &uri, TMcpResourceContents &contents) const
+    {
+        TReaderPtr reader = FindReader(uri);
+        if (!reader)
+            return false;
+        contents.Uri = uri;
+        return (*reader)(uri, contents);
+    }
+
+    // uri without its query
+    static std::string BaseUri(const std::string &uri)
+    {
+        return uri.substr(0, uri.find('?'));
+    }
+
+    // False when uri is not a fixed resource; URIs read through a template
+    // are never updated. Subscribing twice is the same as once.
+    bool Subscribe(const std::string &uri, const std::string &session)
+    {
+        std::string base = BaseUri(uri);
+        std::lock_guard<std::mutex> lock(FMutex);
+        if (FReaders.count(base) == 0)
+            return false;
+        FSubscribers[base].insert(session);
+        return true;
+    }
+
+    // Other sessions subscribed to uri keep their subscription
+    void Unsubscribe(const std::string &uri, const std::string &session)
+    {
+        std::lock_guard<std::mutex> lock(FMutex);
+        auto it = FSubscribers.find(BaseUri(uri));
+        if (it == FSubscribers.end())
+            return;
+        it->second.erase(session);
+        if (it->second.empty())
+            DropUri(it);
+    }
+
+    // The session has ended; all its subscriptions go
+    void EndSession(const std::string &session)
+    {
+        std::lock_guard<std::mutex> lock(FMutex);
+        for (auto it = FSubscribers.begin(); it != FSubscribers.end();)
+        {
+            auto current = it++;
+            current->second.erase(session);
+            if (current->second.empty())
+                DropUri(current);
+        }
+    }
+
+    // True when uri is subscribed and no update is pending for it yet;
+    // the caller then sends one (after TakePending)
+    bool MarkUpdated(const std::string &uri)
+    {
+        std::lock_guard<std::mutex> lock(FMutex);
+        if (FSubscribers.count(uri) == 0)
+            return false;
+        return FPending.insert(uri).second;
+    }
+
+    // Clears the pending update and gives the sessions to send it to;
+    // false if the last of them unsubscribed meanwhile
+    bool TakePending(const std::string &uri, std::vector<std::string> &sessions)
+    {
+        std::lock_guard<std::mutex> lock(FMutex);
+        if (FPending.erase(uri) == 0)
+            return false;
+        const std::set<std::string> &subscribers = FSubscribers.at(uri);
+        sessions.assign(subscribers.begin(), subscribers.end());
+        return true;
+    }
+
+private:
+    // FMutex held
+    void DropUri(std::map<std::string, std::set<std::string>>::iterator it)
+    {
+        FPending.erase(it->first);
+        FSubscribers.erase(it);
+    }
+
+    TReaderPtr FindReader(const std::string &uri) const
+    {
+        std::lock_guard<std::mutex> lock(FMutex);
+
+        // A query (?offset=...) selects part of a fixed resource
+        auto it = FReaders.find(BaseUri(uri));
+        if (it != FReaders.end())
+            return it->second;
+
+        TReaderPtr best;
+        size_t bestLength = 0;
+        for (const auto &pair : FPrefixReaders)
+        {
+            if (pair.first.size() >= bestLength && uri.compare(0, pair.first.size(), pair.first) == 0)
+            {
+                best = pair.second;
+                bestLength = pair.first.size();
+            }
+        }
+        return best;
+    }
+};
+
+} // namespace Mcp
+
+//---------------------------------------------------------------------------
+#endif // McpResourcesH
@@ -0,0 +1,188 @@
+//---------------------------------------------------------------------------
+// McpResultCache.h — TTL result cache with in-flight call coalescing
+//
+// Used for read-only, idempotent tools: a repeated call within the TTL is
+// answered from the cache, and identical calls that arrive while one is
+// running wait for its result instead of running again (singleflight).
+// Entries are also tagged with a state generation; a call made at a newer
+// generation never sees an older entry. Every leader has its own in-flight
+// record, so a call still running from an older generation answers the
+// callers that joined it even after a newer one has started. A leader that
+// gives up without a value (its own caller cancelled) abandons the call:
+// the callers that joined it are told to try again, and the first of them
+// to do so becomes the new leader.
+// Pure C++ - NO VCL dependencies.
+//---------------------------------------------------------------------------
+
+#ifndef McpResultCacheH
+#define McpResultCacheH
+
+//---------------------------------------------------------------------------
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <chrono>
+#include <functional>
+
+namespace Mcp {
+
+//---------------------------------------------------------------------------
+// TMcpResultCache — keyed by a canonical argument string
+//---------------------------------------------------------------------------
+template<typename TValue>
+class TMcpResultCache
+{
+public:
+    using TClock = std::chrono::steady_clock;
+    // value is null when the leader abandoned the call
+    using TWaiter = std::function<void(const TValue *value)>;
+
+    enum class TLookup
+    {
+        Hit,     // value was filled in from the cache
+        Joined,  // an identical call is running; the waiter gets its result
+        Leader   // caller must execute and then call Complete
+    };
+
+private:
+    struct TEntry
+    {
+        TValue Value;
+        uint64_t Generation = 0;
+        TClock::time_point Expires;
+    };
+
+    struct TInFlight
+    {
+        std::string Key;
+        uint64_t Generation = 0;
+        std::vector<TWaiter> Waiters;
+    };
+
+public:
+    // A leader's call; handed back to Complete
+    using TFlight = std::shared_ptr<TInFlight>;
+
+private:
+    static constexpr size_t MaxEntries = 256;
+
+    std::chrono::milliseconds FTtl;
+    std::unordered_map<std::string, TEntry> FEntries;
+    std::unordered_map<std::string, TFlight> FInFlight;  // the call new callers join
+    std::mutex FMutex;
+
+public:
+    explicit TMcpResultCache(std::chrono::milliseconds ttl)
+        : FTtl(ttl)
+    {}
+
+    TMcpResultCache(const TMcpResultCache&) = delete;
+    TMcpResultCache& operator=(const TMcpResultCache&) = delete;
+
+    std::chrono::milliseconds GetTtl() const { return FTtl; }
+
+    // A Leader gets its call in flight. makeWaiter() builds the TWaiter;
+    // it is only called when the caller joins.
+    template<typename TMakeWaiter>
+    TLookup Acquire(const std::string &key, uint64_t generation, TValue &value,
+        TMakeWaiter &&makeWaiter, TFlight &flight)
+    {
+        std::lock_guard<std::mutex> lock(FMutex);
+
+        auto entryIt = FEntries.find(key);
+        if (entryIt != FEntries.end())
+        {
+            if (entryIt->second.Generation == generation &&
+                TClock::now() < entryIt->second.Expires)
+            {
+                value = entryIt->second.Value;
+                return TLookup::Hit;
+            }
+            FEntries.erase(entryIt);
+        }
+
+        auto flightIt = FInFlight.find(key);
+        if (flightIt != FInFlight.end() && flightIt->second->Generation == generation)
+        {
+            flightIt->second->Waiters.push_back(makeWaiter());
+            return TLookup::Joined;
+        }
+
+        // A call still running from an older generation keeps its record
+        // and its waiters; it is only no longer the one new callers join
+        flight = std::make_shared<TInFlight>();
+        flight->Key = key;
+        flight->Generation = generation;
+        FInFlight[key] = flight;
+        return TLookup::Leader;
+    }
+
+    // Delivers the leader's value to the callers that joined it, and
+    // stores it when cacheable (e.g. not an error)
+    void Complete(const TFlight &flight, const TValue &value, bool cacheable)
+    {
+        std::vector<TWaiter> waiters;
+        {
+            std::lock_guard<std::mutex> lock(FMutex);
+            waiters.swap(flight->Waiters);
+            auto flightIt = FInFlight.find(flight->Key);
+            if (flightIt != FInFlight.end() && flightIt->second == flight)
+                FInFlight.erase(flightIt);
+
+            // An older call finishing late does not replace a newer result
+            auto entryIt = FEntries.find(flight->Key);
+            if (cacheable && FTtl.count() > 0 &&
+                (entryIt == FEntries.end() || entryIt->second.Generation <= flight->Generation))
+            {
+                if (FEntries.size() >= MaxEntries)
+                    EvictExpired();
+                FEntries[flight->Key] = TEntry{value, flight->Generation, TClock::now() + FTtl};
+            }
+        }
+
+        for (auto &waiter : waiters)
+            waiter(&value);
+    }
+
+    // The leader has no value to share; its waiters retry
+    void Abandon(const TFlight &flight)
+    {
+        std::vector<TWaiter> waiters;
+        {
+            std::lock_guard<std::mutex> lock(FMutex);
+            waiters.swap(flight->Waiters);
+            auto flightIt = FInFlight.find(flight->Key);
+            if (flightIt != FInFlight.end() && flightIt->second == flight)
+                FInFlight.erase(flightIt);
+        }
+
+        for (auto &waiter : waiters)
+            waiter(nullptr);
+    }
+
+private:
+    // Caller holds FMutex. Falls back to a full clear when nothing has
+    // expired, which keeps the cache bounded for callers that vary their
+    // arguments.
+    void EvictExpired()
+    {
+        TClock::time_point now = TClock::now();
+        for (auto it = FEntries.begin(); it != FEntries.end(); )
+        {
+            if (it->second.Expires <= now)
+                it = FEntries.erase(it);
+            else
+                ++it;
+        }
+        if (FEntries.size() >= MaxEntries)
+            FEntries.clear();
+    }
+};
+
+} // namespace Mcp
+
+//---------------------------------------------------------------------------
+#endif // McpResultCacheH
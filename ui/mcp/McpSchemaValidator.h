@@ -0,0 +1,270 @@
+//---------------------------------------------------------------------------
+// McpSchemaValidator.h — Precompiled validator for tool input schemas
+//
+// A tool's inputSchema is compiled once, at registration, into a flat
+// property table. Validation is then a single pass over the arguments
+// object: each key is looked up, its type and enum checked, and the
+// required set is verified from a bitmap at the end.
+// Pure C++ with nlohmann::json - NO VCL dependencies.
+//---------------------------------------------------------------------------
+
+#ifndef McpSchemaValidatorH
+#define McpSchemaValidatorH
+
+//---------------------------------------------------------------------------
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cmath>
+
+#include "../../external/nlohmann/json.hpp"
+
+namespace Mcp {
+
+using json = nlohmann::json;
+
+//---------------------------------------------------------------------------
+// TMcpSchemaValidator — compiled form of an object schema
+//
+// Supported keywords: properties, required, and per property type
+// (string, integer, number, boolean, object, array), enum, and minimum and
+// maximum for numbers. Properties
+// without a known type accept any value; keys not listed in properties
+// are allowed. A null value counts as absent, matching how tools read
+// optional arguments.
+//---------------------------------------------------------------------------
+class TMcpSchemaValidator
+{
+public:
+    enum class TValueType { Any, String, Integer, Number, Boolean, Object, Array };
+
+private:
+    struct TProperty
+    {
+        std::string Name;
+        TValueType Type = TValueType::Any;
+        bool Required = false;
+        std::vector<json> EnumValues;
+        json Minimum;                   // null when unbounded
+        json Maximum;
+    };
+
+    std::vector<TProperty> FProperties;
+    std::unordered_map<std::string, size_t> FIndex;
+    size_t FRequiredCount = 0;
+
+public:
+    TMcpSchemaValidator() = default;
+
+    explicit TMcpSchemaValidator(const json &schema)
+    {
+        Compile(schema);
+    }
+
+    size_t GetPropertyCount() const { return FProperties.size(); }
+
+    // Returns true when args conform; otherwise error holds the reason
+    bool Validate(const json &args, std::string &error) const
+    {
+        if (!args.is_object())
+        {
+            error = "Invalid 'arguments': expected object";
+            return false;
+        }
+        if (FProperties.empty())
+            return true;
+
+        size_t requiredSeen = 0;
+        std::vector<bool> seen(FProperties.size());
+
+        for (auto it = args.begin(); it != args.end(); ++it)
+        {
+            if (it->is_null())
+                continue;
+
+            auto found = FIndex.find(it.key());
+            if (found == FIndex.end())
+                continue;
+
+            const TProperty &prop = FProperties[found->second];
+            if (!CheckType(prop.Type, *it))
+            {
+                error = "Invalid argument '" + prop.Name + "': expected " +
+                    TypeName(prop.Type);
+                return false;
+            }
+            if (!prop.EnumValues.empty() && !CheckEnum(prop, *it))
+            {
+                error = "Invalid argument '" + prop.Name + "': must be one of " +
+                    json(prop.EnumValues).dump();
+                return false;
+            }
+            if (!CheckRange(prop, *it, error))
+                return false;
+            if (prop.Required && !seen[found->second])
+                requiredSeen++;
+            seen[found->second] = true;
+        }
+
+        if (requiredSeen == FRequiredCount)
+            return true;
+
+        for (size_t i = 0; i < FProperties.size(); i++)
+        {
+            if (FProperties[i].Required && !seen[i])
+            {
+                error = "Missing required argument '" + FProperties[i].Name + "'";
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static const char* TypeName(TValueType type)
+    {
+        switch (type)
+        {
+        case TValueType::String:  return "string";
+        case TValueType::Integer: return "integer";
+        case TValueType::Number:  return "number";
+        case TValueType::Boolean: return "boolean";
+        case TValueType::Object:  return "object";
+        case TValueType::Array:   return "array";
+        default:                  return "any";
+        }
+    }
+
+private:
+    void Compile(const json &schema)
+    {
+        if (!schema.is_object())
+            return;
+
+        auto propsIt = schema.find("properties");
+        if (propsIt != schema.end() && propsIt->is_object())
+        {
+            for (auto it = propsIt->begin(); it != propsIt->end(); ++it)
+            {
+                TProperty prop;
+                prop.Name = it.key();
+                if (it->is_object())
+                {
+                    auto typeIt = it->find("type");
+                    if (typeIt != it->end() && typeIt->is_string())
+                        prop.Type = ParseType(typeIt->get_ref<const std::string&>());
+
+                    auto enumIt = it->find("enum");
+                    if (enumIt != it->end() && enumIt->is_array())
+                        prop.EnumValues.assign(enumIt->begin(), enumIt->end());
+
+                    auto minimumIt = it->find("minimum");
+                    if (minimumIt != it->end() && minimumIt->is_number())
+                        prop.Minimum = *minimumIt;
+                    auto maximumIt = it->find("maximum");
+                    if (maximumIt != it->end() && maximumIt->is_number())
+                        prop.Maximum = *maximumIt;
+                }
+                FIndex.emplace(prop.Name, FProperties.size());
+                FProperties.push_back(std::move(prop));
+            }
+        }
+
+        auto requiredIt = schema.find("required");
+        if (requiredIt != schema.end() && requiredIt->is_array())
+        {
+            for (const auto &name : *requiredIt)
+            {
+                if (!name.is_string())
+                    continue;
+                const std::string &key = name.get_ref<const std::string&>();
+                auto found = FIndex.find(key);
+                if (found == FIndex.end())
+                {
+                    // Required but not described: any type
+                    TProperty prop;
+                    prop.Name = key;
+                    found = FIndex.emplace(key, FProperties.size()).first;
+                    FProperties.push_back(std::move(prop));
+                }
+                TProperty &prop = FProperties[found->second];
+                if (!prop.Required)
+                {
+                    prop.Required = true;
+                    FRequiredCount++;
+                }
+            }
+        }
+    }
+
+    static TValueType ParseType(const std::string &type)
+    {
+        if (type == "string")  return TValueType::String;
+        if (type == "integer") return TValueType::Integer;
+        if (type == "number")  return TValueType::Number;
+        if (type == "boolean") return TValueType::Boolean;
+        if (type == "object")  return TValueType::Object;
+        if (type == "array")   return TValueType::Array;
+        return TValueType::Any;
+    }
+
+    static bool CheckType(TValueType type, const json &val)
+    {
+        switch (type)
+        {
+        case TValueType::String:  return val.is_string();
+        case TValueType::Number:  return val.is_number();
+        case TValueType::Boolean: return val.is_boolean();
+        case TValueType::Object:  return val.is_object();
+        case TValueType::Array:   return val.is_array();
+        case TValueType::Integer:
+            if (val.is_number_integer())
+                return true;
+            if (val.is_number_float())
+            {
+                // JSON Schema: 1.0 is an integer
+                double d = val.get<double>();
+                return std::isfinite(d) && d == std::floor(d);
+            }
+            return false;
+        default:
+            return true;
+        }
+    }
+
+    // Compared as doubles: exact for the int bounds tools use, and any
+    // integer too large for a double is outside them anyway
+    static bool CheckRange(const TProperty &prop, const json &val, std::string &error)
+    {
+        if (!val.is_number() || (prop.Minimum.is_null() && prop.Maximum.is_null()))
+            return true;
+        double number = val.get<double>();
+        if (!prop.Minimum.is_null() && number < prop.Minimum.get<double>())
+        {
+            error = "Invalid argument '" + prop.Name + "': must be at least " +
+                prop.Minimum.dump();
+            return false;
+        }
+        if (!prop.Maximum.is_null() && number > prop.Maximum.get<double>())
+        {
+            error = "Invalid argument '" + prop.Name + "': must be at most " +
+                prop.Maximum.dump();
+            return false;
+        }
+        return true;
+    }
+
+    static bool CheckEnum(const TProperty &prop, const json &val)
+    {
+        for (const auto &allowed : prop.EnumValues)
+        {
+            if (allowed == val)
+                return true;
+        }
+        return false;
+    }
+};
+
+} // namespace Mcp
+
+//---------------------------------------------------------------------------
+#endif // McpSchemaValidatorH
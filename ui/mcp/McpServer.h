@@ -14,14 +14,29 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <unordered_map>
 #include <memory>
 #include <functional>
 #include <mutex>
+#include <atomic>
+#include <string_view>
 #include <stdexcept>
 #include <sstream>
 #include <algorithm>
+#include <future>
+#include <climits>
 
 #include "../../external/nlohmann/json.hpp"
+#include "McpWorkerPool.h"
+#include "McpEnvelopeScanner.h"
+#include "McpSchemaValidator.h"
+#include "McpAsync.h"
+#include "McpArena.h"
+#include "McpJsonWriter.h"
+#include "McpMetrics.h"
+#include "McpResultCache.h"
+#include "McpResources.h"
+#include "McpTrace.h"
 
 namespace Mcp {
 
@@ -39,6 +54,9 @@ namespace ErrorCode {
     constexpr int ToolNotFound = -32001;
     constexpr int ToolExecutionError = -32002;
     constexpr int ProviderNotReady = -32003;
+    constexpr int RequestTimeout = -32004;
+    constexpr int ResourceNotFound = -32002;   // the MCP spec's code
+    constexpr int RequestCancelled = -32800;
 }
 
 //---------------------------------------------------------------------------
@@ -65,6 +83,53 @@ struct TMcpToolAnnotations
     }
 };
 
+//---------------------------------------------------------------------------
+// TMcpExecutionPolicy — Where a tool runs and how many calls at once
+//
+// MainThread tools run through the dispatcher given to
+// TMcpServer::SetMainThreadDispatcher (e.g. the VCL thread), a limited
+// number at a time across all such tools. AnyThread tools run on the
+// thread that handles the request. Serialized tools run on any thread,
+// one call at a time. MaxConcurrency caps the calls of one tool running
+// at once (0 = no limit); calls over a limit wait in order without
+// holding a thread.
+//---------------------------------------------------------------------------
+enum class TMcpThreadAffinity
+{
+    AnyThread,
+    MainThread,
+    Serialized
+};
+
+struct TMcpExecutionPolicy
+{
+    TMcpThreadAffinity Affinity = TMcpThreadAffinity::AnyThread;
+    unsigned MaxConcurrency = 0;
+
+    static TMcpExecutionPolicy AnyThread(unsigned maxConcurrency = 0)
+    {
+        return TMcpExecutionPolicy{TMcpThreadAffinity::AnyThread, maxConcurrency};
+    }
+
+    static TMcpExecutionPolicy MainThread(unsigned maxConcurrency = 0)
+    {
+        return TMcpExecutionPolicy{TMcpThreadAffinity::MainThread, maxConcurrency};
+    }
+
+    static TMcpExecutionPolicy Serialized()
+    {
+        return TMcpExecutionPolicy{TMcpThreadAffinity::Serialized, 1};
+    }
+
+    // Per-tool limit that applies; 0 when unlimited
+    unsigned GetConcurrencyLimit() const
+    {
+        if (Affinity == TMcpThreadAffinity::Serialized)
+            return 1;
+        return MaxConcurrency;
+    }
+};
+
 //---------------------------------------------------------------------------
 // TMcpSchemaProperty — Single property in JSON Schema
 //---------------------------------------------------------------------------
@@ -75,6 +140,8 @@ struct TMcpSchemaProperty
     std::string Description;
     bool Required = false;
     std::vector<std::string> EnumValues;
+    int Minimum = INT_MIN;                   // integer properties only
+    int Maximum = INT_MAX;
 
     TMcpSchemaProperty() = default;
 
@@ -101,10 +168,15 @@ public:
         return *this;
     }
 
+    // Tools read integers into int, so the range defaults to int's and is
+    // published as minimum/maximum; the validator rejects values outside it
     TMcpToolSchema& AddInteger(const std::string &name, const std::string &desc,
-        bool required = false)
+        bool required = false, int minimum = INT_MIN, int maximum = INT_MAX)
     {
-        FProperties.emplace_back(name, "integer", desc, required);
+        TMcpSchemaProperty prop(name, "integer", desc, required);
+        prop.Minimum = minimum;
+        prop.Maximum = maximum;
+        FProperties.push_back(prop);
         if (required) FRequired.push_back(name);
         return *this;
     }
@@ -141,6 +213,11 @@ public:
                 propDef["description"] = p.Description;
             if (!p.EnumValues.empty())
                 propDef["enum"] = p.EnumValues;
+            if (p.Type == "integer")
+            {
+                propDef["minimum"] = p.Minimum;
+                propDef["maximum"] = p.Maximum;
+            }
             props[p.Name] = propDef;
         }
         schema["properties"] = props;
@@ -154,19 +231,115 @@ public:
 
 //---------------------------------------------------------------------------
 // TMcpToolContext — Execution context passed to tools
+//
+// One context is created per tools/call. Asynchronous tools may keep it
+// (through the shared_ptr given to ExecuteAsync) until they complete.
+// Long-running tools check ShouldStop, or register on the cancellation
+// token, so abandoned calls stop early.
 //---------------------------------------------------------------------------
 class TMcpToolContext
 {
+public:
+    using TClock = std::chrono::steady_clock;
+    using TNotifySink = std::function<void(const std::string &method, const json &params)>;
+
+private:
+    json FProgressToken;
+    TNotifySink FNotify;
+    std::shared_ptr<TMcpCancellationToken> FCancellation =
+        McpMakeShared<TMcpCancellationToken>();
+    TClock::time_point FDeadline = TClock::time_point::max();
+    TMcpCallStats *FStats = nullptr;
+    json FRequestId;
+    std::string FSession;
+
 public:
     TMcpToolContext() = default;
+
+    TMcpToolContext(json progressToken, TNotifySink notify)
+        : FProgressToken(std::move(progressToken))
+        , FNotify(std::move(notify))
+    {}
+
+    // Set by the server from params._meta.timeoutMs
+    void SetDeadline(TClock::time_point deadline) { FDeadline = deadline; }
+    bool HasDeadline() const { return FDeadline != TClock::time_point::max(); }
+    TClock::time_point GetDeadline() const { return FDeadline; }
+
+    // Time left before the deadline: zero once it has passed, and
+    // milliseconds::max() without a deadline
+    std::chrono::milliseconds GetRemainingTime() const
+    {
+        if (!HasDeadline())
+            return std::chrono::milliseconds::max();
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+            FDeadline - TClock::now());
+        return left.count() > 0 ? left : std::chrono::milliseconds(0);
+    }
+
+    bool IsExpired() const { return HasDeadline() && TClock::now() >= FDeadline; }
+    bool IsCancelled() const { return FCancellation->IsCancelled(); }
+
+    // True once nobody is waiting for the result
+    bool ShouldStop() const { return IsCancelled() || IsExpired(); }
+
+    // Cancelled by notifications/cancelled or when the deadline passes
+    TMcpCancellationToken& GetCancellation() const { return *FCancellation; }
+    std::shared_ptr<TMcpCancellationToken> GetCancellationToken() const { return FCancellation; }
+
+    // JSON-RPC id of the request; set by the server
+    void SetRequestId(json id) { FRequestId = std::move(id); }
+    const json& GetRequestId() const { return FRequestId; }
+
+    // Client session of the request (see TMcpServer::HandleRequest); set
+    // by the server
+    void SetSession(std::string session) { FSession = std::move(session); }
+    const std::string& GetSession() const { return FSession; }
+
+    // Stats of the tool being run; set by the server
+    void SetStats(TMcpCallStats *stats) { FStats = stats; }
+
+    // Report time spent blocked on another thread (e.g. a main-thread
+    // hop); shows up as "wait" in server_get_metrics
+    void RecordWait(TClock::duration elapsed) const
+    {
+        if (FStats)
+            FStats->Wait.Record(elapsed);
+    }
+
+    // The client asked for progress (params._meta.progressToken)
+    bool HasProgressToken() const { return !FProgressToken.is_null(); }
+    const json& GetProgressToken() const { return FProgressToken; }
+
+    // Sends notifications/progress; a no-op unless the client supplied a
+    // progress token. total <= 0 means unknown.
+    void ReportProgress(double progress, double total = 0,
+        const std::string &message = std::string()) const
+    {
+        if (FProgressToken.is_null() || !FNotify)
+            return;
+
+        json params;
+        params["progressToken"] = FProgressToken;
+        params["progress"] = progress;
+        if (total > 0)
+            params["total"] = total;
+        if (!message.empty())
+            params["message"] = message;
+        FNotify("notifications/progress", params);
+    }
 };
 
 //---------------------------------------------------------------------------
 // TMcpToolResult — Result from tool execution
+//
+// RawContent, when set, is pre-serialized JSON that is spliced into the
+// response as is (never parsed); it takes precedence over Content.
 //---------------------------------------------------------------------------
 struct TMcpToolResult
 {
     json Content;
+    std::shared_ptr<const std::string> RawContent;
     bool IsError = false;
     std::string ErrorMessage;
 
@@ -190,6 +363,14 @@ struct TMcpToolResult
         return r;
     }
 
+    // jsonText must be valid JSON; it is not checked
+    static TMcpToolResult SuccessRaw(std::string jsonText)
+    {
+        TMcpToolResult r;
+        r.RawContent = std::make_shared<const std::string>(std::move(jsonText));
+        return r;
+    }
+
     static TMcpToolResult Error(const std::string &message)
     {
         TMcpToolResult r;
@@ -203,6 +384,8 @@ struct TMcpToolResult
 //---------------------------------------------------------------------------
 // IMcpTool — Abstract interface for MCP tools
 //---------------------------------------------------------------------------
+using TMcpToolCompletion = std::function<void(TMcpToolResult result)>;
+
 class IMcpTool
 {
 public:
@@ -219,8 +402,22 @@ public:
         return ann;
     }
 
+    virtual TMcpExecutionPolicy GetExecutionPolicy() const
+    {
+        return TMcpExecutionPolicy();
+    }
+
     virtual TMcpToolResult Execute(const json &args, TMcpToolContext &context) = 0;
 
+    // Entry point used by the server. done must be called exactly once,
+    // from any thread; args is only valid for the duration of this call.
+    // The default runs Execute inline, so synchronous tools need nothing.
+    virtual void ExecuteAsync(const json &args, std::shared_ptr<TMcpToolContext> context,
+        TMcpToolCompletion done)
+    {
+        done(Execute(args, *context));
+    }
+
     json ToToolJson() const
     {
         json tool;
@@ -258,13 +455,27 @@ public:
         const auto &val = args[key];
         if (val.is_null())
             return defaultValue;
+        int result = defaultValue;
         if (val.is_number_integer())
-            return val.get<int>();
-        if (val.is_string()) {
+            ToInt(val, result);
+        else if (val.is_string()) {
             try { return std::stoi(val.get<std::string>()); }
             catch (...) { return defaultValue; }
         }
-        return defaultValue;
+        return result;
+    }
+
+    // A number within int range, truncated toward zero. Anything else,
+    // 1e20 or 4294967297 included, leaves out unchanged and returns false.
+    static bool ToInt(const json &val, int &out)
+    {
+        if (!val.is_number())
+            return false;
+        double number = val.get<double>();
+        if (!(number >= INT_MIN && number <= INT_MAX))
+            return false;
+        out = static_cast<int>(number);
+        return true;
     }
 
     static bool GetBool(const json &args, const std::string &key, bool defaultValue = false)
@@ -298,6 +509,7 @@ private:
     std::string FDescription;
     TMcpToolSchema FSchema;
     TMcpToolAnnotations FAnnotations;
+    TMcpExecutionPolicy FPolicy;
     ExecuteFunc FExecute;
 
 public:
@@ -317,10 +529,17 @@ public:
         return *this;
     }
 
+    TMcpLambdaTool& WithExecutionPolicy(const TMcpExecutionPolicy &policy)
+    {
+        FPolicy = policy;
+        return *this;
+    }
+
     std::string GetName() const override { return FName; }
     std::string GetDescription() const override { return FDescription; }
     TMcpToolSchema GetInputSchema() const override { return FSchema; }
     TMcpToolAnnotations GetAnnotations() const override { return FAnnotations; }
+    TMcpExecutionPolicy GetExecutionPolicy() const override { return FPolicy; }
 
     TMcpToolResult Execute(const json &args, TMcpToolContext &context) override
     {
@@ -330,17 +549,144 @@ public:
     }
 };
 
+//---------------------------------------------------------------------------
+// TMcpAsyncLambdaTool — Tool that completes through a callback
+//
+// The function returns as soon as the work is scheduled; it calls done
+// later (e.g. from a TMcpCounterWaiter or TMcpTimerService callback), so
+// no thread is held while it waits.
+//---------------------------------------------------------------------------
+class TMcpAsyncLambdaTool : public TMcpToolBase
+{
+public:
+    using ExecuteAsyncFunc = std::function<void(const json&,
+        std::shared_ptr<TMcpToolContext>, TMcpToolCompletion)>;
+
+private:
+    std::string FName;
+    std::string FDescription;
+    TMcpToolSchema FSchema;
+    TMcpToolAnnotations FAnnotations;
+    TMcpExecutionPolicy FPolicy;
+    ExecuteAsyncFunc FExecute;
+
+public:
+    TMcpAsyncLambdaTool(const std::string &name, const std::string &description,
+        const TMcpToolSchema &schema, ExecuteAsyncFunc executeFunc)
+        : FName(name)
+        , FDescription(description)
+        , FSchema(schema)
+        , FExecute(std::move(executeFunc))
+    {
+        FAnnotations.Title = name;
+    }
+
+    TMcpAsyncLambdaTool& WithAnnotations(const TMcpToolAnnotations &ann)
+    {
+        FAnnotations = ann;
+        return *this;
+    }
+
+    TMcpAsyncLambdaTool& WithExecutionPolicy(const TMcpExecutionPolicy &policy)
+    {
+        FPolicy = policy;
+        return *this;
+    }
+
+    std::string GetName() const override { return FName; }
+    std::string GetDescription() const override { return FDescription; }
+    TMcpToolSchema GetInputSchema() const override { return FSchema; }
+    TMcpToolAnnotations GetAnnotations() const override { return FAnnotations; }
+    TMcpExecutionPolicy GetExecutionPolicy() const override { return FPolicy; }
+
+    void ExecuteAsync(const json &args, std::shared_ptr<TMcpToolContext> context,
+        TMcpToolCompletion done) override
+    {
+        if (FExecute)
+            FExecute(args, std::move(context), std::move(done));
+        else
+            done(TMcpToolResult::Error("No execute function defined"));
+    }
+
+    // Blocking fallback for callers that use the synchronous interface
+    TMcpToolResult Execute(const json &args, TMcpToolContext &context) override
+    {
+        auto promise = std::make_shared<std::promise<TMcpToolResult>>();
+        std::future<TMcpToolResult> future = promise->get_future();
+        ExecuteAsync(args, std::make_shared<TMcpToolContext>(context),
+            [promise](TMcpToolResult result) { promise->set_value(std::move(result)); });
+        return future.get();
+    }
+};
+
 //---------------------------------------------------------------------------
 // TMcpToolRegistry — Central registry for MCP tools
+//
+// Readers never take the registry lock: they load the current immutable
+// snapshot with std::atomic_load. Register copies the snapshot, adds the
+// tool and publishes the copy. A replaced snapshot is freed once the last
+// call that found a tool in it is over: Find hands out the snapshot with
+// the tool (TMcpRegisteredTool::Snapshot), and a call holds it while it
+// runs.
 //---------------------------------------------------------------------------
+using TOnToolsListChanged = std::function<void()>;
+
+// A finished tools/call result as kept by a tool's result cache
+struct TMcpCachedToolResponse
+{
+    std::shared_ptr<const std::string> Payload;  // serialized tools/call result
+    bool IsError = false;
+    std::string ErrorMessage;
+};
+
+using TMcpToolResultCache = TMcpResultCache<TMcpCachedToolResponse>;
+
+struct TMcpRegisteredTool
+{
+    IMcpTool *Tool = nullptr;
+    const TMcpSchemaValidator *Validator = nullptr;  // compiled inputSchema
+    const TMcpToolAnnotations *Annotations = nullptr;
+    const TMcpExecutionPolicy *Policy = nullptr;
+    TMcpCallStats *Stats = nullptr;                  // kept across re-registration
+    TMcpToolResultCache *Cache = nullptr;            // null unless enabled
+    TMcpConcurrencyLimiter *Limiter = nullptr;       // null when unlimited
+    std::shared_ptr<const void> Snapshot;            // keeps the pointers above valid
+};
+
 class TMcpToolRegistry
 {
 private:
-    std::map<std::string, std::unique_ptr<IMcpTool>> FTools;
-    mutable std::mutex FMutex;
+    struct TToolEntry
+    {
+        std::shared_ptr<IMcpTool> Tool;
+        std::shared_ptr<const TMcpSchemaValidator> Validator;
+        std::shared_ptr<const TMcpToolAnnotations> Annotations;
+        std::shared_ptr<const TMcpExecutionPolicy> Policy;
+        std::shared_ptr<TMcpCallStats> Stats;
+        std::shared_ptr<TMcpToolResultCache> Cache;
+        std::shared_ptr<TMcpConcurrencyLimiter> Limiter;
+    };
+
+    struct TSnapshot
+    {
+        std::map<std::string, TToolEntry> Tools;                 // tools/list order
+        std::unordered_map<std::string_view, TMcpRegisteredTool> Index;  // keys view into Tools
+        std::shared_ptr<const std::string> ToolsListPayload;     // serialized tools/list
+    };
+
+    // Only through std::atomic_load / std::atomic_store
+    std::shared_ptr<const TSnapshot> FCurrent;
+    TOnToolsListChanged FOnListChanged;
+    mutable std::mutex FWriteMutex;
 
 public:
-    TMcpToolRegistry() = default;
+    TMcpToolRegistry()
+    {
+        auto empty = std::make_shared<TSnapshot>();
+        empty->ToolsListPayload = std::make_shared<const std::string>(
+            BuildToolsListJson(*empty).dump());
+        std::atomic_store(&FCurrent, std::shared_ptr<const TSnapshot>(std::move(empty)));
+    }
 
     TMcpToolRegistry(const TMcpToolRegistry&) = delete;
     TMcpToolRegistry& operator=(const TMcpToolRegistry&) = delete;
@@ -348,9 +694,84 @@ public:
     void Register(std::unique_ptr<IMcpTool> tool)
     {
         if (!tool) return;
-        std::lock_guard<std::mutex> lock(FMutex);
-        std::string name = tool->GetName();
-        FTools[name] = std::move(tool);
+        TOnToolsListChanged onChanged;
+        {
+            std::lock_guard<std::mutex> lock(FWriteMutex);
+            const TSnapshot *current = FCurrent.get();
+
+            auto next = std::make_shared<TSnapshot>();
+            next->Tools = current->Tools;
+            std::string name = tool->GetName();
+            TToolEntry &entry = next->Tools[name];
+            entry.Validator = std::make_shared<const TMcpSchemaValidator>(
+                tool->GetInputSchema().ToJson());
+            entry.Annotations = std::make_shared<const TMcpToolAnnotations>(
+                tool->GetAnnotations());
+            SetPolicy(entry, tool->GetExecutionPolicy());
+            entry.Tool = std::shared_ptr<IMcpTool>(std::move(tool));
+            if (!entry.Stats)
+                entry.Stats = std::make_shared<TMcpCallStats>();
+
+            // A replaced tool keeps its cache setting but not the results
+            if (entry.Cache)
+            {
+                std::chrono::milliseconds ttl = entry.Cache->GetTtl();
+                entry.Cache.reset();
+                if (IsCacheable(*entry.Annotations))
+                    entry.Cache = std::make_shared<TMcpToolResultCache>(ttl);
+            }
+
+            next->ToolsListPayload = std::make_shared<const std::string>(
+                BuildToolsListJson(*next).dump());
+
+            Publish(std::move(next));
+            onChanged = FOnListChanged;
+        }
+        if (onChanged)
+            onChanged();
+    }
+
+    // Opt a registered tool into result caching: calls with the same
+    // arguments within ttl are answered from the cache, and identical
+    // calls in flight share one execution. Only read-only, idempotent
+    // tools qualify; returns false otherwise or when the tool is unknown.
+    bool EnableResultCache(const std::string &name, std::chrono::milliseconds ttl)
+    {
+        std::lock_guard<std::mutex> lock(FWriteMutex);
+        const TSnapshot *current = FCurrent.get();
+
+        auto it = current->Tools.find(name);
+        if (it == current->Tools.end() || !IsCacheable(*it->second.Annotations))
+            return false;
+
+        auto next = std::make_shared<TSnapshot>();
+        next->Tools = current->Tools;
+        next->Tools[name].Cache = std::make_shared<TMcpToolResultCache>(ttl);
+        next->ToolsListPayload = current->ToolsListPayload;
+        Publish(std::move(next));
+        return true;
+    }
+
+    // Override the policy a registered tool declares, e.g. for tools
+    // added through RegisterLambda. Returns false for unknown tools.
+    bool SetExecutionPolicy(const std::string &name, const TMcpExecutionPolicy &policy)
+    {
+        std::lock_guard<std::mutex> lock(FWriteMutex);
+        const TSnapshot *current = FCurrent.get();
+        if (current->Tools.find(name) == current->Tools.end())
+            return false;
+
+        auto next = std::make_shared<TSnapshot>();
+        next->Tools = current->Tools;
+        SetPolicy(next->Tools[name], policy);
+        next->ToolsListPayload = current->ToolsListPayload;
+        Publish(std::move(next));
+        return true;
+    }
+
+    static bool IsCacheable(const TMcpToolAnnotations &annotations)
+    {
+        return annotations.ReadOnlyHint && annotations.IdempotentHint;
     }
 
     void RegisterLambda(const std::string &name, const std::string &description,
@@ -359,20 +780,114 @@ public:
         Register(std::make_unique<TMcpLambdaTool>(name, description, schema, std::move(func)));
     }
 
-    IMcpTool* Get(const std::string &name) const
+    void RegisterLambda(const std::string &name, const std::string &description,
+        const TMcpToolSchema &schema, const TMcpToolAnnotations &annotations,
+        TMcpLambdaTool::ExecuteFunc func)
     {
-        std::lock_guard<std::mutex> lock(FMutex);
-        auto it = FTools.find(name);
-        return (it != FTools.end()) ? it->second.get() : nullptr;
+        auto tool = std::make_unique<TMcpLambdaTool>(name, description, schema, std::move(func));
+        TMcpToolAnnotations ann = annotations;
+        if (ann.Title.empty())
+            ann.Title = name;
+        tool->WithAnnotations(ann);
+        Register(std::move(tool));
+    }
+
+    void RegisterAsyncLambda(const std::string &name, const std::string &description,
+        const TMcpToolSchema &schema, TMcpAsyncLambdaTool::ExecuteAsyncFunc func)
+    {
+        Register(std::make_unique<TMcpAsyncLambdaTool>(name, description, schema, std::move(func)));
+    }
+
+    void RegisterAsyncLambda(const std::string &name, const std::string &description,
+        const TMcpToolSchema &schema, const TMcpToolAnnotations &annotations,
+        TMcpAsyncLambdaTool::ExecuteAsyncFunc func)
+    {
+        auto tool = std::make_unique<TMcpAsyncLambdaTool>(name, description, schema, std::move(func));
+        TMcpToolAnnotations ann = annotations;
+        if (ann.Title.empty())
+            ann.Title = name;
+        tool->WithAnnotations(ann);
+        Register(std::move(tool));
+    }
+
+    // Valid while the tool stays registered; calls use Find
+    IMcpTool* Get(std::string_view name) const
+    {
+        return Find(name).Tool;
+    }
+
+    // Tool plus its compiled input validator; both null when not found.
+    // The pointers stay valid while the result is held.
+    TMcpRegisteredTool Find(std::string_view name) const
+    {
+        std::shared_ptr<const TSnapshot> snapshot = std::atomic_load(&FCurrent);
+        auto it = snapshot->Index.find(name);
+        if (it == snapshot->Index.end())
+            return TMcpRegisteredTool();
+        TMcpRegisteredTool registered = it->second;
+        registered.Snapshot = std::move(snapshot);
+        return registered;
+    }
+
+    // Called after every Register, outside the registry lock
+    void SetOnListChanged(TOnToolsListChanged handler)
+    {
+        std::lock_guard<std::mutex> lock(FWriteMutex);
+        FOnListChanged = std::move(handler);
     }
 
     json GenerateToolsListJson() const
     {
-        std::lock_guard<std::mutex> lock(FMutex);
+        return BuildToolsListJson(*std::atomic_load(&FCurrent));
+    }
+
+    // Per-tool call stats, in tools/list order
+    json GetStatsJson() const
+    {
+        std::shared_ptr<const TSnapshot> snapshot = std::atomic_load(&FCurrent);
+        json stats = json::object();
+        for (const auto &pair : snapshot->Tools)
+            stats[pair.first] = pair.second.Stats->ToJson();
+        return stats;
+    }
+
+    // Serialized {"tools":[...]} result, built once per Register
+    std::shared_ptr<const std::string> GetToolsListPayload() const
+    {
+        return std::atomic_load(&FCurrent)->ToolsListPayload;
+    }
+
+private:
+    // Calls already waiting on a replaced limiter still drain through it
+    static void SetPolicy(TToolEntry &entry, const TMcpExecutionPolicy &policy)
+    {
+        entry.Policy = std::make_shared<const TMcpExecutionPolicy>(policy);
+        unsigned limit = policy.GetConcurrencyLimit();
+        entry.Limiter = limit > 0 ? std::make_shared<TMcpConcurrencyLimiter>(limit) : nullptr;
+    }
+
+    // Caller holds FWriteMutex
+    void Publish(std::shared_ptr<TSnapshot> next)
+    {
+        next->Index.reserve(next->Tools.size());
+        for (const auto &pair : next->Tools)
+        {
+            const TToolEntry &entry = pair.second;
+            next->Index.emplace(std::string_view(pair.first),
+                TMcpRegisteredTool{entry.Tool.get(), entry.Validator.get(),
+                    entry.Annotations.get(), entry.Policy.get(), entry.Stats.get(),
+                    entry.Cache.get(), entry.Limiter.get()});
+        }
+
+        std::atomic_store(&FCurrent, std::shared_ptr<const TSnapshot>(std::move(next)));
+    }
+
+    static json BuildToolsListJson(const TSnapshot &snapshot)
+    {
         json toolsArray = json::array();
-        for (const auto &pair : FTools)
-            toolsArray.push_back(pair.second->ToToolJson());
-        return json{{"tools", toolsArray}};
+        for (const auto &pair : snapshot.Tools)
+            toolsArray.push_back(pair.second.Tool->ToToolJson());
+        return json{{"tools", std::move(toolsArray)}};
     }
 };
 
@@ -412,39 +927,282 @@ struct TMcpServerCapabilities
     }
 };
 
+//---------------------------------------------------------------------------
+// TMcpMethodResult — Result from a JSON-RPC method handler
+//---------------------------------------------------------------------------
+struct TMcpMethodResult
+{
+    json Result;
+    std::shared_ptr<const std::string> RawResult;  // pre-serialized, wins over Result
+    bool IsError = false;
+    int ErrorCode = 0;
+    std::string ErrorMessage;
+
+    static TMcpMethodResult Success(json result)
+    {
+        TMcpMethodResult r;
+        r.Result = std::move(result);
+        return r;
+    }
+
+    // Result that is already serialized JSON; it is spliced into the
+    // response as-is
+    static TMcpMethodResult SuccessRaw(std::shared_ptr<const std::string> rawResult)
+    {
+        TMcpMethodResult r;
+        r.RawResult = std::move(rawResult);
+        return r;
+    }
+
+    static TMcpMethodResult Error(int code, const std::string &message)
+    {
+        TMcpMethodResult r;
+        r.IsError = true;
+        r.ErrorCode = code;
+        r.ErrorMessage = message;
+        return r;
+    }
+};
+
+//---------------------------------------------------------------------------
+// Method handlers — params is null when the request carries none.
+// Asynchronous handlers call done exactly once, from any thread; params
+// is only valid until they return. Their context carries the request's
+// progress token, deadline and cancellation; once the request is
+// cancelled or times out the client has been answered and a later done
+// is ignored. Notification handlers never produce a response.
+//---------------------------------------------------------------------------
+using TMcpMethodHandler = std::function<TMcpMethodResult(const json &params)>;
+using TMcpMethodCompletion = std::function<void(TMcpMethodResult result)>;
+using TMcpAsyncMethodHandler = std::function<void(const json &params,
+    std::shared_ptr<TMcpToolContext> context, TMcpMethodCompletion done)>;
+using TMcpNotificationHandler = std::function<void(const json &params)>;
+
+// Receives the serialized response; empty when there is none
+using TMcpResponseCallback = std::function<void(const std::string &responseJson)>;
+
 //---------------------------------------------------------------------------
 // Event handlers (callbacks)
+// They run on whichever thread handles the request or completes the tool
+// (transport, batch worker, main thread or timer) and may run concurrently
+// with each other, so they must be thread-safe.
 //---------------------------------------------------------------------------
 using TOnToolExecuted = std::function<void(const std::string &toolName, bool success,
     const std::string &errorMessage)>;
 using TOnRequestReceived = std::function<void(const std::string &method,
     const std::string &requestJson)>;
 using TOnResponseSent = std::function<void(const std::string &responseJson)>;
+using TOnNotification = std::function<void(const std::string &notificationJson)>;
+using TOnSessionNotification = std::function<void(const std::string &session,
+    const std::string &notificationJson)>;
+
+//---------------------------------------------------------------------------
+// TMcpHandlerSlot — a callback that can be replaced while others call it
+//
+// A call holds the handler it loaded (std::atomic_load) until it returns,
+// so a replaced handler is freed once the calls still in it are over.
+//---------------------------------------------------------------------------
+template<typename TFunc>
+class TMcpHandlerSlot
+{
+private:
+    // Only through std::atomic_load / std::atomic_store
+    std::shared_ptr<const TFunc> FCurrent;
+
+public:
+    void Set(TFunc handler)
+    {
+        std::shared_ptr<const TFunc> next;
+        if (handler)
+            next = std::make_shared<const TFunc>(std::move(handler));
+        std::atomic_store(&FCurrent, std::move(next));
+    }
+
+    explicit operator bool() const
+    {
+        return std::atomic_load(&FCurrent) != nullptr;
+    }
+
+    template<typename... TArgs>
+    void operator()(TArgs&&... args) const
+    {
+        if (std::shared_ptr<const TFunc> handler = std::atomic_load(&FCurrent))
+            (*handler)(std::forward<TArgs>(args)...);
+    }
+};
+
+// How tools/call returns a tool's content:
+//   Text               - serialized into a single text block (any client)
+//   StructuredWithText - object content also as structuredContent
+//   Structured         - object content only as structuredContent, with an
+//                        empty content array (clients of MCP 2025-06-18+)
+// Errors and non-object content always go out as text.
+enum class TMcpToolOutputFormat
+{
+    Text,
+    StructuredWithText,
+    Structured
+};
+
+// Runs func on the application's main thread, later; must not block
+using TMcpMainThreadDispatcher = std::function<void(std::function<void()> func)>;
 
 //---------------------------------------------------------------------------
 // TMcpServer — Main MCP server class
+//
+// Concurrency: HandleRequest and HandleRequestAsync may be called from any
+// number of threads at once (Indy serves each connection on its own
+// thread). Every request gets its own TMcpToolContext; nothing per-request
+// is shared between calls. Tools, methods, notifications, result caches,
+// execution policies and the SetOn* handlers can be registered or
+// replaced while requests are being served. SetMainThreadDispatcher,
+// SetBatchConcurrency and SetToolsListChanged must be called before serving.
 //---------------------------------------------------------------------------
 class TMcpServer
 {
 private:
+    // Exactly one of the handlers is set
+    struct TMethodEntry
+    {
+        TMcpMethodHandler Handler;
+        TMcpAsyncMethodHandler AsyncHandler;
+        std::shared_ptr<TMcpCallStats> Stats;
+    };
+
+    // JSON-RPC methods and notifications, replaced as a whole on every
+    // registration (like TMcpToolRegistry's snapshots)
+    struct TMethodTable
+    {
+        std::unordered_map<std::string, TMethodEntry> Methods;
+        std::unordered_map<std::string, TMcpNotificationHandler> Notifications;
+    };
+
+    using TResponseSink = std::function<void(std::string responseJson)>;
+    using TClock = std::chrono::steady_clock;
+    // (session, serialized request id): request ids are only unique per client
+    using TInFlightKey = std::pair<std::string, std::string>;
+    using TInFlightMap = std::multimap<TInFlightKey, std::shared_ptr<TMcpCancellationToken>>;
+
+    // Travels with a request: client timeouts count from Received,
+    // notifications about the request go to Notify (when set) instead of
+    // the server-wide SetOnNotification handler, and Session scopes its
+    // id for notifications/cancelled
+    struct TRequestOrigin
+    {
+        TClock::time_point Received;
+        TOnNotification Notify;
+        std::string Session;
+    };
+
+    // An asynchronous request in flight; answered exactly once, by its
+    // handler, by cancellation or by its deadline
+    struct TAsyncCall
+    {
+        json Id;
+        TResponseSink Done;
+        std::shared_ptr<TMcpToolContext> Context;
+        std::atomic<bool> Answered{false};
+        std::mutex Mutex;                      // guards the fields below
+        TInFlightMap::iterator InFlight;
+        TMcpTimerService::TTimerId DeadlineTimer = 0;
+        uint64_t CancelCallback = 0;
+        std::shared_ptr<TMcpCallStats> Stats;
+        TClock::time_point Started;
+    };
+
     TMcpServerInfo FServerInfo;
     TMcpServerCapabilities FCapabilities;
+    std::atomic<TMcpToolOutputFormat> FToolOutputFormat{TMcpToolOutputFormat::Text};
     std::string FProtocolVersion = "2024-11-05";
     std::unique_ptr<TMcpToolRegistry> FToolRegistry;
-    TMcpToolContext FContext;
-
-    TOnToolExecuted FOnToolExecuted;
-    TOnRequestReceived FOnRequestReceived;
-    TOnResponseSent FOnResponseSent;
-
-    mutable std::mutex FMutex;
+    std::unique_ptr<TMcpResourceRegistry> FResources;
+    std::chrono::milliseconds FResourceUpdateInterval{50};
+    std::shared_ptr<const TMethodTable> FMethodTable;   // see Methods
+    std::unique_ptr<TMcpWorkerPool> FBatchPool;
+    std::unique_ptr<TMcpTimerService> FTimerService;
+    std::once_flag FTimerServiceOnce;
+    TInFlightMap FInFlight;                    // keyed by session and request id
+    std::mutex FInFlightMutex;
+    std::atomic<uint64_t> FStateGeneration{0};  // see BumpStateGeneration
+    TMcpMainThreadDispatcher FMainThreadDispatcher;
+    std::unique_ptr<TMcpConcurrencyLimiter> FMainThreadLimiter;
+
+    TMcpHandlerSlot<TOnToolExecuted> FOnToolExecuted;
+    TMcpHandlerSlot<TOnRequestReceived> FOnRequestReceived;
+    TMcpHandlerSlot<TOnResponseSent> FOnResponseSent;
+    TMcpHandlerSlot<TOnNotification> FOnNotification;
+    TMcpHandlerSlot<TOnSessionNotification> FOnSessionNotification;
+
+    mutable std::mutex FMutex;                 // serializes method table updates
 
 public:
     explicit TMcpServer(const std::string &name = "McpServer",
         const std::string &version = "1.0.0")
         : FServerInfo(name, version)
         , FToolRegistry(std::make_unique<TMcpToolRegistry>())
-    {}
+        , FResources(std::make_unique<TMcpResourceRegistry>())
+    {
+        RegisterMethod("initialize",
+            [this](const json &params) { return HandleInitialize(params); });
+        RegisterMethod("tools/list",
+            [this](const json &params) { return HandleToolsList(params); });
+        RegisterAsyncMethod("tools/call",
+            [this](const json &params, std::shared_ptr<TMcpToolContext> context,
+                TMcpMethodCompletion done) {
+                HandleToolsCall(params, std::move(context), std::move(done));
+            });
+        RegisterMethod("ping",
+            [this](const json &params) { return HandlePing(params); });
+        RegisterMethod("resources/list",
+            [this](const json &params) { return TMcpMethodResult::Success(FResources->ListJson()); });
+        RegisterMethod("resources/templates/list",
+            [this](const json &params) {
+                return TMcpMethodResult::Success(FResources->ListTemplatesJson());
+            });
+        RegisterMethod("resources/read",
+            [this](const json &params) { return HandleResourcesRead(params); });
+        RegisterAsyncMethod("resources/subscribe",
+            [this](const json &params, std::shared_ptr<TMcpToolContext> context,
+                TMcpMethodCompletion done) {
+                done(HandleResourcesSubscribe(params, context->GetSession(), true));
+            });
+        RegisterAsyncMethod("resources/unsubscribe",
+            [this](const json &params, std::shared_ptr<TMcpToolContext> context,
+                TMcpMethodCompletion done) {
+                done(HandleResourcesSubscribe(params, context->GetSession(), false));
+            });
+        RegisterNotification("notifications/initialized", [](const json &) {});
+        // Answered in HandleEnvelope, which knows the sender's session;
+        // registered so the pre-scan keeps its params
+        RegisterNotification("notifications/cancelled", [](const json &) {});
+
+        FToolRegistry->RegisterLambda("server_get_metrics",
+            "Get MCP server metrics: call and error counts per tool and per method, "
+            "latency percentiles (p50/p95/p99) and time tools spent waiting for the main thread",
+            TMcpToolSchema(),
+            [this](const json &args, TMcpToolContext &ctx) -> TMcpToolResult {
+                return TMcpToolResult::Success(GetMetricsJson());
+            });
+
+#if MCP_TRACE_ENABLED
+        FToolRegistry->RegisterLambda("server_get_trace",
+            "Get recent tracing spans (HTTP, parse, dispatch, tool execution, main-thread "
+            "hops) as Chrome trace JSON for chrome://tracing or ui.perfetto.dev",
+            TMcpToolSchema()
+                .AddBoolean("clear", "Discard the recorded spans afterwards"),
+            // Returned, never written to a file: a client must not choose
+            // paths on this machine (the application can call WriteChromeTrace)
+            [](const json &args, TMcpToolContext &ctx) -> TMcpToolResult {
+                TMcpTracer &tracer = TMcpTracer::Instance();
+                TMcpToolResult result = TMcpToolResult::Success(tracer.ToChromeJson());
+                if (args.value("clear", false))
+                    tracer.Clear();
+                return result;
+            });
+#endif
+
+        FToolRegistry->SetOnListChanged([this]() { OnToolsListChanged(); });
+    }
 
     TMcpServer(const TMcpServer&) = delete;
     TMcpServer& operator=(const TMcpServer&) = delete;
@@ -452,55 +1210,313 @@ public:
     TMcpServer(TMcpServer&&) = default;
     TMcpServer& operator=(TMcpServer&&) = default;
 
+    void Register(std::unique_ptr<IMcpTool> tool)
+    {
+        FToolRegistry->Register(std::move(tool));
+    }
+
     void RegisterLambda(const std::string &name, const std::string &description,
         const TMcpToolSchema &schema, TMcpLambdaTool::ExecuteFunc func)
     {
         FToolRegistry->RegisterLambda(name, description, schema, std::move(func));
     }
 
-    void SetOnToolExecuted(TOnToolExecuted handler) { FOnToolExecuted = std::move(handler); }
-    void SetOnRequestReceived(TOnRequestReceived handler) { FOnRequestReceived = std::move(handler); }
-    void SetOnResponseSent(TOnResponseSent handler) { FOnResponseSent = std::move(handler); }
+    void RegisterLambda(const std::string &name, const std::string &description,
+        const TMcpToolSchema &schema, const TMcpToolAnnotations &annotations,
+        TMcpLambdaTool::ExecuteFunc func)
+    {
+        FToolRegistry->RegisterLambda(name, description, schema, annotations, std::move(func));
+    }
 
-    std::string HandleRequest(const std::string &requestJson)
+    void RegisterAsyncLambda(const std::string &name, const std::string &description,
+        const TMcpToolSchema &schema, TMcpAsyncLambdaTool::ExecuteAsyncFunc func)
     {
-        try
-        {
-            json root = json::parse(requestJson);
-            if (root.is_array())
-                return EmitResponse(HandleBatchRequestInternal(root));
-            return EmitResponse(HandleRequestInternal(root, requestJson));
-        }
-        catch (const json::parse_error &e)
-        {
-            if (FOnRequestReceived)
-                FOnRequestReceived("parse_error", requestJson);
-            return EmitResponse(MakeError("null", ErrorCode::ParseError,
-                std::string("Parse error: ") + e.what()));
-        }
+        FToolRegistry->RegisterAsyncLambda(name, description, schema, std::move(func));
     }
 
-    std::string HandleBatchRequest(const std::string &requestJson)
+    void RegisterAsyncLambda(const std::string &name, const std::string &description,
+        const TMcpToolSchema &schema, const TMcpToolAnnotations &annotations,
+        TMcpAsyncLambdaTool::ExecuteAsyncFunc func)
     {
-        try
+        FToolRegistry->RegisterAsyncLambda(name, description, schema, annotations,
+            std::move(func));
+    }
+
+    // See TMcpToolRegistry::EnableResultCache
+    bool EnableResultCache(const std::string &toolName, std::chrono::milliseconds ttl)
+    {
+        return FToolRegistry->EnableResultCache(toolName, ttl);
+    }
+
+    // See TMcpToolRegistry::SetExecutionPolicy
+    bool SetExecutionPolicy(const std::string &toolName, const TMcpExecutionPolicy &policy)
+    {
+        return FToolRegistry->SetExecutionPolicy(toolName, policy);
+    }
+
+    // Expose a resource through resources/list and resources/read. The
+    // reader also serves the URI with a query appended (uri?offset=10).
+    void AddResource(const TMcpResource &resource, TMcpResourceReader reader)
+    {
+        FResources->Add(resource, std::move(reader));
+    }
+
+    // Expose a family of resources: URIs starting with uriPrefix are read
+    // by reader, and the template is listed by resources/templates/list
+    void AddResourceTemplate(const TMcpResourceTemplate &resourceTemplate,
+        const std::string &uriPrefix, TMcpResourceReader reader)
+    {
+        FResources->AddTemplate(resourceTemplate, uriPrefix, std::move(reader));
+    }
+
+    // The application changed a resource. The sessions subscribed to it
+    // get notifications/resources/updated (see SetOnSessionNotification),
+    // at most one per URI per update interval however many changes it
+    // covers. A query in uri is ignored. Any thread; cheap when nobody is
+    // subscribed.
+    void NotifyResourceUpdated(const std::string &changedUri)
+    {
+        std::string uri = TMcpResourceRegistry::BaseUri(changedUri);
+        if (!FResources->MarkUpdated(uri))
+            return;
+        if (FResourceUpdateInterval.count() <= 0)
         {
-            json val = json::parse(requestJson);
+            SendResourceUpdated(uri);
+            return;
+        }
+        GetTimerService().Schedule(FResourceUpdateInterval,
+            [this, uri]() { SendResourceUpdated(uri); });
+    }
+
+    // Coalescing window for NotifyResourceUpdated (default 50 ms, 0 sends
+    // every change). Call before serving.
+    void SetResourceUpdateInterval(std::chrono::milliseconds interval)
+    {
+        FResourceUpdateInterval = interval;
+    }
 
-            if (!val.is_array())
-                return HandleRequest(requestJson);
+    // Where MainThread tools run. At most maxPending of them are handed to
+    // the dispatcher at a time, so a flood of calls cannot monopolize the
+    // main thread. Without a dispatcher they run like AnyThread tools.
+    // Call before serving.
+    void SetMainThreadDispatcher(TMcpMainThreadDispatcher dispatcher, unsigned maxPending = 1)
+    {
+        FMainThreadDispatcher = std::move(dispatcher);
+        FMainThreadLimiter = FMainThreadDispatcher
+            ? std::make_unique<TMcpConcurrencyLimiter>(maxPending) : nullptr;
+    }
+
+    // Invalidate every cached tool result. The application calls this when
+    // its state changes; calls to tools that are not read-only do it
+    // automatically when they complete.
+    void BumpStateGeneration()
+    {
+        FStateGeneration.fetch_add(1, std::memory_order_acq_rel);
+    }
+
+    // Shared timer thread for asynchronous tools, started on first use
+    TMcpTimerService& GetTimerService()
+    {
+        std::call_once(FTimerServiceOnce,
+            [this]() { FTimerService = std::make_unique<TMcpTimerService>(); });
+        return *FTimerService;
+    }
+
+    // Run concurrency-safe batch elements on a pool of workerCount threads.
+    // 0 (the default) handles batches sequentially. Call before serving.
+    void SetBatchConcurrency(unsigned workerCount)
+    {
+        if (workerCount == 0)
+            FBatchPool.reset();
+        else
+            FBatchPool = std::make_unique<TMcpWorkerPool>(workerCount);
+    }
+
+    // Register (or replace) a JSON-RPC method, e.g. resources/list or a
+    // custom admin call. Safe while serving: requests already dispatched
+    // finish with the handler they found.
+    void RegisterMethod(const std::string &method, TMcpMethodHandler handler)
+    {
+        UpdateMethodTable([&](TMethodTable &table) {
+            TMethodEntry &entry = table.Methods[method];
+            entry.Handler = std::move(handler);
+            entry.AsyncHandler = nullptr;
+            if (!entry.Stats)
+                entry.Stats = std::make_shared<TMcpCallStats>();
+        });
+    }
+
+    // Same, for a handler that completes later through done
+    void RegisterAsyncMethod(const std::string &method, TMcpAsyncMethodHandler handler)
+    {
+        UpdateMethodTable([&](TMethodTable &table) {
+            TMethodEntry &entry = table.Methods[method];
+            entry.Handler = nullptr;
+            entry.AsyncHandler = std::move(handler);
+            if (!entry.Stats)
+                entry.Stats = std::make_shared<TMcpCallStats>();
+        });
+    }
+
+    // Register (or replace) a handler for a notification such as
+    // notifications/cancelled. Notifications never get a response.
+    void RegisterNotification(const std::string &method, TMcpNotificationHandler handler)
+    {
+        UpdateMethodTable([&](TMethodTable &table) {
+            table.Notifications[method] = std::move(handler);
+        });
+    }
+
+    // Counters and latency histograms (microseconds) per tool and method
+    json GetMetricsJson() const
+    {
+        json methods = json::object();
+        for (const auto &pair : Methods()->Methods)
+            methods[pair.first] = pair.second.Stats->ToJson();
+
+        json metrics;
+        metrics["tools"] = FToolRegistry->GetStatsJson();
+        metrics["methods"] = std::move(methods);
+        return metrics;
+    }
+
+    // The handlers can be replaced while serving, see TMcpHandlerSlot
+    void SetOnToolExecuted(TOnToolExecuted handler) { FOnToolExecuted.Set(std::move(handler)); }
+    void SetOnRequestReceived(TOnRequestReceived handler) { FOnRequestReceived.Set(std::move(handler)); }
+    void SetOnResponseSent(TOnResponseSent handler) { FOnResponseSent.Set(std::move(handler)); }
+
+    // Server-initiated notifications (e.g. notifications/tools/list_changed)
+    // are handed to this sink; the transport decides how to deliver them.
+    void SetOnNotification(TOnNotification handler) { FOnNotification.Set(std::move(handler)); }
+
+    // Notifications meant for one client session (resource updates) are
+    // handed to this sink; without it they go to SetOnNotification's.
+    void SetOnSessionNotification(TOnSessionNotification handler)
+    {
+        FOnSessionNotification.Set(std::move(handler));
+    }
+
+    // The transport reports a client session that has ended (HTTP DELETE,
+    // a closed connection); its resource subscriptions are dropped
+    void EndSession(const std::string &session) { FResources->EndSession(session); }
+
+    // Cached tool results keep the format they had
+    void SetToolOutputFormat(TMcpToolOutputFormat format) { FToolOutputFormat = format; }
+
+    // Advertise tools.listChanged and emit notifications/tools/list_changed
+    // whenever a tool is registered
+    void SetToolsListChanged(bool enabled) { FCapabilities.ToolsListChanged = enabled; }
+
+    void SendNotification(const std::string &method, const json &params = json())
+    {
+        if (!FOnNotification)
+            return;
+        FOnNotification(MakeNotification(method, params));
+    }
+
+    // Blocks until the response is ready; asynchronous tools complete on
+    // other threads meanwhile
+    std::string HandleRequest(const std::string &requestJson)
+    {
+        return HandleRequest(requestJson, nullptr);
+    }
+
+    // As above; notifications about this request (notifications/progress)
+    // go to onNotification, e.g. to stream them in the HTTP response. It
+    // may still be called after the response, by a tool that outlived its
+    // deadline, and must cope with that.
+    //
+    // session identifies the client (e.g. its Mcp-Session-Id); a
+    // notifications/cancelled only reaches requests of the same session.
+    std::string HandleRequest(const std::string &requestJson, TOnNotification onNotification,
+        const std::string &session = std::string())
+    {
+        TMcpArenaScope arena;
+        auto promise = McpMakeShared<std::promise<std::string>>(
+            std::allocator_arg, TMcpArenaAllocator<std::string>());
+        std::future<std::string> future = promise->get_future();
+        HandleRequestAsync(requestJson,
+            [promise](const std::string &response) { promise->set_value(response); },
+            std::move(onNotification), session);
+        return future.get();
+    }
+
+    // onResponse is called exactly once, possibly on another thread and
+    // possibly before this returns. An empty response means none is due.
+    // onNotification and session, when set, are used as in HandleRequest.
+    void HandleRequestAsync(const std::string &requestJson, TMcpResponseCallback onResponse,
+        TOnNotification onNotification = nullptr, const std::string &session = std::string())
+    {
+        MCP_TRACE_SCOPE("mcp.handle_request");
+
+        // The call bookkeeping for this request comes from one arena
+        TMcpArenaScope arena;
+
+        // Client timeouts (params._meta.timeoutMs) count from here
+        TRequestOrigin origin{TClock::now(), std::move(onNotification), session};
+        TResponseSink done = [this, onResponse = std::move(onResponse)](std::string response) {
+            onResponse(EmitResponse(response));
+        };
+
+        // Single requests are pre-scanned; only batches build a full DOM
+        if (IsObjectText(requestJson))
+        {
+            HandleScannedRequest(requestJson, origin, std::move(done));
+            return;
+        }
 
-            return EmitResponse(HandleBatchRequestInternal(val));
+        std::shared_ptr<const json> root;
+        try
+        {
+            MCP_TRACE_SCOPE("mcp.parse");
+            root = std::make_shared<const json>(json::parse(requestJson));
         }
         catch (const json::parse_error &e)
         {
             if (FOnRequestReceived)
                 FOnRequestReceived("parse_error", requestJson);
-            return EmitResponse(MakeError("null", ErrorCode::ParseError,
+            done(MakeError(nullptr, ErrorCode::ParseError,
                 std::string("Parse error: ") + e.what()));
+            return;
         }
+
+        if (root->is_array())
+            HandleBatchRequestInternal(std::move(root), origin, std::move(done));
+        else
+            HandleRequestInternal(*root, &requestJson, origin, std::move(done));
+    }
+
+    std::string HandleBatchRequest(const std::string &requestJson)
+    {
+        return HandleRequest(requestJson);
     }
 
 private:
+    // A request holds the table it loaded while it dispatches; a replaced
+    // table is freed once no request uses it
+    std::shared_ptr<const TMethodTable> Methods() const
+    {
+        return std::atomic_load(&FMethodTable);
+    }
+
+    template<typename TUpdate>
+    void UpdateMethodTable(TUpdate update)
+    {
+        std::lock_guard<std::mutex> lock(FMutex);
+        const TMethodTable *current = FMethodTable.get();
+        auto next = current ? std::make_shared<TMethodTable>(*current)
+                            : std::make_shared<TMethodTable>();
+        update(*next);
+        std::atomic_store(&FMethodTable, std::shared_ptr<const TMethodTable>(std::move(next)));
+    }
+
+    //-----------------------------------------------------------------------
+    // Internal dispatch works on json values: the request is parsed once
+    // and ids and results are never re-encoded. Each response is written
+    // once by MakeResponse/MakeError, which can also splice pre-serialized
+    // results; batch responses are joined without re-parsing. An empty
+    // string means "no response" (notification or empty batch).
+    //-----------------------------------------------------------------------
     std::string EmitResponse(const std::string &responseJson)
     {
         if (!responseJson.empty() && FOnResponseSent)
@@ -508,179 +1524,896 @@ private:
         return responseJson;
     }
 
-    std::string HandleBatchRequestInternal(const json &batch)
+    void OnToolsListChanged()
     {
-        if (!batch.is_array())
-            return MakeError("null", ErrorCode::InvalidRequest, "Invalid JSON-RPC batch");
+        if (FCapabilities.ToolsListChanged)
+            SendNotification("notifications/tools/list_changed");
+    }
+
+    // Raw request text is only produced when someone listens for it
+    void NotifyRequestReceived(const std::string &method, const json *reqJson,
+        const std::string *rawJson)
+    {
+        if (!FOnRequestReceived)
+            return;
+        if (rawJson)
+            FOnRequestReceived(method, *rawJson);
+        else
+            FOnRequestReceived(method, reqJson ? reqJson->dump() : std::string());
+    }
 
-        json responses = json::array();
-        for (const auto &req : batch)
+    static bool IsObjectText(const std::string &text)
+    {
+        for (char c : text)
         {
-            std::string resp = HandleRequestInternal(req, req.dump());
-            if (!resp.empty())
-                responses.push_back(json::parse(resp));
+            if (c != ' ' && c != '\t' && c != '\r' && c != '\n')
+                return c == '{';
+        }
+        return false;
+    }
+
+    // SAX pre-scan: params is the only DOM built, and requests that end
+    // in an early error stop building it (the body is still checked to
+    // the end)
+    void HandleScannedRequest(const std::string &requestJson, const TRequestOrigin &origin,
+        TResponseSink done)
+    {
+        std::shared_ptr<const TMethodTable> table = Methods();
+        TMcpEnvelopeScanner scanner(
+            [&table](const std::string &method) {
+                return table->Methods.count(method) != 0 || table->Notifications.count(method) != 0;
+            },
+            [this](const std::string &name) { return FToolRegistry->Get(name) != nullptr; });
+
+        bool scanned;
+        {
+            MCP_TRACE_SCOPE("mcp.parse");
+            scanned = scanner.Scan(requestJson);
+        }
+        if (!scanned)
+        {
+            if (FOnRequestReceived)
+                FOnRequestReceived("parse_error", requestJson);
+            done(MakeError(nullptr, ErrorCode::ParseError,
+                "Parse error: " + scanner.GetErrorMessage()));
+            return;
+        }
+        HandleEnvelope(scanner.GetEnvelope(), nullptr, &requestJson, origin, std::move(done));
+    }
+
+    // Batch elements complete independently; the joined response is sent
+    // when the last one finishes
+    struct TBatchState
+    {
+        std::shared_ptr<const json> Batch;
+        TRequestOrigin Origin;
+        std::vector<std::string> Results;
+        std::vector<bool> Parallel;
+        std::atomic<size_t> Remaining;
+        TResponseSink Done;
+    };
+
+    void HandleBatchRequestInternal(std::shared_ptr<const json> batch,
+        const TRequestOrigin &origin, TResponseSink done)
+    {
+        if (!batch->is_array())
+        {
+            done(MakeError(nullptr, ErrorCode::InvalidRequest, "Invalid JSON-RPC batch"));
+            return;
+        }
+        if (batch->empty())
+        {
+            done("");
+            return;
+        }
+
+        auto state = McpMakeShared<TBatchState>();
+        size_t count = batch->size();
+        state->Batch = std::move(batch);
+        state->Origin = origin;
+        state->Results.resize(count);
+        state->Parallel.resize(count);
+        state->Remaining.store(count);
+        state->Done = std::move(done);
+
+        // Concurrency-safe elements go to the worker pool; the rest run
+        // one at a time and in batch order
+        if (FBatchPool && count > 1)
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                if (!IsConcurrencySafe((*state->Batch)[i]))
+                    continue;
+                state->Parallel[i] = true;
+                FBatchPool->Submit([this, state, i]() {
+                    TMcpArenaScope arena;
+                    HandleBatchElement((*state->Batch)[i], state->Origin,
+                        [this, state, i](std::string response) {
+                        CompleteBatchElement(*state, i, std::move(response));
+                    });
+                });
+            }
+        }
+
+        RunSequentialBatch(state, 0);
+    }
+
+    // Runs the non-parallel elements from index on. An element that
+    // completes later resumes the loop from its completion callback.
+    void RunSequentialBatch(const std::shared_ptr<TBatchState> &state, size_t index)
+    {
+        for (; index < state->Results.size(); index++)
+        {
+            if (state->Parallel[index])
+                continue;
+
+            // 0: pending, 1: completed, 2: this loop has moved on
+            auto handoff = McpMakeShared<std::atomic<int>>(0);
+            HandleBatchElement((*state->Batch)[index], state->Origin,
+                [this, state, index, handoff](std::string response) {
+                    CompleteBatchElement(*state, index, std::move(response));
+                    if (handoff->exchange(1) == 2)
+                        RunSequentialBatch(state, index + 1);
+                });
+            if (handoff->exchange(2) == 0)
+                return;
+        }
+    }
+
+    static void CompleteBatchElement(TBatchState &state, size_t index, std::string response)
+    {
+        state.Results[index] = std::move(response);
+        if (state.Remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            state.Done(JoinBatchResponses(state.Results));
+    }
+
+    static std::string JoinBatchResponses(const std::vector<std::string> &results)
+    {
+        size_t totalSize = 2;
+        for (const auto &resp : results)
+            totalSize += resp.size() + 1;
+
+        std::string responses;
+        responses.reserve(totalSize);
+        for (const auto &resp : results)
+        {
+            if (resp.empty())
+                continue;
+            responses += responses.empty() ? '[' : ',';
+            responses += resp;
         }
 
         if (responses.empty())
             return "";
-        return responses.dump();
+        responses += ']';
+        return responses;
     }
 
-    std::string HandleRequestInternal(const json &reqJson, const std::string &rawJson)
+    void HandleBatchElement(const json &req, const TRequestOrigin &origin, TResponseSink done)
+    {
+        try
+        {
+            HandleRequestInternal(req, nullptr, origin, done);
+        }
+        catch (const std::exception &e)
+        {
+            done(MakeError(nullptr, ErrorCode::InternalError,
+                std::string("Internal error: ") + e.what()));
+        }
+    }
+
+    // A batch element may run concurrently when it cannot change state:
+    // protocol queries, rejected requests, and tools/call of a tool that
+    // declares both ReadOnlyHint and IdempotentHint.
+    bool IsConcurrencySafe(const json &req) const
+    {
+        if (!req.is_object())
+            return true;
+
+        auto methodIt = req.find("method");
+        if (methodIt == req.end() || !methodIt->is_string())
+            return true;
+
+        const std::string &method = methodIt->get_ref<const std::string&>();
+        if (method == "ping" || method == "tools/list" || method == "initialize")
+            return true;
+        if (method != "tools/call")
+            return false;
+
+        auto paramsIt = req.find("params");
+        if (paramsIt == req.end() || !paramsIt->is_object())
+            return true;
+
+        auto nameIt = paramsIt->find("name");
+        if (nameIt == paramsIt->end() || !nameIt->is_string())
+            return true;
+
+        TMcpRegisteredTool registered = FToolRegistry->Find(nameIt->get_ref<const std::string&>());
+        if (!registered.Tool)
+            return true;
+
+        const TMcpToolAnnotations &ann = *registered.Annotations;
+        return ann.ReadOnlyHint && ann.IdempotentHint;
+    }
+
+    void HandleRequestInternal(const json &reqJson, const std::string *rawJson,
+        const TRequestOrigin &origin, TResponseSink done)
     {
         if (!reqJson.is_object())
         {
-            if (FOnRequestReceived)
-                FOnRequestReceived("invalid_request", rawJson);
-            return MakeError("null", ErrorCode::InvalidRequest, "Invalid JSON-RPC request");
+            NotifyRequestReceived("invalid_request", &reqJson, rawJson);
+            done(MakeError(nullptr, ErrorCode::InvalidRequest, "Invalid JSON-RPC request"));
+            return;
         }
 
-        std::string id;
-        bool isNotification = true;
-        if (reqJson.contains("id"))
+        TMcpEnvelope envelope;
+        auto idIt = reqJson.find("id");
+        if (idIt != reqJson.end())
         {
-            id = reqJson["id"].dump();
-            if (!reqJson["id"].is_null())
-                isNotification = false;
+            envelope.HasId = true;
+            envelope.Id = *idIt;
         }
 
-        if (reqJson.contains("jsonrpc"))
+        auto versionIt = reqJson.find("jsonrpc");
+        if (versionIt != reqJson.end())
         {
-            if (!reqJson["jsonrpc"].is_string() ||
-                reqJson["jsonrpc"].get<std::string>() != "2.0")
+            envelope.HasVersion = true;
+            envelope.VersionOk = versionIt->is_string() &&
+                versionIt->get_ref<const std::string&>() == "2.0";
+        }
+
+        auto methodIt = reqJson.find("method");
+        if (methodIt != reqJson.end() && methodIt->is_string())
+        {
+            envelope.HasMethod = true;
+            envelope.Method = methodIt->get_ref<const std::string&>();
+        }
+
+        auto paramsIt = reqJson.find("params");
+        if (paramsIt != reqJson.end())
+            envelope.Params = &*paramsIt;
+
+        HandleEnvelope(envelope, &reqJson, rawJson, origin, std::move(done));
+    }
+
+    void HandleEnvelope(const TMcpEnvelope &envelope, const json *reqJson,
+        const std::string *rawJson, const TRequestOrigin &origin, TResponseSink done)
+    {
+        const json &id = envelope.Id;
+        MCP_TRACE_REQUEST(id);
+        MCP_TRACE_SCOPE("mcp.dispatch");
+
+        if (envelope.HasVersion && !envelope.VersionOk)
+        {
+            NotifyRequestReceived("invalid_request", reqJson, rawJson);
+            done(MakeError(id, ErrorCode::InvalidRequest, "Invalid 'jsonrpc' version"));
+            return;
+        }
+
+        if (!envelope.HasMethod)
+        {
+            NotifyRequestReceived("invalid_request", reqJson, rawJson);
+            done(MakeError(id, ErrorCode::InvalidRequest, "Missing 'method'"));
+            return;
+        }
+
+        const std::string &method = envelope.Method;
+        NotifyRequestReceived(method, reqJson, rawJson);
+
+        static const json noParams;
+        const json &params = envelope.Params ? *envelope.Params : noParams;
+
+        if (envelope.IsNotification())
+        {
+            if (method == "notifications/cancelled")
+                HandleCancelled(params, origin.Session);
+            else
+                DispatchNotification(method, params);
+            done("");
+            return;
+        }
+
+        std::shared_ptr<const TMethodTable> table = Methods();
+        auto handlerIt = table->Methods.find(method);
+        if (handlerIt == table->Methods.end())
+        {
+            done(MakeError(id, ErrorCode::MethodNotFound, "Unknown method: " + method));
+            return;
+        }
+
+        // Requests that waited past their deadline (e.g. behind other
+        // batch elements) are not started
+        TClock::time_point deadline = GetDeadline(params, origin.Received);
+        if (deadline <= TClock::now())
+        {
+            done(MakeError(id, ErrorCode::RequestTimeout, "Request deadline exceeded"));
+            return;
+        }
+
+        const TMethodEntry &entry = handlerIt->second;
+        if (entry.AsyncHandler)
+        {
+            InvokeAsyncRequest(entry, id, params, deadline, origin, std::move(done));
+            return;
+        }
+
+        TClock::time_point started = TClock::now();
+        InvokeMethod(entry, params, nullptr,
+            [id, started, stats = entry.Stats, done = std::move(done)](TMcpMethodResult result) {
+                stats->Record(!result.IsError, TClock::now() - started);
+                done(MakeMethodResponse(id, result));
+            });
+    }
+
+    // Asynchronous requests are registered for notifications/cancelled
+    // and, with a deadline, answered with RequestTimeout when it passes.
+    // Either way the handler's context is cancelled so it can stop.
+    void InvokeAsyncRequest(const TMethodEntry &entry, const json &id,
+        const json &params, TClock::time_point deadline, const TRequestOrigin &origin,
+        TResponseSink done)
+    {
+        auto call = McpMakeShared<TAsyncCall>();
+        call->Id = id;
+        call->Done = std::move(done);
+        call->Stats = entry.Stats;
+        call->Started = TClock::now();
+        call->Context = CreateRequestContext(params, origin.Notify);
+        call->Context->SetDeadline(deadline);
+        call->Context->SetRequestId(id);
+        call->Context->SetSession(origin.Session);
+
+        {
+            std::lock_guard<std::mutex> lock(call->Mutex);
+            call->CancelCallback = call->Context->GetCancellation().OnCancel([this, call]() {
+                FinishAsyncCall(*call, MakeError(call->Id, ErrorCode::RequestCancelled,
+                    "Request cancelled"), false);
+            });
+
+            if (call->Context->HasDeadline())
             {
-                if (FOnRequestReceived)
-                    FOnRequestReceived("invalid_request", rawJson);
-                return MakeError(id, ErrorCode::InvalidRequest,
-                    "Invalid 'jsonrpc' version");
+                auto delay = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    deadline - TClock::now()) + std::chrono::milliseconds(1);
+                call->DeadlineTimer = GetTimerService().Schedule(delay, [this, call]() {
+                    FinishAsyncCall(*call, MakeError(call->Id, ErrorCode::RequestTimeout,
+                        "Request deadline exceeded"), false);
+                    call->Context->GetCancellation().Cancel("deadline exceeded");
+                });
             }
+
+            std::lock_guard<std::mutex> inFlightLock(FInFlightMutex);
+            call->InFlight = FInFlight.emplace(TInFlightKey(origin.Session, id.dump()),
+                call->Context->GetCancellationToken());
         }
 
-        if (!reqJson.contains("method") || !reqJson["method"].is_string())
+        TMcpMethodCompletion complete = [this, call](TMcpMethodResult result) {
+            if (!call->Answered.load(std::memory_order_acquire))
+                FinishAsyncCall(*call, MakeMethodResponse(call->Id, result), !result.IsError);
+        };
+
+        InvokeMethod(entry, params, call->Context, std::move(complete));
+    }
+
+    void FinishAsyncCall(TAsyncCall &call, std::string response, bool success)
+    {
+        if (call.Answered.exchange(true, std::memory_order_acq_rel))
+            return;
+
+        call.Stats->Record(success, TClock::now() - call.Started);
+
         {
-            if (FOnRequestReceived)
-                FOnRequestReceived("invalid_request", rawJson);
-            return MakeError(id, ErrorCode::InvalidRequest, "Missing 'method'");
-        }
-
-        std::string method = reqJson["method"].get<std::string>();
-        if (FOnRequestReceived)
-            FOnRequestReceived(method, rawJson);
-
-        std::string response;
-        if (method == "initialize")
-            response = HandleInitialize(reqJson, id);
-        else if (method == "tools/list")
-            response = HandleToolsList(reqJson, id);
-        else if (method == "tools/call")
-            response = HandleToolsCall(reqJson, id);
-        else if (method == "ping")
-            response = HandlePing(id);
-        else
-            response = MakeError(id, ErrorCode::MethodNotFound, "Unknown method: " + method);
+            std::lock_guard<std::mutex> lock(call.Mutex);
+            {
+                std::lock_guard<std::mutex> inFlightLock(FInFlightMutex);
+                FInFlight.erase(call.InFlight);
+            }
+            if (call.DeadlineTimer != 0)
+                GetTimerService().Cancel(call.DeadlineTimer);
+            call.Context->GetCancellation().RemoveOnCancel(call.CancelCallback);
+        }
+        call.Done(std::move(response));
+    }
 
-        if (isNotification)
-            return "";
-        return response;
+    std::shared_ptr<TMcpToolContext> CreateRequestContext(const json &params,
+        const TOnNotification &notify = nullptr)
+    {
+        if (notify)
+        {
+            return McpMakeShared<TMcpToolContext>(GetProgressToken(params),
+                [notify](const std::string &method, const json &notifyParams) {
+                    notify(MakeNotification(method, notifyParams));
+                });
+        }
+        return McpMakeShared<TMcpToolContext>(GetProgressToken(params),
+            [this](const std::string &method, const json &notifyParams) {
+                SendNotification(method, notifyParams);
+            });
+    }
+
+    // notifications/cancelled: {"requestId": ..., "reason": "..."}; only
+    // the sender's own requests are cancelled
+    void HandleCancelled(const json &params, const std::string &session)
+    {
+        if (!params.is_object())
+            return;
+        auto idIt = params.find("requestId");
+        if (idIt == params.end() || idIt->is_null())
+            return;
+
+        std::string reason;
+        auto reasonIt = params.find("reason");
+        if (reasonIt != params.end() && reasonIt->is_string())
+            reason = reasonIt->get<std::string>();
+
+        std::vector<std::shared_ptr<TMcpCancellationToken>> tokens;
+        {
+            std::lock_guard<std::mutex> lock(FInFlightMutex);
+            auto range = FInFlight.equal_range(TInFlightKey(session, idIt->dump()));
+            for (auto it = range.first; it != range.second; ++it)
+                tokens.push_back(it->second);
+        }
+        for (auto &token : tokens)
+            token->Cancel(reason);
+    }
+
+    static std::string MakeMethodResponse(const json &id, const TMcpMethodResult &result)
+    {
+        if (result.IsError)
+            return MakeError(id, result.ErrorCode, result.ErrorMessage);
+        if (result.RawResult)
+            return MakeRawResponse(id, *result.RawResult);
+        return MakeResponse(id, result.Result);
+    }
+
+    // Notifications run their handler (or a method handler, whose result is
+    // discarded) without building a response. Unknown ones are ignored.
+    void DispatchNotification(const std::string &method, const json &params)
+    {
+        std::shared_ptr<const TMethodTable> table = Methods();
+        auto notifyIt = table->Notifications.find(method);
+        if (notifyIt != table->Notifications.end())
+        {
+            try { notifyIt->second(params); }
+            catch (const std::exception &) {}
+            return;
+        }
+
+        auto handlerIt = table->Methods.find(method);
+        if (handlerIt != table->Methods.end())
+            InvokeMethod(handlerIt->second, params, CreateRequestContext(params),
+                [](TMcpMethodResult) {});
+    }
+
+    // A synchronous handler's result is delivered after the handler has
+    // returned, so done never runs inside its try block
+    static void InvokeMethod(const TMethodEntry &entry, const json &params,
+        std::shared_ptr<TMcpToolContext> context, TMcpMethodCompletion done)
+    {
+        if (entry.AsyncHandler)
+        {
+            try
+            {
+                entry.AsyncHandler(params, std::move(context), done);
+            }
+            catch (const std::exception &e)
+            {
+                done(TMcpMethodResult::Error(ErrorCode::InternalError,
+                    std::string("Internal error: ") + e.what()));
+            }
+            return;
+        }
+
+        TMcpMethodResult result;
+        try
+        {
+            result = entry.Handler(params);
+        }
+        catch (const std::exception &e)
+        {
+            result = TMcpMethodResult::Error(ErrorCode::InternalError,
+                std::string("Internal error: ") + e.what());
+        }
+        done(std::move(result));
     }
 
-    std::string HandleInitialize(const json &reqJson, const std::string &id)
+    TMcpMethodResult HandleInitialize(const json &params)
     {
         json result;
         result["protocolVersion"] = FProtocolVersion;
         result["capabilities"] = FCapabilities.ToJson();
+        if (!FResources->IsEmpty())
+            result["capabilities"]["resources"] = json{{"subscribe", true}, {"listChanged", false}};
         result["serverInfo"] = FServerInfo.ToJson();
-        return MakeResponse(id, result);
+        return TMcpMethodResult::Success(std::move(result));
     }
 
-    std::string HandleToolsList(const json &reqJson, const std::string &id)
+    static const std::string* GetUriParam(const json &params)
     {
-        return MakeResponse(id, FToolRegistry->GenerateToolsListJson());
+        if (!params.is_object())
+            return nullptr;
+        auto uriIt = params.find("uri");
+        if (uriIt == params.end() || !uriIt->is_string())
+            return nullptr;
+        return &uriIt->get_ref<const std::string&>();
+    }
+
+    TMcpMethodResult HandleResourcesRead(const json &params)
+    {
+        const std::string *uri = GetUriParam(params);
+        if (!uri)
+            return TMcpMethodResult::Error(ErrorCode::InvalidParams, "Missing 'params.uri'");
+
+        TMcpResourceContents contents;
+        if (!FResources->Read(*uri, contents))
+            return TMcpMethodResult::Error(ErrorCode::ResourceNotFound,
+                "Resource not found: " + *uri);
+        return TMcpMethodResult::Success(json{{"contents", json::array({contents.ToJson()})}});
+    }
+
+    TMcpMethodResult HandleResourcesSubscribe(const json &params, const std::string &session,
+        bool subscribe)
+    {
+        const std::string *uri = GetUriParam(params);
+        if (!uri)
+            return TMcpMethodResult::Error(ErrorCode::InvalidParams, "Missing 'params.uri'");
+
+        if (!subscribe)
+            FResources->Unsubscribe(*uri, session);
+        else if (!FResources->Subscribe(*uri, session))
+            return TMcpMethodResult::Error(ErrorCode::ResourceNotFound,
+                "Not a resource that can be subscribed: " + *uri);
+        return TMcpMethodResult::Success(json::object());
     }
 
-    std::string HandleToolsCall(const json &reqJson, const std::string &id)
+    void SendResourceUpdated(const std::string &uri)
     {
-        if (!reqJson.contains("params") || reqJson["params"].is_null())
-            return MakeError(id, ErrorCode::InvalidParams, "Missing 'params'");
+        std::vector<std::string> sessions;
+        if (!FResources->TakePending(uri, sessions))
+            return;
+
+        std::string notification = MakeNotification("notifications/resources/updated",
+            json{{"uri", uri}});
+        if (!FOnSessionNotification)
+        {
+            if (FOnNotification)
+                FOnNotification(notification);
+            return;
+        }
+        for (const std::string &session : sessions)
+            FOnSessionNotification(session, notification);
+    }
+
+    TMcpMethodResult HandleToolsList(const json &params)
+    {
+        return TMcpMethodResult::SuccessRaw(FToolRegistry->GetToolsListPayload());
+    }
+
+    void HandleToolsCall(const json &params, std::shared_ptr<TMcpToolContext> context,
+        TMcpMethodCompletion done)
+    {
+        if (params.is_null())
+            return done(TMcpMethodResult::Error(ErrorCode::InvalidParams, "Missing 'params'"));
 
-        const json &params = reqJson["params"];
         if (!params.is_object())
-            return MakeError(id, ErrorCode::InvalidParams, "Invalid 'params'");
+            return done(TMcpMethodResult::Error(ErrorCode::InvalidParams, "Invalid 'params'"));
 
-        if (!params.contains("name") || !params["name"].is_string())
-            return MakeError(id, ErrorCode::InvalidParams, "Missing 'params.name'");
+        auto nameIt = params.find("name");
+        if (nameIt == params.end() || !nameIt->is_string())
+            return done(TMcpMethodResult::Error(ErrorCode::InvalidParams, "Missing 'params.name'"));
 
-        std::string toolName = params["name"].get<std::string>();
+        const std::string &toolName = nameIt->get_ref<const std::string&>();
 
-        json args = json::object();
-        if (params.contains("arguments") && !params["arguments"].is_null())
-            args = params["arguments"];
+        static const json emptyArgs = json::object();
+        auto argsIt = params.find("arguments");
+        const json &args = (argsIt != params.end() && !argsIt->is_null())
+            ? *argsIt : emptyArgs;
 
-        IMcpTool *tool = FToolRegistry->Get(toolName);
+        TMcpRegisteredTool registered = FToolRegistry->Find(toolName);
+        IMcpTool *tool = registered.Tool;
         if (!tool)
         {
             if (FOnToolExecuted)
                 FOnToolExecuted(toolName, false, "Tool not found");
-            return MakeError(id, ErrorCode::ToolNotFound, "Unknown tool: " + toolName);
+            return done(TMcpMethodResult::Error(ErrorCode::ToolNotFound,
+                "Unknown tool: " + toolName));
+        }
+
+        std::string validationError;
+        if (registered.Validator && !registered.Validator->Validate(args, validationError))
+        {
+            if (FOnToolExecuted)
+                FOnToolExecuted(toolName, false, validationError);
+            return done(TMcpMethodResult::Error(ErrorCode::InvalidParams, validationError));
         }
 
-        TMcpToolResult result;
+        context->SetStats(registered.Stats);
+        TClock::time_point started = TClock::now();
+
+        // Cached tools: the key is the canonical arguments (object keys are
+        // sorted), and a result only counts for the generation it started in
+        TMcpToolResultCache *cache = registered.Cache;
+        TMcpToolResultCache::TFlight flight;
+        if (cache)
+        {
+            uint64_t generation = FStateGeneration.load(std::memory_order_acquire);
+
+            TMcpCachedToolResponse cached;
+            TMcpCallStats *stats = registered.Stats;
+            auto lookup = cache->Acquire(args.dump(), generation, cached,
+                [this, &toolName, &args, &context, &done, &registered, started, stats]() {
+                    auto argsCopy = McpMakeShared<const json>(args);
+                    return [this, toolName, argsCopy, context, done, started, stats,
+                        snapshot = registered.Snapshot](const TMcpCachedToolResponse *response) {
+                        if (response)
+                            return CompleteCachedToolCall(toolName, stats, started, *response, done);
+                        // The leader's caller gave up; this call runs the
+                        // tool itself, or joins whichever retry does
+                        HandleToolsCall(json{{"name", toolName}, {"arguments", *argsCopy}},
+                            context, done);
+                    };
+                }, flight);
+
+            if (lookup == TMcpToolResultCache::TLookup::Hit)
+            {
+                stats->CacheHits.fetch_add(1, std::memory_order_relaxed);
+                return CompleteCachedToolCall(toolName, stats, started, cached, done);
+            }
+            if (lookup == TMcpToolResultCache::TLookup::Joined)
+            {
+                stats->Coalesced.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+        }
+
+        // A tool that throws after completing must not answer twice. The
+        // completion holds the registry snapshot, and with it the tool,
+        // until the call is over.
+        auto completed = McpMakeShared<std::atomic<bool>>(false);
+        bool readOnly = registered.Annotations->ReadOnlyHint;
+        TMcpConcurrencyLimiter *limiter = registered.Limiter;
+        TMcpToolCompletion complete =
+            [this, toolName, completed, started, readOnly, stats = registered.Stats,
+             cache, flight = std::move(flight), limiter, context,
+             done = std::move(done), snapshot = registered.Snapshot](TMcpToolResult result) {
+                if (completed->exchange(true))
+                    return;
+                stats->Record(!result.IsError, TClock::now() - started);
+                if (!readOnly)
+                    BumpStateGeneration();
+                if (FOnToolExecuted)
+                    FOnToolExecuted(toolName, !result.IsError, result.ErrorMessage);
+
+                if (!cache)
+                {
+                    done(TMcpMethodResult::SuccessRaw(
+                        std::make_shared<const std::string>(BuildToolResponse(result))));
+                }
+                else if (result.IsError && context->ShouldStop())
+                {
+                    // Cancelled or past the deadline: that was this caller's
+                    // doing, not an answer for the calls that joined it
+                    done(TMcpMethodResult::SuccessRaw(
+                        std::make_shared<const std::string>(BuildToolResponse(result))));
+                    cache->Abandon(flight);
+                }
+                else
+                {
+                    // Errors reach the calls that joined this one but are not kept
+                    TMcpCachedToolResponse response;
+                    response.Payload = std::make_shared<const std::string>(
+                        BuildToolResponse(result));
+                    response.IsError = result.IsError;
+                    response.ErrorMessage = std::move(result.ErrorMessage);
+                    done(TMcpMethodResult::SuccessRaw(response.Payload));
+                    cache->Complete(flight, response, !response.IsError);
+                }
+
+                if (limiter)
+                    limiter->Release();
+            };
+
+        bool onMainThread = registered.Policy->Affinity == TMcpThreadAffinity::MainThread &&
+            FMainThreadLimiter;
+        if (!limiter && !onMainThread)
+            return RunTool(tool, args, std::move(context), complete);
+
+        // The call may start later, after args is gone
+        auto argsCopy = McpMakeShared<const json>(args);
+        auto start = [this, tool, argsCopy, context, complete, onMainThread]() {
+            if (onMainThread)
+                RunToolOnMainThread(tool, argsCopy, context, complete);
+            else
+                RunTool(tool, *argsCopy, context, complete);
+        };
+        if (limiter)
+            limiter->Run(std::move(start));
+        else
+            start();
+    }
+
+    void RunTool(IMcpTool *tool, const json &args, std::shared_ptr<TMcpToolContext> context,
+        const TMcpToolCompletion &complete)
+    {
+        MCP_TRACE_REQUEST(context->GetRequestId());
+        MCP_TRACE_SCOPE("tool.execute");
+
+        // Answered already when it was cancelled or timed out while queued
+        if (context->ShouldStop())
+            return complete(TMcpToolResult::Error("Request cancelled before the tool started"));
+
         try
         {
-            result = tool->Execute(args, FContext);
+            tool->ExecuteAsync(args, std::move(context), complete);
         }
         catch (const std::exception &e)
         {
-            result = TMcpToolResult::Error(std::string("Tool execution failed: ") + e.what());
+            complete(TMcpToolResult::Error(std::string("Tool execution failed: ") + e.what()));
         }
+    }
+
+    // Holds a main-thread slot until ExecuteAsync returns, not until the
+    // tool completes: an asynchronous tool no longer occupies the thread
+    void RunToolOnMainThread(IMcpTool *tool, std::shared_ptr<const json> args,
+        std::shared_ptr<TMcpToolContext> context, TMcpToolCompletion complete)
+    {
+        TClock::time_point queued = TClock::now();
+        FMainThreadLimiter->Run([this, tool, args, context, complete, queued]() {
+            FMainThreadDispatcher([this, tool, args, context, complete, queued]() {
+                context->RecordWait(TClock::now() - queued);
+                RunTool(tool, *args, context, complete);
+                FMainThreadLimiter->Release();
+            });
+        });
+    }
 
+    // Answers a call from a cached or shared result
+    void CompleteCachedToolCall(const std::string &toolName, TMcpCallStats *stats,
+        TClock::time_point started, const TMcpCachedToolResponse &response,
+        const TMcpMethodCompletion &done)
+    {
+        stats->Record(!response.IsError, TClock::now() - started);
         if (FOnToolExecuted)
-            FOnToolExecuted(toolName, !result.IsError, result.ErrorMessage);
+            FOnToolExecuted(toolName, !response.IsError, response.ErrorMessage);
+        done(TMcpMethodResult::SuccessRaw(response.Payload));
+    }
 
-        json mcpResult = BuildToolResponse(result);
-        return MakeResponse(id, mcpResult);
+    // received + params._meta.timeoutMs; time_point::max() when absent
+    static TClock::time_point GetDeadline(const json &params, TClock::time_point received)
+    {
+        if (!params.is_object())
+            return TClock::time_point::max();
+        auto metaIt = params.find("_meta");
+        if (metaIt == params.end() || !metaIt->is_object())
+            return TClock::time_point::max();
+        auto timeoutIt = metaIt->find("timeoutMs");
+        if (timeoutIt == metaIt->end() || !timeoutIt->is_number())
+            return TClock::time_point::max();
+
+        // Anything beyond a day is treated as no deadline
+        constexpr double maxTimeoutMs = 24.0 * 60 * 60 * 1000;
+        double timeoutMs = timeoutIt->get<double>();
+        if (timeoutMs > maxTimeoutMs)
+            return TClock::time_point::max();
+        return received + std::chrono::milliseconds(static_cast<int64_t>(timeoutMs));
     }
 
-    std::string HandlePing(const std::string &id)
+    // params._meta.progressToken (string or integer); null when absent
+    static json GetProgressToken(const json &params)
     {
-        return MakeResponse(id, json{{"status", "ok"}});
+        auto metaIt = params.find("_meta");
+        if (metaIt == params.end() || !metaIt->is_object())
+            return json();
+        auto tokenIt = metaIt->find("progressToken");
+        if (tokenIt == metaIt->end() || !(tokenIt->is_string() || tokenIt->is_number_integer()))
+            return json();
+        return *tokenIt;
     }
 
-    static json BuildToolResponse(const TMcpToolResult &result)
+    TMcpMethodResult HandlePing(const json &params)
     {
-        std::string contentStr;
-        if (result.Content.is_string())
-            contentStr = result.Content.get<std::string>();
-        else
-            contentStr = result.Content.dump();
+        return TMcpMethodResult::Success(json{{"status", "ok"}});
+    }
 
-        json response;
-        response["content"] = json::array({
-            json{{"type", "text"}, {"text", contentStr}}
-        });
+    // Serialized tools/call result. The content is serialized once: a text
+    // block escapes that text as a string, structuredContent splices it.
+    // Structured-only results are written straight into the response.
+    std::string BuildToolResponse(const TMcpToolResult &result) const
+    {
+        MCP_TRACE_SCOPE("mcp.serialize_result");
+
+        const json &content = result.Content;
+        const std::string *contentJson = result.RawContent.get();  // JSON text of the content
 
+        TMcpToolOutputFormat format = FToolOutputFormat.load(std::memory_order_relaxed);
+        bool isObject = contentJson ? IsJsonObjectText(*contentJson) : content.is_object();
+        bool structured = format != TMcpToolOutputFormat::Text && !result.IsError && isObject;
+        bool withText = !structured || format == TMcpToolOutputFormat::StructuredWithText;
+
+        // The text block needs the content as text; the scratch buffer
+        // keeps its capacity from one call to the next on this thread
+        thread_local std::string scratch;
+        if (withText && !contentJson && !content.is_string())
+        {
+            TMcpJsonWriter serializer(std::move(scratch));
+            serializer.Value(content);
+            scratch = serializer.Take();
+            contentJson = &scratch;
+        }
+
+        TMcpJsonWriter writer(contentJson ? contentJson->size() * (withText ? 2 : 1) + 64 : 256);
+        writer.Raw("{\"content\":[");
+        if (withText)
+        {
+            // A string result is sent as its text, anything else as JSON
+            writer.Raw("{\"text\":");
+            if (contentJson)
+                writer.String(*contentJson);
+            else
+                writer.Value(content);
+            writer.Raw(",\"type\":\"text\"}");
+        }
+        writer.Raw(']');
         if (result.IsError)
-            response["isError"] = true;
+            writer.Raw(",\"isError\":true");
+        if (structured)
+        {
+            writer.Raw(",\"structuredContent\":");
+            if (contentJson)
+                writer.Raw(*contentJson);
+            else
+                writer.Value(content);
+        }
+        writer.Raw('}');
+
+        if (contentJson == &scratch)
+            scratch.clear();
+        return writer.Take();
+    }
 
-        return response;
+    static bool IsJsonObjectText(const std::string &text)
+    {
+        for (char c : text)
+        {
+            if (c != ' ' && c != '\t' && c != '\r' && c != '\n')
+                return c == '{';
+        }
+        return false;
+    }
+
+    static std::string MakeResponse(const json &id, const json &result)
+    {
+        TMcpJsonWriter writer(256);
+        writer.Raw("{\"jsonrpc\":\"2.0\",\"id\":").Value(id)
+            .Raw(",\"result\":").Value(result).Raw('}');
+        return writer.Take();
+    }
+
+    static std::string MakeRawResponse(const json &id, const std::string &rawResult)
+    {
+        TMcpJsonWriter writer(rawResult.size() + 64);
+        writer.Raw("{\"jsonrpc\":\"2.0\",\"id\":").Value(id)
+            .Raw(",\"result\":").Raw(rawResult).Raw('}');
+        return writer.Take();
     }
 
-    static std::string MakeResponse(const std::string &id, const json &result)
+    // Parse error messages quote the input, which need not be UTF-8; the
+    // writer replaces invalid sequences
+    static std::string MakeError(const json &id, int code, const std::string &message)
     {
-        json response;
-        response["jsonrpc"] = "2.0";
-        response["id"] = json::parse(id.empty() ? "null" : id);
-        response["result"] = result;
-        return response.dump();
+        TMcpJsonWriter writer(message.size() + 96);
+        writer.Raw("{\"jsonrpc\":\"2.0\",\"id\":").Value(id)
+            .Raw(",\"error\":{\"code\":").Integer(code)
+            .Raw(",\"message\":").String(message).Raw("}}");
+        return writer.Take();
     }
 
-    static std::string MakeError(const std::string &id, int code, const std::string &message)
+    static std::string MakeNotification(const std::string &method, const json &params)
     {
-        json response;
-        response["jsonrpc"] = "2.0";
-        response["id"] = json::parse(id.empty() ? "null" : id);
-        response["error"] = json{{"code", code}, {"message", message}};
-        return response.dump();
+        TMcpJsonWriter writer(128);
+        writer.Raw("{\"jsonrpc\":\"2.0\",\"method\":").String(method);
+        if (!params.is_null())
+            writer.Raw(",\"params\":").Value(params);
+        writer.Raw('}');
+        return writer.Take();
     }
 };
 
@@ -0,0 +1,327 @@
+//---------------------------------------------------------------------------
+// McpTrace.h — Scoped tracing spans with Chrome / Perfetto trace export
+//
+// MCP_TRACE_SCOPE("name") records how long the enclosing scope took, on
+// the calling thread, tagged with the JSON-RPC id set by the innermost
+// MCP_TRACE_REQUEST(id). Spans go to a fixed-size ring buffer per thread;
+// the oldest are overwritten. TMcpTracer::Instance().ToChromeJson() (or
+// WriteChromeTrace) dumps them as trace event JSON for chrome://tracing
+// and ui.perfetto.dev.
+//
+// Without MCP_TRACE_ENABLED=1 the macros expand to nothing, and their
+// arguments are not evaluated. When enabled, SetEnabled(false) pauses
+// recording at the cost of one relaxed load per span.
+// Pure C++ with nlohmann::json - NO VCL dependencies.
+//---------------------------------------------------------------------------
+
+#ifndef McpTraceH
+#define McpTraceH
+
+//---------------------------------------------------------------------------
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "../../external/nlohmann/json.hpp"
+
+#ifndef MCP_TRACE_ENABLED
+#define MCP_TRACE_ENABLED 0
+#endif
+
+namespace Mcp {
+
+using json = nlohmann::json;
+
+//---------------------------------------------------------------------------
+// TMcpTraceEvent — one completed span. Name must be a string literal.
+//---------------------------------------------------------------------------
+struct TMcpTraceEvent
+{
+    static constexpr size_t MaxRequestId = 32;
+
+    const char *Name = nullptr;
+    uint64_t StartNs = 0;      // since the tracer was created
+    uint64_t DurationNs = 0;
+    uint32_t ThreadId = 0;
+    char RequestId[MaxRequestId] = {};
+};
+
+//---------------------------------------------------------------------------
+// TMcpTracer — owns the per-thread buffers
+//
+// A thread gets a buffer on its first span and hands it back when it
+// exits; the next new thread reuses it. Indy's thread-per-connection
+// model therefore keeps as many buffers as there were concurrent
+// threads, not one per connection ever made.
+//---------------------------------------------------------------------------
+class TMcpTracer
+{
+public:
+    using TClock = std::chrono::steady_clock;
+
+    static constexpr size_t BufferCapacity = 4096;  // events per thread
+
+private:
+    // Only the owning thread writes; the mutex is contended only by a dump
+    struct TBuffer
+    {
+        std::mutex Mutex;
+        std::vector<TMcpTraceEvent> Events = std::vector<TMcpTraceEvent>(BufferCapacity);
+        uint64_t Written = 0;
+    };
+
+    struct TThreadState
+    {
+        TBuffer *Buffer = nullptr;
+        uint32_t ThreadId = 0;
+        char RequestId[TMcpTraceEvent::MaxRequestId] = {};
+
+        ~TThreadState()
+        {
+            if (Buffer)
+                Instance().ReleaseBuffer(Buffer);
+        }
+    };
+
+    TClock::time_point FEpoch = TClock::now();
+    std::atomic<bool> FEnabled{true};
+    std::atomic<uint32_t> FNextThreadId{1};
+
+    std::mutex FMutex;
+    std::vector<std::unique_ptr<TBuffer>> FBuffers;
+    std::vector<TBuffer*> FFreeBuffers;
+
+    TMcpTracer() = default;
+
+public:
+    TMcpTracer(const TMcpTracer&) = delete;
+    TMcpTracer& operator=(const TMcpTracer&) = delete;
+
+    static TMcpTracer& Instance()
+    {
+        static TMcpTracer tracer;
+        return tracer;
+    }
+
+    void SetEnabled(bool enabled) { FEnabled.store(enabled, std::memory_order_relaxed); }
+    bool IsEnabled() const { return FEnabled.load(std::memory_order_relaxed); }
+
+    uint64_t NowNs() const
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            TClock::now() - FEpoch).count());
+    }
+
+    // Request id of the innermost MCP_TRACE_REQUEST on this thread
+    static char* CurrentRequestId() { return State().RequestId; }
+
+    void Record(const char *name, uint64_t startNs, uint64_t endNs)
+    {
+        TThreadState &state = State();
+        if (!state.Buffer)
+            AttachBuffer(state);
+
+        TBuffer &buffer = *state.Buffer;
+        std::lock_guard<std::mutex> lock(buffer.Mutex);
+        TMcpTraceEvent &event = buffer.Events[buffer.Written % BufferCapacity];
+        event.Name = name;
+        event.StartNs = startNs;
+        event.DurationNs = endNs - startNs;
+        event.ThreadId = state.ThreadId;
+        std::memcpy(event.RequestId, state.RequestId, sizeof(event.RequestId));
+        buffer.Written++;
+    }
+
+    // Events still held, oldest first within each thread
+    std::vector<TMcpTraceEvent> Snapshot()
+    {
+        std::vector<TMcpTraceEvent> events;
+        std::lock_guard<std::mutex> lock(FMutex);
+        for (auto &buffer : FBuffers)
+        {
+            std::lock_guard<std::mutex> bufferLock(buffer->Mutex);
+            uint64_t count = buffer->Written < BufferCapacity ? buffer->Written : BufferCapacity;
+            for (uint64_t i = buffer->Written - count; i < buffer->Written; i++)
+                events.push_back(buffer->Events[i % BufferCapacity]);
+        }
+        return events;
+    }
+
+    void Clear()
+    {
+        std::lock_guard<std::mutex> lock(FMutex);
+        for (auto &buffer : FBuffers)
+        {
+            std::lock_guard<std::mutex> bufferLock(buffer->Mutex);
+            buffer->Written = 0;
+        }
+    }
+
+    // Trace Event Format: complete ("X") events, timestamps in microseconds
+    json ToChromeJson()
+    {
+        json events = json::array();
+        for (const TMcpTraceEvent &event : Snapshot())
+        {
+            json e;
+            e["name"] = event.Name;
+            e["cat"] = "mcp";
+            e["ph"] = "X";
+            e["ts"] = event.StartNs / 1000.0;
+            e["dur"] = event.DurationNs / 1000.0;
+            e["pid"] = 1;
+            e["tid"] = event.ThreadId;
+            if (event.RequestId[0])
+                e["args"]["requestId"] = std::string(event.RequestId);
+            events.push_back(std::move(e));
+        }
+
+        json trace;
+        trace["traceEvents"] = std::move(events);
+        trace["displayTimeUnit"] = "ms";
+        return trace;
+    }
+
+    bool WriteChromeTrace(const std::string &path)
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        if (!out)
+            return false;
+        out << ToChromeJson().dump(-1, ' ', false, json::error_handler_t::replace);
+        return static_cast<bool>(out);
+    }
+
+private:
+    static TThreadState& State()
+    {
+        thread_local TThreadState state;
+        return state;
+    }
+
+    void AttachBuffer(TThreadState &state)
+    {
+        state.ThreadId = FNextThreadId.fetch_add(1, std::memory_order_relaxed);
+
+        std::lock_guard<std::mutex> lock(FMutex);
+        if (!FFreeBuffers.empty())
+        {
+            state.Buffer = FFreeBuffers.back();
+            FFreeBuffers.pop_back();
+            return;
+        }
+        FBuffers.push_back(std::make_unique<TBuffer>());
+        state.Buffer = FBuffers.back().get();
+    }
+
+    // The events stay readable until the next owner overwrites them
+    void ReleaseBuffer(TBuffer *buffer)
+    {
+        std::lock_guard<std::mutex> lock(FMutex);
+        FFreeBuffers.push_back(buffer);
+    }
+};
+
+//---------------------------------------------------------------------------
+// TMcpTraceScope — records one span on destruction
+//---------------------------------------------------------------------------
+class TMcpTraceScope
+{
+private:
+    const char *FName;
+    uint64_t FStartNs = 0;
+
+public:
+    explicit TMcpTraceScope(const char *name)
+        : FName(TMcpTracer::Instance().IsEnabled() ? name : nullptr)
+    {
+        if (FName)
+            FStartNs = TMcpTracer::Instance().NowNs();
+    }
+
+    ~TMcpTraceScope()
+    {
+        if (FName)
+            TMcpTracer::Instance().Record(FName, FStartNs, TMcpTracer::Instance().NowNs());
+    }
+
+    TMcpTraceScope(const TMcpTraceScope&) = delete;
+    TMcpTraceScope& operator=(const TMcpTraceScope&) = delete;
+};
+
+//---------------------------------------------------------------------------
+// TMcpTraceRequestScope — tags spans on this thread with a JSON-RPC id
+//
+// Restores the previous id on destruction. Code that continues a request
+// on another thread (e.g. the main thread) opens its own scope there.
+//---------------------------------------------------------------------------
+class TMcpTraceRequestScope
+{
+private:
+    char FPrevious[TMcpTraceEvent::MaxRequestId];
+    bool FActive;
+
+public:
+    explicit TMcpTraceRequestScope(const json &id)
+        : FActive(TMcpTracer::Instance().IsEnabled() && !id.is_null())
+    {
+        if (!FActive)
+            return;
+
+        char *current = TMcpTracer::CurrentRequestId();
+        std::memcpy(FPrevious, current, sizeof(FPrevious));
+
+        if (id.is_string())
+            Copy(current, id.get_ref<const std::string&>());
+        else if (id.is_number_integer())
+            std::snprintf(current, TMcpTraceEvent::MaxRequestId, "%lld",
+                static_cast<long long>(id.get<int64_t>()));
+        else
+            Copy(current, id.dump());
+    }
+
+    ~TMcpTraceRequestScope()
+    {
+        if (FActive)
+            std::memcpy(TMcpTracer::CurrentRequestId(), FPrevious, sizeof(FPrevious));
+    }
+
+    TMcpTraceRequestScope(const TMcpTraceRequestScope&) = delete;
+    TMcpTraceRequestScope& operator=(const TMcpTraceRequestScope&) = delete;
+
+private:
+    static void Copy(char *target, const std::string &value)
+    {
+        size_t length = value.size() < TMcpTraceEvent::MaxRequestId - 1
+            ? value.size() : TMcpTraceEvent::MaxRequestId - 1;
+        std::memcpy(target, value.data(), length);
+        target[length] = '\0';
+    }
+};
+
+} // namespace Mcp
+
+//---------------------------------------------------------------------------
+// Instrumentation macros
+//---------------------------------------------------------------------------
+#define MCP_TRACE_CONCAT_INNER(a, b) a##b
+#define MCP_TRACE_CONCAT(a, b) MCP_TRACE_CONCAT_INNER(a, b)
+
+#if MCP_TRACE_ENABLED
+#define MCP_TRACE_SCOPE(name) \
+    ::Mcp::TMcpTraceScope MCP_TRACE_CONCAT(mcpTraceScope_, __LINE__)(name)
+#define MCP_TRACE_REQUEST(id) \
+    ::Mcp::TMcpTraceRequestScope MCP_TRACE_CONCAT(mcpTraceRequest_, __LINE__)(id)
+#else
+#define MCP_TRACE_SCOPE(name) ((void)0)
+#define MCP_TRACE_REQUEST(id) ((void)0)
+#endif
+
+//---------------------------------------------------------------------------
+#endif // McpTraceH
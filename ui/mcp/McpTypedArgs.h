@@ -0,0 +1,298 @@
+//---------------------------------------------------------------------------
+// McpTypedArgs.h — Typed tool arguments with generated input schema
+//
+// A tool declares its arguments once, as a plain struct with a constexpr
+// field table:
+//
+//   struct TMyArgs
+//   {
+//       int Limit = 100;
+//       std::string Filter;
+//
+//       static constexpr auto Fields()
+//       {
+//           return std::make_tuple(
+//               McpArg("limit", &TMyArgs::Limit, "Maximum items"),
+//               McpArg("filter", &TMyArgs::Filter, "Filter text", true));
+//       }
+//   };
+//
+// The input schema is built from the field table at runtime, once per
+// argument type, and arguments are decoded into the struct in one pass
+// over the JSON object.
+// Pure C++ with nlohmann::json - NO VCL dependencies.
+//---------------------------------------------------------------------------
+
+#ifndef McpTypedArgsH
+#define McpTypedArgsH
+
+//---------------------------------------------------------------------------
+#include <string>
+#include <tuple>
+#include <array>
+#include <algorithm>
+#include <functional>
+
+#include "McpServer.h"
+
+namespace Mcp {
+
+//---------------------------------------------------------------------------
+// TMcpArgType — schema type and lenient decoding per C++ type. Decoding
+// follows TMcpToolBase::GetString/GetInt/GetBool: values that do not
+// convert leave the struct default in place.
+//---------------------------------------------------------------------------
+template<typename T>
+struct TMcpArgType;
+
+template<>
+struct TMcpArgType<std::string>
+{
+    static void AddToSchema(TMcpToolSchema &schema, const char *name,
+        const char *description, bool required)
+    {
+        schema.AddString(name, description, required);
+    }
+
+    static void Decode(const json &val, std::string &out)
+    {
+        if (val.is_string())
+            out = val.get_ref<const std::string&>();
+        else
+            out = val.dump();
+    }
+};
+
+template<>
+struct TMcpArgType<int>
+{
+    static void AddToSchema(TMcpToolSchema &schema, const char *name,
+        const char *description, bool required)
+    {
+        schema.AddInteger(name, description, required);
+    }
+
+    static void Decode(const json &val, int &out)
+    {
+        if (val.is_number())
+            TMcpToolBase::ToInt(val, out);
+        else if (val.is_string())
+        {
+            try { out = std::stoi(val.get_ref<const std::string&>()); }
+            catch (...) {}
+        }
+    }
+};
+
+template<>
+struct TMcpArgType<bool>
+{
+    static void AddToSchema(TMcpToolSchema &schema, const char *name,
+        const char *description, bool required)
+    {
+        schema.AddBoolean(name, description, required);
+    }
+
+    static void Decode(const json &val, bool &out)
+    {
+        if (val.is_boolean())
+            out = val.get<bool>();
+        else if (val.is_string())
+        {
+            std::string s = val.get<std::string>();
+            std::transform(s.begin(), s.end(), s.begin(), ::tolower);
+            out = (s == "true" || s == "1" || s == "yes");
+        }
+    }
+};
+
+//---------------------------------------------------------------------------
+// TMcpArgField — one entry of an argument struct's field table
+//---------------------------------------------------------------------------
+template<typename TArgs, typename T>
+struct TMcpArgField
+{
+    using Type = T;
+
+    const char *Name;
+    T TArgs::*Member;
+    const char *Description;
+    bool Required;
+};
+
+template<typename TArgs, typename T>
+constexpr TMcpArgField<TArgs, T> McpArg(const char *name, T TArgs::*member,
+    const char *description, bool required = false)
+{
+    return TMcpArgField<TArgs, T>{name, member, description, required};
+}
+
+//---------------------------------------------------------------------------
+// Schema generation and decoding
+//---------------------------------------------------------------------------
+// Built on first use and shared by every tool taking TArgs
+template<typename TArgs>
+const TMcpToolSchema& McpArgsSchema()
+{
+    static const TMcpToolSchema schema = []() {
+        TMcpToolSchema built;
+        std::apply([&built](const auto &... field) {
+            (TMcpArgType<typename std::decay_t<decltype(field)>::Type>::AddToSchema(
+                built, field.Name, field.Description, field.Required), ...);
+        }, TArgs::Fields());
+        return built;
+    }();
+    return schema;
+}
+
+// One pass over the arguments object; each key is matched against the
+// (short, compile-time) field list. Null values count as absent.
+template<typename TArgs>
+bool McpDecodeArgs(const json &args, TArgs &out, std::string &error)
+{
+    constexpr auto fields = TArgs::Fields();
+    constexpr size_t fieldCount = std::tuple_size<std::decay_t<decltype(fields)>>::value;
+    std::array<bool, fieldCount> seen{};
+
+    if (args.is_object())
+    {
+        for (auto it = args.begin(); it != args.end(); ++it)
+        {
+            if (it->is_null())
+                continue;
+
+            const std::string &key = it.key();
+            size_t index = 0;
+            std::apply([&](const auto &... field) {
+                (void)((key == field.Name
+                    ? (TMcpArgType<typename std::decay_t<decltype(field)>::Type>::Decode(
+                          *it, out.*(field.Member)), seen[index] = true, true)
+                    : (++index, false)) || ...);
+            }, fields);
+        }
+    }
+
+    bool ok = true;
+    size_t index = 0;
+    std::apply([&](const auto &... field) {
+        (void)(((field.Required && !seen[index])
+            ? (error = std::string("Missing required argument '") + field.Name + "'",
+               ok = false, true)
+            : (++index, false)) || ...);
+    }, fields);
+    return ok;
+}
+
+//---------------------------------------------------------------------------
+// TMcpTypedTool — Tool whose arguments are decoded into TArgs
+//---------------------------------------------------------------------------
+template<typename TArgs>
+class TMcpTypedTool : public TMcpToolBase
+{
+public:
+    using ExecuteFunc = std::function<TMcpToolResult(const TArgs&, TMcpToolContext&)>;
+
+private:
+    std::string FName;
+    std::string FDescription;
+    TMcpToolAnnotations FAnnotations;
+    ExecuteFunc FExecute;
+
+public:
+    TMcpTypedTool(const std::string &name, const std::string &description,
+        ExecuteFunc executeFunc)
+        : FName(name)
+        , FDescription(description)
+        , FExecute(std::move(executeFunc))
+    {
+        FAnnotations.Title = name;
+    }
+
+    TMcpTypedTool& WithAnnotations(const TMcpToolAnnotations &ann)
+    {
+        FAnnotations = ann;
+        if (FAnnotations.Title.empty())
+            FAnnotations.Title = FName;
+        return *this;
+    }
+
+    std::string GetName() const override { return FName; }
+    std::string GetDescription() const override { return FDescription; }
+    TMcpToolSchema GetInputSchema() const override { return McpArgsSchema<TArgs>(); }
+    TMcpToolAnnotations GetAnnotations() const override { return FAnnotations; }
+
+    TMcpToolResult Execute(const json &args, TMcpToolContext &context) override
+    {
+        if (!FExecute)
+            return TMcpToolResult::Error("No execute function defined");
+
+        TArgs typedArgs;
+        std::string error;
+        if (!McpDecodeArgs(args, typedArgs, error))
+            return TMcpToolResult::Error(error);
+        return FExecute(typedArgs, context);
+    }
+};
+
+//---------------------------------------------------------------------------
+// Registration helpers
+//---------------------------------------------------------------------------
+template<typename TArgs>
+void RegisterTypedTool(TMcpServer &server, const std::string &name,
+    const std::string &description, typename TMcpTypedTool<TArgs>::ExecuteFunc func)
+{
+    server.Register(std::make_unique<TMcpTypedTool<TArgs>>(name, description, std::move(func)));
+}
+
+template<typename TArgs>
+void RegisterTypedTool(TMcpServer &server, const std::string &name,
+    const std::string &description, const TMcpToolAnnotations &annotations,
+    typename TMcpTypedTool<TArgs>::ExecuteFunc func)
+{
+    auto tool = std::make_unique<TMcpTypedTool<TArgs>>(name, description, std::move(func));
+    tool->WithAnnotations(annotations);
+    server.Register(std::move(tool));
+}
+
+// Asynchronous variant: func completes through done (see IMcpTool::ExecuteAsync)
+template<typename TArgs>
+using TMcpTypedAsyncFunc = std::function<void(const TArgs&,
+    std::shared_ptr<TMcpToolContext>, TMcpToolCompletion)>;
+
+template<typename TArgs>
+TMcpAsyncLambdaTool::ExecuteAsyncFunc McpDecodingAsyncFunc(TMcpTypedAsyncFunc<TArgs> func)
+{
+    return [func = std::move(func)](const json &args, std::shared_ptr<TMcpToolContext> context,
+        TMcpToolCompletion done) {
+        TArgs typedArgs;
+        std::string error;
+        if (!McpDecodeArgs(args, typedArgs, error))
+        {
+            done(TMcpToolResult::Error(error));
+            return;
+        }
+        func(typedArgs, std::move(context), std::move(done));
+    };
+}
+
+template<typename TArgs>
+void RegisterTypedAsyncTool(TMcpServer &server, const std::string &name,
+    const std::string &description, TMcpTypedAsyncFunc<TArgs> func)
+{
+    server.RegisterAsyncLambda(name, description, McpArgsSchema<TArgs>(),
+        McpDecodingAsyncFunc<TArgs>(std::move(func)));
+}
+
+template<typename TArgs>
+void RegisterTypedAsyncTool(TMcpServer &server, const std::string &name,
+    const std::string &description, const TMcpToolAnnotations &annotations,
+    TMcpTypedAsyncFunc<TArgs> func)
+{
+    server.RegisterAsyncLambda(name, description, McpArgsSchema<TArgs>(), annotations,
+        McpDecodingAsyncFunc<TArgs>(std::move(func)));
+}
+
+} // namespace Mcp
+
+//---------------------------------------------------------------------------
+#endif // McpTypedArgsH
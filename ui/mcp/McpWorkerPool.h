@@ -0,0 +1,98 @@
+//---------------------------------------------------------------------------
+// McpWorkerPool.h — Fixed-size worker thread pool for the MCP server
+//
+// Used to run independent JSON-RPC batch elements concurrently.
+// Pure C++ - NO VCL dependencies.
+//---------------------------------------------------------------------------
+
+#ifndef McpWorkerPoolH
+#define McpWorkerPoolH
+
+//---------------------------------------------------------------------------
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+
+namespace Mcp {
+
+//---------------------------------------------------------------------------
+// TMcpWorkerPool — N threads draining a shared FIFO task queue
+//---------------------------------------------------------------------------
+class TMcpWorkerPool
+{
+private:
+    std::vector<std::thread> FThreads;
+    std::deque<std::function<void()>> FTasks;
+    std::mutex FMutex;
+    std::condition_variable FCondition;
+    bool FStopping = false;
+
+public:
+    explicit TMcpWorkerPool(unsigned threadCount)
+    {
+        if (threadCount == 0)
+            threadCount = 1;
+        FThreads.reserve(threadCount);
+        for (unsigned i = 0; i < threadCount; i++)
+            FThreads.emplace_back([this]() { WorkerLoop(); });
+    }
+
+    ~TMcpWorkerPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(FMutex);
+            FStopping = true;
+        }
+        FCondition.notify_all();
+        for (auto &t : FThreads)
+            t.join();
+    }
+
+    TMcpWorkerPool(const TMcpWorkerPool&) = delete;
+    TMcpWorkerPool& operator=(const TMcpWorkerPool&) = delete;
+
+    size_t GetThreadCount() const { return FThreads.size(); }
+
+    // Queue a callable; the future carries its result or exception
+    template<typename Func>
+    auto Submit(Func func) -> std::future<decltype(func())>
+    {
+        using TResult = decltype(func());
+        auto task = std::make_shared<std::packaged_task<TResult()>>(std::move(func));
+        std::future<TResult> future = task->get_future();
+        {
+            std::lock_guard<std::mutex> lock(FMutex);
+            FTasks.emplace_back([task]() { (*task)(); });
+        }
+        FCondition.notify_one();
+        return future;
+    }
+
+private:
+    void WorkerLoop()
+    {
+        while (true)
+        {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(FMutex);
+                FCondition.wait(lock, [this]() { return FStopping || !FTasks.empty(); });
+                if (FTasks.empty())
+                    return;
+                task = std::move(FTasks.front());
+                FTasks.pop_front();
+            }
+            task();
+        }
+    }
+};
+
+} // namespace Mcp
+
+//---------------------------------------------------------------------------
+#endif // McpWorkerPoolH
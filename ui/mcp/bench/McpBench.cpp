@@ -0,0 +1,536 @@
+//---------------------------------------------------------------------------
+// McpBench.cpp — Throughput and allocation benchmark for the portable MCP core
+//
+// Drives TMcpServer::HandleRequest, the HTTP routing/CORS helpers, the
+// response writer and the wire codecs in-process, one case at a time, and
+// reports ops/sec, ns/op, heap allocations and bytes allocated per
+// operation. Cases that reproduce an earlier implementation are named as
+// the baseline of the current one, and the speedup over it is reported.
+// Build with ui/mcp/bench/build.sh and compare runs before and after a
+// change:
+//
+//   ./mcp_bench                  all cases
+//   ./mcp_bench call             cases whose name contains "call"
+//   ./mcp_bench --time 2000      run each case for ~2 s (default 500 ms)
+//   ./mcp_bench --json           one JSON object per case, for scripts
+//---------------------------------------------------------------------------
+
+#include "McpBenchFixture.h"
+#include "../transport/http/CorsValidator.h"
+#include "../transport/http/McpHttpRouter.h"
+#include "../transport/http/McpWireFormat.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+//---------------------------------------------------------------------------
+// Allocation counting: every operator new in the process goes through here
+//---------------------------------------------------------------------------
+static std::atomic<uint64_t> GAllocCount{0};
+static std::atomic<uint64_t> GAllocBytes{0};
+
+static void* CountedAlloc(std::size_t size)
+{
+    GAllocCount.fetch_add(1, std::memory_order_relaxed);
+    GAllocBytes.fetch_add(size, std::memory_order_relaxed);
+    if (void *p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size) { return CountedAlloc(size); }
+void* operator new[](std::size_t size) { return CountedAlloc(size); }
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+
+using namespace Mcp;
+using namespace Mcp::Transport;
+using TClock = std::chrono::steady_clock;
+
+struct TBenchCase
+{
+    std::string Name;
+    std::function<void()> Run;   // one operation
+    std::string Baseline;        // case this one is compared against
+    unsigned Threads = 1;        // threads running Run at once
+    std::function<void()> Background;  // run every millisecond meanwhile
+};
+
+struct TBenchResult
+{
+    uint64_t Ops = 0;
+    double Seconds = 0;
+    double AllocsPerOp = 0;
+    double BytesPerOp = 0;
+};
+
+// Runs the case on its threads for minTime; ops/sec is their total
+TBenchResult MeasureThreaded(const TBenchCase &bench, std::chrono::milliseconds minTime)
+{
+    for (int i = 0; i < 16; i++)
+        bench.Run();
+
+    std::atomic<bool> stop{false};
+    std::vector<uint64_t> ops(bench.Threads);
+    std::vector<std::thread> threads;
+    uint64_t allocs = GAllocCount.load();
+    uint64_t bytes = GAllocBytes.load();
+    TClock::time_point start = TClock::now();
+
+    for (unsigned t = 0; t < bench.Threads; t++)
+    {
+        threads.emplace_back([&bench, &stop, &ops, t]() {
+            while (!stop.load(std::memory_order_relaxed))
+            {
+                for (int i = 0; i < 256; i++)
+                    bench.Run();
+                ops[t] += 256;
+            }
+        });
+    }
+    if (bench.Background)
+    {
+        threads.emplace_back([&bench, &stop]() {
+            while (!stop.load(std::memory_order_relaxed))
+            {
+                bench.Background();
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        });
+    }
+
+    std::this_thread::sleep_for(minTime);
+    stop = true;
+    for (std::thread &thread : threads)
+        thread.join();
+
+    TBenchResult result;
+    for (uint64_t count : ops)
+        result.Ops += count;
+    result.Seconds = std::chrono::duration<double>(TClock::now() - start).count();
+    result.AllocsPerOp = double(GAllocCount.load() - allocs) / result.Ops;
+    result.BytesPerOp = double(GAllocBytes.load() - bytes) / result.Ops;
+    return result;
+}
+
+// Grows the batch size until the case has run for at least minTime
+TBenchResult Measure(const TBenchCase &bench, std::chrono::milliseconds minTime)
+{
+    if (bench.Threads > 1 || bench.Background)
+        return MeasureThreaded(bench, minTime);
+
+    for (int i = 0; i < 16; i++)
+        bench.Run();
+
+    TBenchResult result;
+    uint64_t batch = 1;
+    uint64_t allocs = GAllocCount.load();
+    uint64_t bytes = GAllocBytes.load();
+    TClock::time_point start = TClock::now();
+    TClock::duration elapsed{};
+
+    while (elapsed < minTime)
+    {
+        for (uint64_t i = 0; i < batch; i++)
+            bench.Run();
+        result.Ops += batch;
+        elapsed = TClock::now() - start;
+        if (batch < (1u << 20))
+            batch *= 2;
+    }
+
+    result.Seconds = std::chrono::duration<double>(elapsed).count();
+    result.AllocsPerOp = double(GAllocCount.load() - allocs) / result.Ops;
+    result.BytesPerOp = double(GAllocBytes.load() - bytes) / result.Ops;
+    return result;
+}
+
+std::string Request(const std::string &id, const std::string &method, const std::string &params)
+{
+    std::string text = "{\"jsonrpc\":\"2.0\",\"id\":" + id + ",\"method\":\"" + method + "\"";
+    if (!params.empty())
+        text += ",\"params\":" + params;
+    return text + "}";
+}
+
+std::string ToolCall(const std::string &id, const std::string &tool, const std::string &args)
+{
+    return Request(id, "tools/call", "{\"name\":\"" + tool + "\",\"arguments\":" + args + "}");
+}
+
+// Requests that must produce a response; a silent failure would make the
+// numbers meaningless
+void Expect(bool condition, const char *what)
+{
+    if (!condition)
+    {
+        std::fprintf(stderr, "bench setup failed: %s\n", what);
+        std::exit(2);
+    }
+}
+
+//---------------------------------------------------------------------------
+// The tool registry as it was before snapshots were published: every
+// lookup takes the mutex and walks the map
+//---------------------------------------------------------------------------
+class TMutexToolRegistry
+{
+private:
+    std::map<std::string, std::unique_ptr<IMcpTool>> FTools;
+    mutable std::mutex FMutex;
+
+public:
+    void Register(std::unique_ptr<IMcpTool> tool)
+    {
+        std::lock_guard<std::mutex> lock(FMutex);
+        std::string name = tool->GetName();
+        FTools[name] = std::move(tool);
+    }
+
+    IMcpTool* Get(const std::string &name) const
+    {
+        std::lock_guard<std::mutex> lock(FMutex);
+        auto it = FTools.find(name);
+        return (it != FTools.end()) ? it->second.get() : nullptr;
+    }
+};
+
+std::unique_ptr<IMcpTool> MakeLookupTool(const std::string &name)
+{
+    return std::make_unique<TMcpLambdaTool>(name, "Lookup benchmark tool",
+        TMcpToolSchema().AddString("text", "Text", true),
+        [](const json &args, TMcpToolContext &ctx) -> TMcpToolResult {
+            return TMcpToolResult::Success(json::object());
+        });
+}
+
+// tools/call lookups by name on threads, while one tool is re-registered
+// every millisecond. The mutex registry is the baseline of the snapshot
+// registry at the same thread count.
+void AddRegistryCases(std::vector<TBenchCase> &cases)
+{
+    static std::vector<std::string> names;
+    for (int i = 0; i < 24; i++)
+        names.push_back("ui_tool_" + std::to_string(i));
+
+    static TMutexToolRegistry mutexRegistry;
+    static TMcpToolRegistry snapshotRegistry;
+    for (const std::string &name : names)
+    {
+        mutexRegistry.Register(MakeLookupTool(name));
+        snapshotRegistry.Register(MakeLookupTool(name));
+    }
+
+    // Each thread walks the names from its own position
+    static std::atomic<unsigned> nextStart{0};
+    auto lookups = [](auto lookup) {
+        return [lookup]() {
+            thread_local size_t position = nextStart.fetch_add(7);
+            const std::string &name = names[position++ % names.size()];
+            Expect(lookup(name) != nullptr, "registry lookup");
+        };
+    };
+
+    for (unsigned threads : {1u, 4u})
+    {
+        std::string suffix = "_" + std::to_string(threads) + (threads == 1 ? "_thread" : "_threads");
+        cases.push_back(TBenchCase{"registry/find_mutex" + suffix,
+            lookups([](const std::string &name) { return mutexRegistry.Get(name); }),
+            "", threads,
+            []() { mutexRegistry.Register(MakeLookupTool(names[3])); }});
+        cases.push_back(TBenchCase{"registry/find_snapshot" + suffix,
+            lookups([](const std::string &name) { return snapshotRegistry.Find(name).Tool; }),
+            "registry/find_mutex" + suffix, threads,
+            []() { snapshotRegistry.Register(MakeLookupTool(names[3])); }});
+    }
+}
+
+//---------------------------------------------------------------------------
+// Minimal ITransportRequest/Response for the transport helpers
+//---------------------------------------------------------------------------
+class TBenchRequest : public ITransportRequest
+{
+public:
+    std::map<std::string, std::string> Headers;
+
+    std::string GetMethod() const override { return "POST"; }
+    std::string GetPath() const override { return "/mcp"; }
+    std::string GetHeader(const std::string &name) const override
+    {
+        auto it = Headers.find(name);
+        return it != Headers.end() ? it->second : std::string();
+    }
+    std::string GetBody() const override { return std::string(); }
+};
+
+std::vector<TBenchCase> BuildCases()
+{
+    std::vector<TBenchCase> cases;
+
+    // Servers live for the whole run; the cases capture raw pointers
+    static std::unique_ptr<TMcpServer> server = Bench::CreateBenchServer();
+    static std::unique_ptr<TMcpServer> parallel = Bench::CreateBenchServer(4);
+    TMcpServer *s = server.get();
+    TMcpServer *p = parallel.get();
+
+    auto add = [&cases](std::string name, std::function<void()> run) {
+        cases.push_back(TBenchCase{std::move(name), std::move(run)});
+    };
+    auto serve = [&add](std::string name, TMcpServer *target, std::string request,
+                        bool expectResponse = true) {
+        Expect(target->HandleRequest(request).empty() != expectResponse, name.c_str());
+        add(std::move(name), [target, request]() {
+            std::string response = target->HandleRequest(request);
+            (void)response;
+        });
+    };
+
+    // Protocol
+    serve("single/ping", s, Request("1", "ping", ""));
+    serve("single/initialize", s, Request("1", "initialize",
+        "{\"protocolVersion\":\"2024-11-05\",\"capabilities\":{},"
+        "\"clientInfo\":{\"name\":\"bench\",\"version\":\"1\"}}"));
+    serve("single/tools_list", s, Request("1", "tools/list", ""));
+    serve("notification/initialized", s,
+        "{\"jsonrpc\":\"2.0\",\"method\":\"notifications/initialized\"}", false);
+
+    // Tool calls
+    serve("call/echo", s, ToolCall("1", "echo", "{\"text\":\"hello\"}"));
+    serve("call/events_10", s, ToolCall("1", "get_events", "{\"limit\":10}"));
+    serve("call/events_100_details", s,
+        ToolCall("1", "get_events", "{\"limit\":100,\"include_details\":true}"));
+    serve("call/status_cached", s, ToolCall("1", "get_status", "{}"));
+    serve("call/set_value", s, ToolCall("1", "set_value", "{\"value\":1}"));
+
+    // Argument validation on its own, against a whole call that includes it
+    serve("call/search_9_args", s, ToolCall("1", "search", Bench::SearchArgs()));
+    static const TMcpSchemaValidator searchValidator(Bench::SearchSchema().ToJson());
+    static const json searchArgs = json::parse(Bench::SearchArgs());
+    std::string validationError;
+    Expect(searchValidator.Validate(searchArgs, validationError), "search arguments");
+    add("validate/search_9_args", []() {
+        std::string error;
+        bool valid = searchValidator.Validate(searchArgs, error);
+        (void)valid;
+    });
+
+    // Resources
+    serve("resources/list", s, Request("1", "resources/list", ""));
+    serve("resources/read_events_20", s,
+        Request("1", "resources/read", "{\"uri\":\"bench://events\"}"));
+    serve("resources/read_event_details", s,
+        Request("1", "resources/read", "{\"uri\":\"bench://events/7\"}"));
+    add("resources/notify_unsubscribed", [s]() {
+        s->NotifyResourceUpdated("bench://events");
+    });
+
+    // Batches
+    std::string batch = "[";
+    for (int i = 0; i < 10; i++)
+    {
+        if (i)
+            batch += ',';
+        batch += (i % 2) ? ToolCall(std::to_string(i), "echo", "{\"text\":\"item\"}")
+                         : Request(std::to_string(i), "ping", "");
+    }
+    batch += "]";
+    // The batch path before dispatch stayed on json values, rebuilt on the
+    // public API: each element dumped and handled as text, each response
+    // parsed back into the array, the array serialized. (The old path also
+    // round-tripped every id through text, which this leaves out.)
+    add("batch/10_reparse", [s, batch]() {
+        json responses = json::array();
+        for (const json &element : json::parse(batch))
+        {
+            std::string response = s->HandleRequest(element.dump());
+            if (!response.empty())
+                responses.push_back(json::parse(response));
+        }
+        std::string out = responses.dump();
+        (void)out;
+    });
+    serve("batch/10_sequential", s, batch);
+    cases.back().Baseline = "batch/10_reparse";
+    serve("batch/10_parallel", p, batch);
+    cases.back().Baseline = "batch/10_reparse";
+
+    AddRegistryCases(cases);
+
+    // Errors
+    serve("error/parse", s, "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":");
+    serve("error/unknown_method", s, Request("1", "no/such/method", ""));
+    serve("error/unknown_tool", s, ToolCall("1", "no_such_tool", "{}"));
+    serve("error/invalid_params", s, ToolCall("1", "echo", "{\"text\":42}"));
+    serve("error/invalid_request", s, "{\"jsonrpc\":\"2.0\",\"id\":1}");
+
+    // HTTP helpers
+    std::string callBody = "{\"jsonrpc\":\"2.0\",\"id\":7,\"params\":"
+        "{\"name\":\"echo\",\"arguments\":{\"text\":\"hello\"}}}";
+    add("http/legacy_routing", [callBody]() {
+        std::string routed = McpHttpRouter::ApplyLegacyRouting("/mcp/tools/call", callBody);
+        (void)routed;
+    });
+
+    static CorsValidator cors{TCorsConfig()};
+    static TBenchRequest corsRequest;
+    corsRequest.Headers["Accept"] = "application/json, text/event-stream";
+    corsRequest.Headers["Origin"] = "http://localhost:5173";
+    add("http/cors_validate", []() {
+        TCorsResult result = cors.Validate(corsRequest, false);
+        (void)result;
+    });
+
+    // Wire codecs on a ui_get_events response (the JSON text the server emits)
+    struct TCodecInput
+    {
+        const char *Label;
+        int Count;
+        bool Details;
+    };
+    for (TCodecInput input : {TCodecInput{"events_20", 20, false},
+                              TCodecInput{"events_100_details", 100, true}})
+    {
+        std::string jsonText = Bench::MakeEventsResponse(input.Count, input.Details);
+        for (TWireFormat format : {TWireFormat::Cbor, TWireFormat::MsgPack})
+        {
+            const char *label = format == TWireFormat::Cbor ? "cbor" : "msgpack";
+            std::string encoded;
+            Expect(McpWireFormat::FromJsonText(format, jsonText, encoded), label);
+
+            std::fprintf(stderr, "# %s %s: json %zu bytes, %s %zu bytes (%.0f%%)\n",
+                input.Label, label,
+                jsonText.size(), label, encoded.size(), 100.0 * encoded.size() / jsonText.size());
+
+            add(std::string("codec/") + label + "_encode_" + input.Label,
+                [format, jsonText]() {
+                    std::string out;
+                    McpWireFormat::FromJsonText(format, jsonText, out);
+                });
+            add(std::string("codec/") + label + "_decode_" + input.Label,
+                [format, encoded]() {
+                    std::string out, error;
+                    McpWireFormat::ToJsonText(format, encoded, out, error);
+                });
+        }
+        add(std::string("codec/json_reparse_") + input.Label, [jsonText]() {
+            std::string out = json::parse(jsonText).dump();
+            (void)out;
+        });
+    }
+
+    // Response writer against json::dump on tool results: the content as
+    // JSON, then that JSON escaped as the text block of the response
+    struct TWriterInput
+    {
+        const char *Label;
+        json Content;
+    };
+    std::string russian;
+    for (int i = 0; i < 40; i++)
+        russian += "\xD0\xA7\xD0\xB8\xD1\x82\xD0\xB0\xD1\x8E src/module.cpp, "
+            "\xD1\x88\xD0\xB0\xD0\xB3 " + std::to_string(i) + ".\n";
+    for (TWriterInput input : {
+             TWriterInput{"events_20", json{{"events", Bench::MakeEvents(20, false)}}},
+             TWriterInput{"events_100_details", json{{"events", Bench::MakeEvents(100, true)}}},
+             TWriterInput{"text_ru", json(russian)}})
+    {
+        json content = input.Content;
+        Expect(content.dump(-1, ' ', false, json::error_handler_t::replace) ==
+            TMcpJsonWriter::ToString(content), input.Label);
+        add(std::string("writer/json_dump_") + input.Label, [content]() {
+            std::string out = content.dump(-1, ' ', false, json::error_handler_t::replace);
+            (void)out;
+        });
+        add(std::string("writer/write_") + input.Label, [content]() {
+            std::string out = TMcpJsonWriter::ToString(content);
+            (void)out;
+        });
+
+        std::string text = content.is_string() ? content.get<std::string>() : content.dump();
+        add(std::string("writer/json_escape_") + input.Label, [text]() {
+            std::string out = json(text).dump(-1, ' ', false, json::error_handler_t::replace);
+            (void)out;
+        });
+        add(std::string("writer/escape_") + input.Label, [text]() {
+            TMcpJsonWriter writer(text.size() + 64);
+            writer.String(text);
+        });
+    }
+
+    return cases;
+}
+
+} // namespace
+
+//---------------------------------------------------------------------------
+int main(int argc, char **argv)
+{
+    std::string filter;
+    std::chrono::milliseconds minTime(500);
+    bool jsonOutput = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--time") == 0 && i + 1 < argc)
+            minTime = std::chrono::milliseconds(std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--json") == 0)
+            jsonOutput = true;
+        else
+            filter = argv[i];
+    }
+
+    std::vector<TBenchCase> cases = BuildCases();
+    std::map<std::string, double> measured;    // ops/sec by case name
+
+    if (!jsonOutput)
+        std::printf("%-40s %14s %12s %10s %12s %9s\n",
+            "case", "ops/sec", "ns/op", "allocs/op", "bytes/op", "speedup");
+
+    for (const TBenchCase &bench : cases)
+    {
+        if (!filter.empty() && bench.Name.find(filter) == std::string::npos)
+            continue;
+
+        TBenchResult r = Measure(bench, minTime);
+        double opsPerSec = r.Ops / r.Seconds;
+        measured[bench.Name] = opsPerSec;
+
+        // Against the baseline case, when it ran before this one
+        auto baseline = measured.find(bench.Baseline);
+        double speedup = baseline != measured.end() ? opsPerSec / baseline->second : 0;
+        if (jsonOutput)
+        {
+            std::printf("{\"case\":\"%s\",\"opsPerSec\":%.0f,\"nsPerOp\":%.1f,"
+                "\"allocsPerOp\":%.2f,\"bytesPerOp\":%.0f",
+                bench.Name.c_str(), opsPerSec, 1e9 / opsPerSec, r.AllocsPerOp, r.BytesPerOp);
+            if (speedup > 0)
+                std::printf(",\"baseline\":\"%s\",\"speedup\":%.2f",
+                    bench.Baseline.c_str(), speedup);
+            std::printf("}\n");
+        }
+        else
+        {
+            char vs[16] = "";
+            if (speedup > 0)
+                std::snprintf(vs, sizeof(vs), "%.2fx", speedup);
+            std::printf("%-40s %14.0f %12.1f %10.2f %12.0f %9s\n",
+                bench.Name.c_str(), opsPerSec, 1e9 / opsPerSec, r.AllocsPerOp, r.BytesPerOp, vs);
+        }
+        std::fflush(stdout);
+    }
+    return 0;
+}
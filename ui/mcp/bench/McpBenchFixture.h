@@ -0,0 +1,212 @@
+//---------------------------------------------------------------------------
+// McpBenchFixture.h — Server and payloads shared by the bench and fuzz targets
+//
+// Mirrors the shapes ClaBot's UI tools produce (ui_get_events,
+// ui_get_status) without any VCL: the tools answer from in-memory data.
+//---------------------------------------------------------------------------
+
+#ifndef McpBenchFixtureH
+#define McpBenchFixtureH
+
+//---------------------------------------------------------------------------
+#include "../McpServer.h"
+#include "../McpTypedArgs.h"
+#include <memory>
+#include <string>
+
+namespace Mcp { namespace Bench {
+
+struct TBenchEventsArgs
+{
+    int Limit = 100;
+    int Offset = 0;
+    bool IncludeDetails = false;
+
+    static constexpr auto Fields()
+    {
+        return std::make_tuple(
+            McpArg("limit", &TBenchEventsArgs::Limit, "Maximum number of events to return"),
+            McpArg("offset", &TBenchEventsArgs::Offset, "Skip first N events"),
+            McpArg("include_details", &TBenchEventsArgs::IncludeDetails,
+                "Include full tool input/output"));
+    }
+};
+
+// An event list as ui_get_events returns it
+inline json MakeEvents(int count, bool includeDetails)
+{
+    json events = json::array();
+    for (int i = 0; i < count; i++)
+    {
+        json event = {
+            {"time", "12:34:" + std::to_string(10 + i % 50)},
+            {"type", i % 3 == 0 ? "tool_use" : (i % 3 == 1 ? "assistant" : "result")},
+            {"data", "Agent step " + std::to_string(i) + ": reading src/module_" +
+                std::to_string(i % 7) + ".cpp and summarising the \"interesting\" parts"}
+        };
+        if (includeDetails)
+        {
+            event["toolInput"] = "{\"path\":\"src/module_" + std::to_string(i % 7) + ".cpp\"}";
+            event["toolOutput"] = std::string(200, 'x');
+            event["toolUseId"] = "toolu_" + std::to_string(100000 + i);
+            event["requestId"] = "req_" + std::to_string(i / 4);
+            event["durationMs"] = 15 + i % 40;
+        }
+        events.push_back(std::move(event));
+    }
+    return events;
+}
+
+// ui_get_events response for count events, as the server sends it
+inline std::string MakeEventsResponse(int count, bool includeDetails)
+{
+    json result;
+    result["structuredContent"] = {{"events", MakeEvents(count, includeDetails)},
+                                   {"total", count}};
+    result["content"] = json::array();
+    json response = {{"jsonrpc", "2.0"}, {"id", 1}};
+    response["result"] = std::move(result);
+    return response.dump();
+}
+
+// Input schema of the search tool: as wide as ClaBot's largest tools,
+// so validation costs what it does for them
+inline TMcpToolSchema SearchSchema()
+{
+    return TMcpToolSchema()
+        .AddString("query", "Text to look for", true)
+        .AddEnum("mode", "How query matches", {"exact", "prefix", "substring", "regex"}, true)
+        .AddEnum("scope", "Where to look",
+            {"events", "files", "tools", "results", "errors", "all"}, true)
+        .AddInteger("limit", "Maximum matches")
+        .AddInteger("offset", "Skip first N matches")
+        .AddBoolean("case_sensitive", "Match case")
+        .AddBoolean("include_details", "Include full tool input/output")
+        .AddString("path", "Only files under this path")
+        .AddString("since", "Only events after this time");
+}
+
+// Arguments for every search property, and one the schema does not list
+inline const char* SearchArgs()
+{
+    return "{\"query\":\"module\",\"mode\":\"substring\",\"scope\":\"events\","
+        "\"limit\":20,\"offset\":0,\"case_sensitive\":false,\"include_details\":true,"
+        "\"path\":\"src/\",\"since\":\"12:00:00\",\"trace\":\"bench\"}";
+}
+
+//---------------------------------------------------------------------------
+// Server with the tool set the benchmarks and the fuzzer drive:
+//   echo         - returns its "text" argument
+//   get_events   - typed arguments, 200 events held in memory
+//   get_status   - read-only and cached (like ui_get_status)
+//   set_value    - changes state (invalidates the cache)
+//   progress     - sends "steps" progress notifications, then returns
+//   search       - nine arguments with enums (SearchSchema), a fixed answer
+// and the resources bench://events (20 events, ?offset=N&limit=M) and
+// bench://events/{index}
+//---------------------------------------------------------------------------
+inline std::unique_ptr<TMcpServer> CreateBenchServer(unsigned batchConcurrency = 0)
+{
+    auto server = std::make_unique<TMcpServer>("mcp-bench", "1.0.0");
+    server->SetToolOutputFormat(TMcpToolOutputFormat::Structured);
+    if (batchConcurrency > 0)
+        server->SetBatchConcurrency(batchConcurrency);
+
+    server->RegisterLambda("echo", "Return the text argument",
+        TMcpToolSchema().AddString("text", "Text to return", true),
+        [](const json &args, TMcpToolContext &ctx) -> TMcpToolResult {
+            return TMcpToolResult::Success(json{{"text", args.value("text", std::string())}});
+        });
+
+    auto events = std::make_shared<const json>(MakeEvents(200, true));
+    RegisterTypedTool<TBenchEventsArgs>(*server, "get_events", "Return stored events",
+        [events](const TBenchEventsArgs &args, TMcpToolContext &ctx) -> TMcpToolResult {
+            json list = json::array();
+            int end = args.Limit > 0 ? args.Offset + args.Limit : static_cast<int>(events->size());
+            for (int i = std::max(args.Offset, 0);
+                 i < end && i < static_cast<int>(events->size()); i++)
+            {
+                const json &event = (*events)[i];
+                if (args.IncludeDetails)
+                {
+                    list.push_back(event);
+                    continue;
+                }
+                list.push_back({{"time", event["time"]}, {"type", event["type"]},
+                                {"data", event["data"]}});
+            }
+            json result;
+            result["events"] = std::move(list);
+            result["total"] = events->size();
+            return TMcpToolResult::Success(result);
+        });
+
+    auto value = std::make_shared<std::atomic<int>>(0);
+    server->RegisterLambda("get_status", "Return the current status",
+        TMcpToolSchema(),
+        [value](const json &args, TMcpToolContext &ctx) -> TMcpToolResult {
+            return TMcpToolResult::Success(json{{"connected", true},
+                {"agentId", "agent-42"}, {"eventsCount", 200}, {"value", value->load()}});
+        });
+    server->EnableResultCache("get_status", std::chrono::milliseconds(250));
+
+    TMcpToolAnnotations write;
+    write.ReadOnlyHint = false;
+    server->RegisterLambda("set_value", "Change the status value",
+        TMcpToolSchema().AddInteger("value", "New value", true), write,
+        [value](const json &args, TMcpToolContext &ctx) -> TMcpToolResult {
+            value->store(args.value("value", 0));
+            return TMcpToolResult::Success(json{{"ok", true}});
+        });
+
+    server->RegisterLambda("progress", "Report progress, then return",
+        TMcpToolSchema().AddInteger("steps", "Progress notifications (at most 100)", true),
+        [](const json &args, TMcpToolContext &ctx) -> TMcpToolResult {
+            int steps = std::min(std::max(args.value("steps", 0), 0), 100);
+            for (int i = 1; i <= steps; i++)
+                ctx.ReportProgress(i, steps);
+            return TMcpToolResult::Success(json{{"steps", steps}});
+        });
+
+    server->RegisterLambda("search", "Search events and files",
+        SearchSchema(),
+        [](const json &args, TMcpToolContext &ctx) -> TMcpToolResult {
+            return TMcpToolResult::Success(json{{"matches", 0}});
+        });
+
+    TMcpResource eventLog;
+    eventLog.Uri = "bench://events";
+    eventLog.Name = "Event log";
+    server->AddResource(eventLog,
+        [events](const std::string &uri, TMcpResourceContents &contents) {
+            json list = json::array();
+            for (int i = 0; i < 20; i++)
+                list.push_back({{"time", (*events)[i]["time"]}, {"type", (*events)[i]["type"]},
+                                {"data", (*events)[i]["data"]}});
+            contents.Text = json{{"events", std::move(list)}, {"total", events->size()}}.dump();
+            return true;
+        });
+
+    TMcpResourceTemplate eventDetails;
+    eventDetails.UriTemplate = "bench://events/{index}";
+    eventDetails.Name = "Event details";
+    server->AddResourceTemplate(eventDetails, "bench://events/",
+        [events](const std::string &uri, TMcpResourceContents &contents) {
+            std::string index = uri.substr(std::string("bench://events/").size());
+            if (index.empty() || index.size() > 3 ||
+                index.find_first_not_of("0123456789") != std::string::npos)
+                return false;
+            size_t i = std::stoul(index);
+            if (i >= events->size())
+                return false;
+            contents.Text = (*events)[i].dump();
+            return true;
+        });
+
+    return server;
+}
+
+}} // namespace Mcp::Bench
+
+//---------------------------------------------------------------------------
+#endif // McpBenchFixtureH
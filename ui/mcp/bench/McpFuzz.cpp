@@ -0,0 +1,282 @@
+//---------------------------------------------------------------------------
+// McpFuzz.cpp — libFuzzer target for malformed JSON-RPC and MCP bodies
+//
+// Each input is fed to TMcpServer::HandleRequest, the legacy HTTP router,
+// the CBOR/MessagePack decoders, the HTTP request parser and the stdio and
+// Unix socket framers. Crashes, sanitizer reports and these invariants are
+// failures:
+//   - a response is empty (no reply due) or a single valid JSON value
+//   - a body that is not valid JSON gets a -32700 parse error, whatever
+//     the scanner had read before the error
+//   - a decoded binary body is valid JSON text
+//   - a parsed HTTP request lies within the input, its body at the end
+//   - a framer yields the same messages however the input is split
+//
+//   clang++ -fsanitize=fuzzer,address,undefined ... McpFuzz.cpp  (see build.sh)
+//   ./mcp_fuzz -max_len=4096 corpus/
+//
+// Built with MCP_FUZZ_STANDALONE (no libFuzzer, e.g. with g++), main()
+// runs the given files, or a seeded mutation loop when there are none.
+//---------------------------------------------------------------------------
+
+#include "McpBenchFixture.h"
+#include "../transport/http/McpHttpRouter.h"
+#include "../transport/http/McpWireFormat.h"
+#include "../transport/epoll/HttpRequestParser.h"
+#include "../transport/local/McpMessageFraming.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+using namespace Mcp;
+using namespace Mcp::Transport;
+
+void Check(bool condition, const char *what, const std::string &input)
+{
+    if (condition)
+        return;
+    std::fprintf(stderr, "invariant failed: %s\ninput (%zu bytes): %.*s\n",
+        what, input.size(), static_cast<int>(input.size() < 512 ? input.size() : 512),
+        input.c_str());
+    std::abort();
+}
+
+void CheckResponse(const std::string &response, const std::string &input)
+{
+    if (!json::accept(input))
+    {
+        json parsed = json::parse(response, nullptr, false);
+        Check(parsed.is_object() && parsed.contains("error") &&
+            parsed["error"].value("code", 0) == -32700,
+            "malformed JSON not answered with a parse error", input);
+        return;
+    }
+    if (response.empty())
+        return;
+    Check(json::accept(response), "response is not valid JSON", input);
+}
+
+bool Within(std::string_view part, const std::string &input)
+{
+    return part.empty() || (part.data() >= input.data() &&
+        part.data() + part.size() <= input.data() + input.size());
+}
+
+void CheckHttpParse(const std::string &input)
+{
+    THttpParseLimits limits;
+    limits.MaxHeaderBytes = 1024;
+    limits.MaxBodyBytes = 4096;
+    THttpRequestHead head;
+    int errorStatus = 0;
+    if (HttpRequestParser::Parse(input.data(), input.size(), limits, head, errorStatus) !=
+        THttpParseStatus::Complete)
+        return;
+
+    Check(head.Length <= input.size(), "request longer than the input", input);
+    Check(head.Body.size() <= limits.MaxBodyBytes, "body over the limit", input);
+    Check(head.Body.data() + head.Body.size() == input.data() + head.Length,
+        "body does not end the request", input);
+    Check(Within(head.Method, input) && Within(head.Target, input) && Within(head.Path, input),
+        "request line outside the input", input);
+    for (size_t i = 0; i < head.HeaderCount; i++)
+    {
+        Check(Within(head.Headers[i].Name, input) && Within(head.Headers[i].Value, input),
+            "header outside the input", input);
+    }
+}
+
+// Messages and size errors, in order, with the input appended in pieces
+// of pieceBytes. A length-prefixed stream ends at its first size error.
+template <class TFramer>
+std::vector<std::string> Frames(const std::string &input, size_t pieceBytes, bool endOnError)
+{
+    TFramer framer(64);
+    std::vector<std::string> frames;
+    for (size_t pos = 0; pos < input.size(); pos += pieceBytes)
+    {
+        framer.Append(input.data() + pos, std::min(pieceBytes, input.size() - pos));
+        std::string message;
+        TFrameStatus status;
+        while ((status = framer.Next(message)) != TFrameStatus::NeedMore)
+        {
+            if (status == TFrameStatus::TooLarge)
+            {
+                frames.push_back("<too large>");
+                if (endOnError)
+                    return frames;
+            }
+            else
+            {
+                frames.push_back(message);
+            }
+        }
+    }
+    return frames;
+}
+
+void CheckFraming(const std::string &input)
+{
+    std::vector<std::string> lines = Frames<McpLineFramer>(input, input.size() + 1, false);
+    Check(Frames<McpLineFramer>(input, 1, false) == lines, "line framing depends on the split", input);
+    for (const std::string &line : lines)
+        Check(line.size() <= 64 && line.find('\n') == std::string::npos, "bad line", input);
+
+    Check(Frames<McpLengthFramer>(input, 3, true) ==
+        Frames<McpLengthFramer>(input, input.size() + 1, true),
+        "length framing depends on the split", input);
+}
+
+TMcpServer& Server()
+{
+    static std::unique_ptr<TMcpServer> server = Bench::CreateBenchServer(2);
+    return *server;
+}
+
+} // namespace
+
+//---------------------------------------------------------------------------
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    std::string input(reinterpret_cast<const char*>(data), size);
+
+    CheckHttpParse(input);
+    CheckFraming(input);
+    CheckResponse(Server().HandleRequest(input), input);
+
+    for (const char *path : {"/mcp", "/mcp/initialize", "/mcp/tools/list", "/mcp/tools/call"})
+    {
+        std::string routed = McpHttpRouter::ApplyLegacyRouting(path, input);
+        CheckResponse(Server().HandleRequest(routed), routed);
+    }
+
+    for (TWireFormat format : {TWireFormat::Cbor, TWireFormat::MsgPack})
+    {
+        std::string jsonText, error;
+        if (!McpWireFormat::ToJsonText(format, input, jsonText, error))
+            continue;
+        Check(json::accept(jsonText), "decoded body is not valid JSON", input);
+        CheckResponse(Server().HandleRequest(jsonText), jsonText);
+    }
+    return 0;
+}
+
+//---------------------------------------------------------------------------
+#ifdef MCP_FUZZ_STANDALONE
+
+namespace {
+
+const char* const Seeds[] = {
+    R"({"jsonrpc":"2.0","id":1,"method":"ping"})",
+    R"({"jsonrpc":"2.0","id":"a","method":"tools/list"})",
+    R"({"jsonrpc":"2.0","id":2,"method":"tools/call","params":{"name":"echo","arguments":{"text":"hi"}}})",
+    R"({"jsonrpc":"2.0","id":3,"method":"tools/call","params":{"name":"get_events","arguments":{"limit":5,"offset":2,"include_details":true}}})",
+    R"({"jsonrpc":"2.0","id":4,"method":"tools/call","params":{"name":"get_status","_meta":{"timeoutMs":50,"progressToken":"p"}}})",
+    R"([{"jsonrpc":"2.0","id":5,"method":"ping"},{"jsonrpc":"2.0","method":"notifications/initialized"},{"jsonrpc":"2.0","id":6,"method":"tools/call","params":{"name":"set_value","arguments":{"value":3}}}])",
+    R"({"jsonrpc":"2.0","method":"notifications/cancelled","params":{"requestId":2,"reason":"x"}})",
+    R"({"jsonrpc":"2.0","id":7,"method":"initialize","params":{"protocolVersion":"2024-11-05","capabilities":{}}})",
+    R"({"id":8,"params":{"name":"echo","arguments":{"text":"é😀"}}})",
+    R"({"jsonrpc":"2.0","id":9,"method":"resources/read","params":{"uri":"bench://events/12"}})",
+    R"({"jsonrpc":"2.0","id":10,"method":"resources/read","params":{"uri":"bench://events?offset=3"}})",
+    R"({"jsonrpc":"2.0","id":11,"method":"resources/unsubscribe","params":{"uri":"bench://events"}})",
+};
+
+const char* const HttpSeeds[] = {
+    "POST /mcp HTTP/1.1\r\nHost: x\r\nAccept: application/json\r\nContent-Length: 40\r\n\r\n"
+        "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"ping\"}",
+    "OPTIONS /mcp HTTP/1.1\r\nOrigin: http://localhost\r\n\r\n"
+        "GET /mcp?x=1 HTTP/1.0\r\nConnection: keep-alive\r\n\r\n",
+    "\r\nPOST /mcp/tools/call HTTP/1.1\r\nExpect: 100-continue\r\nContent-Length: 2\r\n\r\n{}",
+};
+
+template<size_t N>
+std::string Mutate(std::string input, std::mt19937 &rng, const char* const (&seeds)[N])
+{
+    static const char Tokens[] = "{}[]\",:0123456789.eE+-\\ntrufalsu\x00\xff\xc3\r\n";
+    int edits = 1 + static_cast<int>(rng() % 4);
+    for (int i = 0; i < edits; i++)
+    {
+        size_t pos = input.empty() ? 0 : rng() % (input.size() + 1);
+        switch (rng() % 4)
+        {
+        case 0:
+            if (pos < input.size())
+                input.erase(pos, 1 + rng() % 8);
+            break;
+        case 1:
+            input.insert(pos, 1, Tokens[rng() % (sizeof(Tokens) - 1)]);
+            break;
+        case 2:
+            if (pos < input.size())
+                input[pos] = static_cast<char>(rng());
+            break;
+        default:
+        {
+            const std::string other = seeds[rng() % N];
+            size_t from = rng() % (other.size() + 1);
+            input.insert(pos, other.substr(from, rng() % 32));
+            break;
+        }
+        }
+    }
+    return input;
+}
+
+void RunOne(const std::string &input)
+{
+    LLVMFuzzerTestOneInput(reinterpret_cast<const uint8_t*>(input.data()), input.size());
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    if (argc > 1)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            std::ifstream file(argv[i], std::ios::binary);
+            RunOne(std::string(std::istreambuf_iterator<char>(file), {}));
+        }
+        std::printf("ran %d inputs\n", argc - 1);
+        return 0;
+    }
+
+    const int iterations = 200000;
+    std::mt19937 rng(12345);
+    for (const char *seed : HttpSeeds)
+        RunOne(seed);
+    for (const char *seed : Seeds)
+    {
+        RunOne(seed);
+
+        // The same request in binary encodings
+        json parsed = json::parse(seed);
+        std::string cbor, msgpack;
+        json::to_cbor(parsed, cbor);
+        json::to_msgpack(parsed, msgpack);
+        RunOne(cbor);
+        RunOne(msgpack);
+    }
+    for (int i = 0; i < iterations; i++)
+    {
+        // One in eight starts from an HTTP request instead of a body
+        if (i % 8 == 0)
+            RunOne(Mutate(HttpSeeds[rng() % std::size(HttpSeeds)], rng, HttpSeeds));
+        else
+            RunOne(Mutate(Seeds[rng() % std::size(Seeds)], rng, Seeds));
+    }
+    std::printf("ran %d mutated inputs\n", iterations);
+    return 0;
+}
+
+#endif // MCP_FUZZ_STANDALONE
@@ -0,0 +1,313 @@
+//---------------------------------------------------------------------------
+// McpHttpLoad.cpp — HTTP load test for EpollHttpTransport (Linux)
+//
+// Serves the bench server (McpBenchFixture.h) over EpollHttpTransport on a
+// free local port and drives it with keep-alive client connections, one
+// thread each, optionally pipelining several requests per round trip.
+// Reports requests/sec and round-trip latency percentiles. Every response
+// must be "200 OK" with a body, or the run fails. "progress" requests ask
+// for 10 progress notifications, so each answer is a chunked event stream
+// ending with the result.
+//
+//   ./mcp_http_load                       4 connections, 2 s, echo
+//   ./mcp_http_load --connections 32      client connections
+//   ./mcp_http_load --depth 8             requests pipelined per round trip
+//   ./mcp_http_load --workers 0           handlers on the event loop thread
+//   ./mcp_http_load --request events      echo | events | status | ping | progress
+//   ./mcp_http_load --time 5000           milliseconds
+//   ./mcp_http_load --serve 8080          serve until stdin closes (for
+//                                         wrk, hey, curl or an MCP client)
+//---------------------------------------------------------------------------
+
+#include "McpBenchFixture.h"
+#include "../transport/epoll/EpollHttpTransport.h"
+#include "../transport/http/McpSse.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace Mcp;
+using namespace Mcp::Transport;
+using TClock = std::chrono::steady_clock;
+
+struct TClientResult
+{
+    uint64_t Requests = 0;
+    uint64_t Failures = 0;
+    std::vector<double> RoundTripsUs;
+};
+
+std::string JsonRpcBody(const std::string &request)
+{
+    if (request == "ping")
+        return "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"ping\"}";
+    if (request == "status")
+        return "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"tools/call\","
+            "\"params\":{\"name\":\"get_status\",\"arguments\":{}}}";
+    if (request == "progress")
+        return "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"tools/call\","
+            "\"params\":{\"name\":\"progress\",\"arguments\":{\"steps\":10},"
+            "\"_meta\":{\"progressToken\":\"load\"}}}";
+    if (request == "events")
+        return "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"tools/call\","
+            "\"params\":{\"name\":\"get_events\",\"arguments\":{\"limit\":20}}}";
+    return "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"tools/call\","
+        "\"params\":{\"name\":\"echo\",\"arguments\":{\"text\":\"hello\"}}}";
+}
+
+std::string MakeHttpRequest(const std::string &body)
+{
+    return "POST /mcp HTTP/1.1\r\nHost: 127.0.0.1\r\n"
+        "Content-Type: application/json\r\n"
+        "Accept: application/json, text/event-stream\r\n"
+        "Content-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body;
+}
+
+int Connect(int port)
+{
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<uint16_t>(port));
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (fd < 0 || connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0)
+    {
+        std::perror("connect");
+        std::exit(2);
+    }
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return fd;
+}
+
+// Size of the chunked body at the start of data (0 while incomplete);
+// bodyBytes gets the payload size
+size_t ChunkedLength(const std::string &data, size_t start, size_t &bodyBytes)
+{
+    size_t pos = start;
+    bodyBytes = 0;
+    while (true)
+    {
+        size_t lineEnd = data.find("\r\n", pos);
+        if (lineEnd == std::string::npos)
+            return 0;
+        size_t size = std::strtoul(data.c_str() + pos, nullptr, 16);
+        pos = lineEnd + 2 + size + 2;
+        if (pos > data.size())
+            return 0;
+        if (size == 0)
+            return pos - start;
+        bodyBytes += size;
+    }
+}
+
+// Reads count responses; false on a closed connection or non-200 status
+bool ReadResponses(int fd, std::string &buffer, int count)
+{
+    while (count > 0)
+    {
+        size_t headEnd = buffer.find("\r\n\r\n");
+        if (headEnd != std::string::npos)
+        {
+            size_t bodyBytes = 0;
+            size_t total = 0;               // whole response; 0 while incomplete
+            size_t lengthPos = buffer.find("Content-Length: ");
+            if (lengthPos != std::string::npos && lengthPos < headEnd)
+            {
+                bodyBytes = std::strtoul(buffer.c_str() + lengthPos + 16, nullptr, 10);
+                if (buffer.size() >= headEnd + 4 + bodyBytes)
+                    total = headEnd + 4 + bodyBytes;
+            }
+            else if (buffer.find("Transfer-Encoding: chunked") < headEnd)
+            {
+                size_t length = ChunkedLength(buffer, headEnd + 4, bodyBytes);
+                if (length > 0)
+                    total = headEnd + 4 + length;
+            }
+            else
+            {
+                return false;
+            }
+
+            if (total > 0)
+            {
+                if (buffer.compare(0, 13, "HTTP/1.1 200 ") != 0 || bodyBytes == 0)
+                    return false;
+                buffer.erase(0, total);
+                count--;
+                continue;
+            }
+        }
+
+        char chunk[65536];
+        ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0)
+            return false;
+        buffer.append(chunk, static_cast<size_t>(n));
+    }
+    return true;
+}
+
+void RunClient(int port, const std::string &request, int depth,
+    const std::atomic<bool> &stop, TClientResult &result)
+{
+    int fd = Connect(port);
+    std::string batch;
+    for (int i = 0; i < depth; i++)
+        batch += request;
+
+    std::string buffer;
+    while (!stop.load(std::memory_order_relaxed))
+    {
+        TClock::time_point start = TClock::now();
+        if (send(fd, batch.data(), batch.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(batch.size()) ||
+            !ReadResponses(fd, buffer, depth))
+        {
+            result.Failures++;
+            close(fd);
+            fd = Connect(port);
+            buffer.clear();
+            continue;
+        }
+        result.RoundTripsUs.push_back(
+            std::chrono::duration<double, std::micro>(TClock::now() - start).count());
+        result.Requests += static_cast<uint64_t>(depth);
+    }
+    close(fd);
+}
+
+double Percentile(std::vector<double> &values, double p)
+{
+    if (values.empty())
+        return 0;
+    size_t index = static_cast<size_t>(p * (values.size() - 1));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+} // namespace
+
+//---------------------------------------------------------------------------
+int main(int argc, char **argv)
+{
+    int connections = 4;
+    int depth = 1;
+    int servePort = -1;
+    std::string request = "echo";
+    std::chrono::milliseconds duration(2000);
+    TEpollHttpConfig config;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--connections" && hasValue)
+            connections = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--depth" && hasValue)
+            depth = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--workers" && hasValue)
+            config.WorkerThreads = static_cast<unsigned>(std::atoi(argv[++i]));
+        else if (arg == "--request" && hasValue)
+            request = argv[++i];
+        else if (arg == "--time" && hasValue)
+            duration = std::chrono::milliseconds(std::atoi(argv[++i]));
+        else if (arg == "--serve" && hasValue)
+            servePort = std::atoi(argv[++i]);
+    }
+
+    std::unique_ptr<TMcpServer> server = Bench::CreateBenchServer(2);
+    if (servePort >= 0)
+        config.Port = servePort;
+    EpollHttpTransport transport(config);
+    // Workers only start calls; each is answered when it completes
+    transport.SetAsyncRequestHandler(
+        [&server](ITransportRequest &req, ITransportResponse &resp, TMcpRequestDone done) {
+            auto out = std::make_shared<McpSseResponse>(req, resp);
+            server->HandleRequestAsync(req.GetBody(),
+                [out, done](const std::string &result) {
+                    out->Finish(result);
+                    done();
+                },
+                [out](const std::string &notification) { out->SendNotification(notification); },
+                req.GetHeader("Mcp-Session-Id"));
+        });
+    server->SetOnNotification([&transport](const std::string &notification) {
+        transport.SendNotification(notification);
+    });
+    server->SetOnSessionNotification(
+        [&transport](const std::string &session, const std::string &notification) {
+            transport.SendNotificationTo(session, notification);
+        });
+    transport.SetSessionEndHandler([&server](const std::string &session) {
+        server->EndSession(session);
+    });
+    transport.Start();
+
+    if (servePort >= 0)
+    {
+        std::printf("serving http://127.0.0.1:%d/mcp (%u workers); close stdin to stop\n",
+            transport.GetPort(), config.WorkerThreads);
+        std::fflush(stdout);
+        std::string line;
+        while (std::getline(std::cin, line))
+            ;
+        transport.Stop();
+        return 0;
+    }
+
+    std::string httpRequest = MakeHttpRequest(JsonRpcBody(request));
+    std::atomic<bool> stop{false};
+    std::vector<TClientResult> results(static_cast<size_t>(connections));
+    std::vector<std::thread> clients;
+    TClock::time_point start = TClock::now();
+    for (int c = 0; c < connections; c++)
+    {
+        clients.emplace_back([&, c]() {
+            RunClient(transport.GetPort(), httpRequest, depth, stop, results[c]);
+        });
+    }
+    std::this_thread::sleep_for(duration);
+    stop = true;
+    for (std::thread &client : clients)
+        client.join();
+    double seconds = std::chrono::duration<double>(TClock::now() - start).count();
+    transport.Stop();
+
+    uint64_t requests = 0;
+    uint64_t failures = 0;
+    std::vector<double> roundTrips;
+    for (TClientResult &r : results)
+    {
+        requests += r.Requests;
+        failures += r.Failures;
+        roundTrips.insert(roundTrips.end(), r.RoundTripsUs.begin(), r.RoundTripsUs.end());
+    }
+
+    std::printf("request %s, %d connections, depth %d, %u workers\n",
+        request.c_str(), connections, depth, config.WorkerThreads);
+    std::printf("%-14s %12s %10s %10s %10s %10s\n",
+        "requests/sec", "requests", "p50 us", "p99 us", "max us", "failures");
+    double maxUs = roundTrips.empty() ? 0 : *std::max_element(roundTrips.begin(), roundTrips.end());
+    std::printf("%-14.0f %12llu %10.1f %10.1f %10.1f %10llu\n",
+        requests / seconds, static_cast<unsigned long long>(requests),
+        Percentile(roundTrips, 0.50), Percentile(roundTrips, 0.99), maxUs,
+        static_cast<unsigned long long>(failures));
+    std::printf("hardware threads: %u\n", std::thread::hardware_concurrency());
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,380 @@
+//---------------------------------------------------------------------------
+// McpIpcLatency.cpp — Round-trip latency of the MCP transports (Linux)
+//
+// One client sends requests one at a time and waits for each answer, so
+// the numbers are per-request latency, not throughput under load. Every
+// path drives the same bench server (McpBenchFixture.h) through the same
+// request handler:
+//
+//   direct   TMcpServer::HandleRequest in-process (no transport)
+//   stdio    StdioTransport over a pair of pipes, one message per line
+//   unix     UnixSocketTransport, length-prefixed frames
+//   http     EpollHttpTransport on 127.0.0.1, keep-alive POST /mcp
+//            (HTTP parsing, headers, CORS checks, as the Indy path does)
+//
+//   ./mcp_ipc_latency                     20000 echo requests per path
+//   ./mcp_ipc_latency --count 100000
+//   ./mcp_ipc_latency --request status    echo | events | status | ping
+//   ./mcp_ipc_latency --workers 0         handlers on the reader thread
+//---------------------------------------------------------------------------
+
+#include "McpBenchFixture.h"
+#include "../transport/epoll/EpollHttpTransport.h"
+#include "../transport/http/McpSse.h"
+#include "../transport/local/McpMessageFraming.h"
+#include "../transport/local/StdioTransport.h"
+#include "../transport/local/UnixSocketTransport.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace Mcp;
+using namespace Mcp::Transport;
+using TClock = std::chrono::steady_clock;
+
+// Sends one request and returns the reply; empty on failure
+using TRoundTrip = std::function<std::string(const std::string &body)>;
+
+std::string JsonRpcBody(const std::string &request)
+{
+    if (request == "ping")
+        return "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"ping\"}";
+    if (request == "status")
+        return "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"tools/call\","
+            "\"params\":{\"name\":\"get_status\",\"arguments\":{}}}";
+    if (request == "events")
+        return "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"tools/call\","
+            "\"params\":{\"name\":\"get_events\",\"arguments\":{\"limit\":20}}}";
+    return "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"tools/call\","
+        "\"params\":{\"name\":\"echo\",\"arguments\":{\"text\":\"hello\"}}}";
+}
+
+bool SendAll(int fd, const std::string &data)
+{
+    size_t sent = 0;
+    while (sent < data.size())
+    {
+        ssize_t n = write(fd, data.data() + sent, data.size() - sent);
+        if (n <= 0)
+            return false;
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool ReadMore(int fd, std::string &buffer)
+{
+    char chunk[65536];
+    ssize_t n = read(fd, chunk, sizeof(chunk));
+    if (n <= 0)
+        return false;
+    buffer.append(chunk, static_cast<size_t>(n));
+    return true;
+}
+
+// The same handler the UI installs on its HTTP transport
+TMcpRequestHandler MakeHandler(TMcpServer &server)
+{
+    return [&server](ITransportRequest &req, ITransportResponse &resp) {
+        auto out = std::make_shared<McpSseResponse>(req, resp);
+        server.HandleRequestAsync(req.GetBody(),
+            [out](const std::string &result) { out->Finish(result); },
+            [out](const std::string &notification) { out->SendNotification(notification); },
+            req.GetHeader("Mcp-Session-Id"));
+        out->Wait();
+    };
+}
+
+struct TPathResult
+{
+    std::string Name;
+    uint64_t Failures = 0;
+    double Seconds = 0;
+    std::vector<double> LatenciesUs;
+};
+
+double Percentile(std::vector<double> &values, double p)
+{
+    if (values.empty())
+        return 0;
+    size_t index = static_cast<size_t>(p * (values.size() - 1));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+TPathResult Measure(const std::string &name, const TRoundTrip &roundTrip,
+    const std::string &body, int count)
+{
+    TPathResult result;
+    result.Name = name;
+    for (int i = 0; i < count / 10; i++)        // warm-up
+        roundTrip(body);
+
+    result.LatenciesUs.reserve(static_cast<size_t>(count));
+    TClock::time_point start = TClock::now();
+    for (int i = 0; i < count; i++)
+    {
+        TClock::time_point sent = TClock::now();
+        std::string reply = roundTrip(body);
+        result.LatenciesUs.push_back(
+            std::chrono::duration<double, std::micro>(TClock::now() - sent).count());
+        if (reply.find("\"result\"") == std::string::npos)
+            result.Failures++;
+    }
+    result.Seconds = std::chrono::duration<double>(TClock::now() - start).count();
+    return result;
+}
+
+//---------------------------------------------------------------------------
+// Clients
+//---------------------------------------------------------------------------
+class TStdioClient
+{
+public:
+    int ToServer[2] = {-1, -1};
+    int FromServer[2] = {-1, -1};
+
+    TStdioClient()
+    {
+        if (pipe(ToServer) < 0 || pipe(FromServer) < 0)
+        {
+            std::perror("pipe");
+            std::exit(2);
+        }
+    }
+
+    ~TStdioClient()
+    {
+        for (int fd : {ToServer[0], ToServer[1], FromServer[0], FromServer[1]})
+            close(fd);
+    }
+
+    std::string RoundTrip(const std::string &body)
+    {
+        if (!SendAll(ToServer[1], body + "\n"))
+            return std::string();
+        size_t end;
+        while ((end = FBuffer.find('\n')) == std::string::npos)
+        {
+            if (!ReadMore(FromServer[0], FBuffer))
+                return std::string();
+        }
+        std::string reply = FBuffer.substr(0, end);
+        FBuffer.erase(0, end + 1);
+        return reply;
+    }
+
+private:
+    std::string FBuffer;
+};
+
+class TUnixClient
+{
+public:
+    explicit TUnixClient(const std::string &path)
+    {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+        FFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (FFd < 0 || connect(FFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0)
+        {
+            std::perror("connect");
+            std::exit(2);
+        }
+    }
+
+    ~TUnixClient() { close(FFd); }
+
+    std::string RoundTrip(const std::string &body)
+    {
+        if (!SendAll(FFd, McpLengthFramer::Frame(body)))
+            return std::string();
+        std::string reply;
+        TFrameStatus status;
+        while ((status = FFramer.Next(reply)) == TFrameStatus::NeedMore)
+        {
+            char chunk[65536];
+            ssize_t n = recv(FFd, chunk, sizeof(chunk), 0);
+            if (n <= 0)
+                return std::string();
+            FFramer.Append(chunk, static_cast<size_t>(n));
+        }
+        return status == TFrameStatus::Message ? reply : std::string();
+    }
+
+private:
+    int FFd = -1;
+    McpLengthFramer FFramer{16 * 1024 * 1024};
+};
+
+class THttpClient
+{
+public:
+    explicit THttpClient(int port)
+    {
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(static_cast<uint16_t>(port));
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        FFd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (FFd < 0 || connect(FFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0)
+        {
+            std::perror("connect");
+            std::exit(2);
+        }
+        int one = 1;
+        setsockopt(FFd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+
+    ~THttpClient() { close(FFd); }
+
+    // Content-Length responses only: the requests here never stream
+    std::string RoundTrip(const std::string &body)
+    {
+        std::string request = "POST /mcp HTTP/1.1\r\nHost: 127.0.0.1\r\n"
+            "Content-Type: application/json\r\n"
+            "Accept: application/json, text/event-stream\r\n"
+            "Content-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body;
+        if (!SendAll(FFd, request))
+            return std::string();
+
+        while (true)
+        {
+            size_t headEnd = FBuffer.find("\r\n\r\n");
+            size_t lengthPos = FBuffer.find("Content-Length: ");
+            if (headEnd != std::string::npos && lengthPos < headEnd)
+            {
+                size_t length = std::strtoul(FBuffer.c_str() + lengthPos + 16, nullptr, 10);
+                if (FBuffer.size() >= headEnd + 4 + length)
+                {
+                    std::string reply = FBuffer.substr(headEnd + 4, length);
+                    FBuffer.erase(0, headEnd + 4 + length);
+                    return reply;
+                }
+            }
+            else if (headEnd != std::string::npos)
+            {
+                return std::string();
+            }
+            if (!ReadMore(FFd, FBuffer))
+                return std::string();
+        }
+    }
+
+private:
+    int FFd = -1;
+    std::string FBuffer;
+};
+
+} // namespace
+
+//---------------------------------------------------------------------------
+int main(int argc, char **argv)
+{
+    int count = 20000;
+    unsigned workers = 4;
+    std::string request = "echo";
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--count" && hasValue)
+            count = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--workers" && hasValue)
+            workers = static_cast<unsigned>(std::atoi(argv[++i]));
+        else if (arg == "--request" && hasValue)
+            request = argv[++i];
+    }
+
+    std::unique_ptr<TMcpServer> server = Bench::CreateBenchServer(2);
+    TMcpRequestHandler handler = MakeHandler(*server);
+    std::string body = JsonRpcBody(request);
+    std::vector<TPathResult> results;
+
+    results.push_back(Measure("direct", [&server](const std::string &b) {
+        return server->HandleRequest(b);
+    }, body, count));
+
+    {
+        TStdioClient client;
+        TStdioConfig config;
+        config.InputFd = client.ToServer[0];
+        config.OutputFd = client.FromServer[1];
+        config.WorkerThreads = workers;
+        StdioTransport transport(config);
+        transport.SetRequestHandler(handler);
+        transport.Start();
+        results.push_back(Measure("stdio", [&client](const std::string &b) {
+            return client.RoundTrip(b);
+        }, body, count));
+        transport.Stop();
+    }
+
+    {
+        TUnixSocketConfig config;
+        config.Path = "/tmp/mcp_ipc_latency." + std::to_string(getpid()) + ".sock";
+        config.WorkerThreads = workers;
+        UnixSocketTransport transport(config);
+        transport.SetRequestHandler(handler);
+        transport.Start();
+        {
+            TUnixClient client(config.Path);
+            results.push_back(Measure("unix", [&client](const std::string &b) {
+                return client.RoundTrip(b);
+            }, body, count));
+        }
+        transport.Stop();
+    }
+
+    {
+        TEpollHttpConfig config;
+        config.WorkerThreads = workers;
+        EpollHttpTransport transport(config);
+        transport.SetRequestHandler(handler);
+        transport.Start();
+        {
+            THttpClient client(transport.GetPort());
+            results.push_back(Measure("http", [&client](const std::string &b) {
+                return client.RoundTrip(b);
+            }, body, count));
+        }
+        transport.Stop();
+    }
+
+    std::printf("request %s, %d sequential requests per path, %u workers\n",
+        request.c_str(), count, workers);
+    std::printf("%-8s %12s %10s %10s %10s %10s\n",
+        "path", "requests/sec", "mean us", "p50 us", "p99 us", "failures");
+    uint64_t failures = 0;
+    for (TPathResult &r : results)
+    {
+        double mean = std::accumulate(r.LatenciesUs.begin(), r.LatenciesUs.end(), 0.0) /
+            r.LatenciesUs.size();
+        std::printf("%-8s %12.0f %10.1f %10.1f %10.1f %10llu\n",
+            r.Name.c_str(), r.LatenciesUs.size() / r.Seconds, mean,
+            Percentile(r.LatenciesUs, 0.50), Percentile(r.LatenciesUs, 0.99),
+            static_cast<unsigned long long>(r.Failures));
+        failures += r.Failures;
+    }
+    std::printf("hardware threads: %u\n", std::thread::hardware_concurrency());
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,289 @@
+//---------------------------------------------------------------------------
+// McpStress.cpp — Concurrent clients against one TMcpServer
+//
+// N client threads call HandleRequest on a shared server, the way Indy's
+// connection threads do, while another thread keeps re-registering tools
+// and methods and replacing the event handlers. Every response is checked
+// against its own request (id, echoed text, the tool context's request id
+// and progress token), so a context or response leaking between requests
+// is a failure. Reports throughput per thread count and the speedup over
+// the first count run (1 by default); build the TSan variant (build.sh)
+// to check for data races.
+//
+//   ./mcp_stress                     1, 2, 4 and 8 threads, 1 s each
+//   ./mcp_stress --threads 1,16      thread counts to run
+//   ./mcp_stress --time 3000         milliseconds per thread count
+//   ./mcp_stress --no-churn          no registrations while serving
+//---------------------------------------------------------------------------
+
+#include "McpBenchFixture.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace Mcp;
+using TClock = std::chrono::steady_clock;
+
+struct TStressResult
+{
+    uint64_t Requests = 0;
+    uint64_t Failures = 0;
+    double Seconds = 0;
+};
+
+std::atomic<uint64_t> GFailures{0};
+
+void Fail(const std::string &what, const std::string &request, const std::string &response)
+{
+    if (GFailures.fetch_add(1) < 10)
+        std::fprintf(stderr, "FAIL %s\n  request:  %s\n  response: %s\n",
+            what.c_str(), request.c_str(), response.c_str());
+}
+
+// The response as a JSON object, or null after reporting a failure
+json ParseResponse(const std::string &request, const std::string &response)
+{
+    json parsed = json::parse(response, nullptr, false);
+    if (parsed.is_discarded())
+        Fail("invalid JSON", request, response);
+    return parsed;
+}
+
+void CheckResult(const json &response, int64_t id, const std::string &request,
+    const std::string &text)
+{
+    if (!response.is_object() || response.value("id", json()) != id ||
+        !response.contains("result"))
+        Fail("wrong id or no result", request, text);
+}
+
+// Context of the call as a tool sees it
+TMcpToolResult WhoAmI(const json &args, TMcpToolContext &ctx)
+{
+    return TMcpToolResult::Success(json{{"requestId", ctx.GetRequestId()},
+        {"progressToken", ctx.GetProgressToken()}, {"tag", args.value("tag", std::string())}});
+}
+
+std::unique_ptr<TMcpServer> CreateStressServer()
+{
+    std::unique_ptr<TMcpServer> server = Bench::CreateBenchServer(2);
+    server->RegisterLambda("whoami", "Return the request id and progress token",
+        TMcpToolSchema().AddString("tag", "Echoed back", true), WhoAmI);
+    server->RegisterMethod("custom/ping",
+        [](const json &params) { return TMcpMethodResult::Success(json::object()); });
+    return server;
+}
+
+// One request of the mix, checked against its response
+void RunOne(TMcpServer &server, int64_t id, unsigned kind)
+{
+    std::string sid = std::to_string(id);
+    std::string request;
+    switch (kind % 6)
+    {
+    case 0:
+    {
+        std::string tag = "c" + sid;
+        request = "{\"jsonrpc\":\"2.0\",\"id\":" + sid + ",\"method\":\"tools/call\","
+            "\"params\":{\"name\":\"whoami\",\"arguments\":{\"tag\":\"" + tag + "\"},"
+            "\"_meta\":{\"progressToken\":\"p" + sid + "\"}}}";
+        std::string text = server.HandleRequest(request);
+        json response = ParseResponse(request, text);
+        CheckResult(response, id, request, text);
+        const json &content = response["result"]["structuredContent"];
+        if (content.value("requestId", json()) != id ||
+            content.value("progressToken", std::string()) != "p" + sid ||
+            content.value("tag", std::string()) != tag)
+            Fail("tool saw another request's context", request, text);
+        return;
+    }
+    case 1:
+    {
+        request = "{\"jsonrpc\":\"2.0\",\"id\":" + sid + ",\"method\":\"tools/call\","
+            "\"params\":{\"name\":\"echo\",\"arguments\":{\"text\":\"e" + sid + "\"}}}";
+        std::string text = server.HandleRequest(request);
+        json response = ParseResponse(request, text);
+        CheckResult(response, id, request, text);
+        if (response["result"]["structuredContent"].value("text", std::string()) != "e" + sid)
+            Fail("echo returned another request's text", request, text);
+        return;
+    }
+    case 2:
+        request = "{\"jsonrpc\":\"2.0\",\"id\":" + sid + ",\"method\":\"tools/call\","
+            "\"params\":{\"name\":\"get_status\",\"arguments\":{}}}";
+        break;
+    case 3:
+        request = "{\"jsonrpc\":\"2.0\",\"id\":" + sid + ",\"method\":\"tools/call\","
+            "\"params\":{\"name\":\"set_value\",\"arguments\":{\"value\":" + sid + "}}}";
+        break;
+    case 4:
+        request = "{\"jsonrpc\":\"2.0\",\"id\":" + sid + ",\"method\":\"custom/ping\"}";
+        break;
+    default:
+    {
+        // A batch: ids id*8 .. id*8+2 come back once each
+        std::string base = std::to_string(id * 8);
+        request = "[{\"jsonrpc\":\"2.0\",\"id\":" + base + ",\"method\":\"ping\"},"
+            "{\"jsonrpc\":\"2.0\",\"id\":" + std::to_string(id * 8 + 1) +
+            ",\"method\":\"tools/call\",\"params\":{\"name\":\"get_events\","
+            "\"arguments\":{\"limit\":3}}},"
+            "{\"jsonrpc\":\"2.0\",\"method\":\"notifications/initialized\"},"
+            "{\"jsonrpc\":\"2.0\",\"id\":" + std::to_string(id * 8 + 2) +
+            ",\"method\":\"tools/call\",\"params\":{\"name\":\"echo\","
+            "\"arguments\":{\"text\":\"b\"}}}]";
+        std::string text = server.HandleRequest(request);
+        json response = ParseResponse(request, text);
+        if (!response.is_array() || response.size() != 3)
+        {
+            Fail("batch response size", request, text);
+            return;
+        }
+        int64_t seen = 0;
+        for (const json &item : response)
+        {
+            int64_t itemId = item.value("id", json()).is_number_integer() ?
+                item["id"].get<int64_t>() : -1;
+            if (itemId >= id * 8 && itemId <= id * 8 + 2 && item.contains("result"))
+                seen |= int64_t(1) << (itemId - id * 8);
+        }
+        if (seen != 7)
+            Fail("batch response ids", request, text);
+        return;
+    }
+    }
+
+    std::string text = server.HandleRequest(request);
+    CheckResult(ParseResponse(request, text), id, request, text);
+}
+
+// Re-registers tools and methods and swaps handlers until stop is set
+void Churn(TMcpServer &server, const std::atomic<bool> &stop, std::atomic<uint64_t> &events)
+{
+    for (unsigned round = 0; !stop.load(std::memory_order_relaxed); round++)
+    {
+        server.RegisterLambda("whoami", "Return the request id and progress token",
+            TMcpToolSchema().AddString("tag", "Echoed back", true), WhoAmI);
+        server.RegisterLambda("churn_" + std::to_string(round % 4), "Registered while serving",
+            TMcpToolSchema(),
+            [](const json &args, TMcpToolContext &ctx) -> TMcpToolResult {
+                return TMcpToolResult::Success(std::string("ok"));
+            });
+        server.RegisterMethod("custom/ping",
+            [round](const json &params) {
+                return TMcpMethodResult::Success(json{{"round", round}});
+            });
+        server.EnableResultCache("get_status", std::chrono::milliseconds(round % 2 ? 250 : 1));
+        server.SetOnToolExecuted(
+            [&events](const std::string &, bool, const std::string &) { events++; });
+        server.SetOnResponseSent([&events](const std::string &) { events++; });
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+}
+
+TStressResult Run(unsigned threadCount, std::chrono::milliseconds duration, bool churn)
+{
+    // The handlers the churn thread installs count into events
+    std::atomic<uint64_t> events{0};
+    std::unique_ptr<TMcpServer> server = CreateStressServer();
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> requests{0};
+    uint64_t failuresBefore = GFailures.load();
+
+    std::vector<std::thread> clients;
+    TClock::time_point start = TClock::now();
+    for (unsigned t = 0; t < threadCount; t++)
+    {
+        clients.emplace_back([&, t]() {
+            uint64_t done = 0;
+            // Ids are unique across threads: thread in the low bits
+            for (int64_t n = 0; !stop.load(std::memory_order_relaxed); n++)
+            {
+                RunOne(*server, n * 64 + t, static_cast<unsigned>(n + t));
+                done++;
+            }
+            requests.fetch_add(done);
+        });
+    }
+
+    std::thread churner;
+    if (churn)
+        churner = std::thread([&]() { Churn(*server, stop, events); });
+
+    std::this_thread::sleep_for(duration);
+    stop = true;
+    for (std::thread &client : clients)
+        client.join();
+    TStressResult result;
+    result.Seconds = std::chrono::duration<double>(TClock::now() - start).count();
+    if (churner.joinable())
+        churner.join();
+
+    result.Requests = requests.load();
+    result.Failures = GFailures.load() - failuresBefore;
+    return result;
+}
+
+std::vector<unsigned> ParseThreads(const char *text)
+{
+    std::vector<unsigned> counts;
+    for (const char *p = text; *p; )
+    {
+        unsigned value = static_cast<unsigned>(std::strtoul(p, nullptr, 10));
+        if (value > 0)
+            counts.push_back(value);
+        p = std::strchr(p, ',');
+        if (!p)
+            break;
+        p++;
+    }
+    return counts;
+}
+
+} // namespace
+
+//---------------------------------------------------------------------------
+int main(int argc, char **argv)
+{
+    std::vector<unsigned> threadCounts = {1, 2, 4, 8};
+    std::chrono::milliseconds duration(1000);
+    bool churn = true;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            threadCounts = ParseThreads(argv[++i]);
+        else if (std::strcmp(argv[i], "--time") == 0 && i + 1 < argc)
+            duration = std::chrono::milliseconds(std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--no-churn") == 0)
+            churn = false;
+    }
+
+    std::printf("%-10s %14s %12s %10s %10s\n",
+        "threads", "requests/sec", "requests", "speedup", "failures");
+
+    double baseline = 0;
+    uint64_t failures = 0;
+    for (unsigned threads : threadCounts)
+    {
+        TStressResult r = Run(threads, duration, churn);
+        double perSec = r.Requests / r.Seconds;
+        if (baseline == 0)
+            baseline = perSec;
+        failures += r.Failures;
+        std::printf("%-10u %14.0f %12llu %9.2fx %10llu\n", threads, perSec,
+            static_cast<unsigned long long>(r.Requests), perSec / baseline,
+            static_cast<unsigned long long>(r.Failures));
+        std::fflush(stdout);
+    }
+
+    std::printf("hardware threads: %u\n", std::thread::hardware_concurrency());
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,51 @@
+#!/usr/bin/env bash
+# Builds the Linux benchmark and fuzz targets for the portable MCP core
+# (McpServer.h and the transport helpers; no VCL/Indy needed).
+#
+#   ui/mcp/bench/build.sh            -> build/mcp_bench, build/mcp_fuzz,
+#                                       build/mcp_stress, build/mcp_stress_tsan,
+#                                       build/mcp_http_load, build/mcp_ipc_latency
+#   CXX=clang++ ui/mcp/bench/build.sh  (mcp_fuzz is then a libFuzzer binary)
+#   OUT=/tmp/b ui/mcp/bench/build.sh
+set -euo pipefail
+
+HERE="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+ROOT="$(cd "$HERE/../../.." && pwd)"
+OUT="${OUT:-$ROOT/build}"
+CXX="${CXX:-g++}"
+
+# ../../../external in the transport headers resolves from ui/mcp/transport
+INCLUDES=(-I "$ROOT/ui/mcp/transport")
+CXXFLAGS=(-std=c++17 -Wall -Wno-unused-parameter -pthread)
+CORS="$ROOT/ui/mcp/transport/http/CorsValidator.cpp"
+HTTP=("$CORS" "$ROOT/ui/mcp/transport/http/McpHttpEndpoint.cpp"
+      "$ROOT/ui/mcp/transport/epoll/EpollHttpTransport.cpp")
+LOCAL=("$ROOT/ui/mcp/transport/local/StdioTransport.cpp"
+       "$ROOT/ui/mcp/transport/local/UnixSocketTransport.cpp")
+
+mkdir -p "$OUT"
+
+"$CXX" "${CXXFLAGS[@]}" -O2 -DNDEBUG "${INCLUDES[@]}" \
+    "$HERE/McpBench.cpp" "$CORS" -o "$OUT/mcp_bench"
+
+"$CXX" "${CXXFLAGS[@]}" -O2 -DNDEBUG "${INCLUDES[@]}" \
+    "$HERE/McpStress.cpp" -o "$OUT/mcp_stress"
+
+"$CXX" "${CXXFLAGS[@]}" -O1 -g -fsanitize=thread "${INCLUDES[@]}" \
+    "$HERE/McpStress.cpp" -o "$OUT/mcp_stress_tsan"
+
+"$CXX" "${CXXFLAGS[@]}" -O2 -DNDEBUG "${INCLUDES[@]}" \
+    "$HERE/McpHttpLoad.cpp" "${HTTP[@]}" -o "$OUT/mcp_http_load"
+
+"$CXX" "${CXXFLAGS[@]}" -O2 -DNDEBUG "${INCLUDES[@]}" \
+    "$HERE/McpIpcLatency.cpp" "${HTTP[@]}" "${LOCAL[@]}" -o "$OUT/mcp_ipc_latency"
+
+if [[ "$("$CXX" --version)" == *clang* ]]; then
+    "$CXX" "${CXXFLAGS[@]}" -O1 -g -fsanitize=fuzzer,address,undefined "${INCLUDES[@]}" \
+        "$HERE/McpFuzz.cpp" -o "$OUT/mcp_fuzz"
+else
+    "$CXX" "${CXXFLAGS[@]}" -O1 -g -fsanitize=address,undefined -DMCP_FUZZ_STANDALONE \
+        "${INCLUDES[@]}" "$HERE/McpFuzz.cpp" -o "$OUT/mcp_fuzz"
+fi
+
+echo "built $OUT/mcp_bench $OUT/mcp_fuzz $OUT/mcp_stress $OUT/mcp_stress_tsan $OUT/mcp_http_load $OUT/mcp_ipc_latency"
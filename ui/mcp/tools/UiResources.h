@@ -0,0 +1,122 @@
+//---------------------------------------------------------------------------
+// UiResources.h — MCP resources for ClaBot's event log
+//
+// - clabot://events: all events (time, type, data). Append
+//   ?offset=N&limit=M to read a slice, e.g. only the events after the ones
+//   already seen. Subscribers get notifications/resources/updated for
+//   clabot://events as events arrive, instead of polling ui_get_events or
+//   ui_wait_events; a subscription with a query is one to clabot://events.
+// - clabot://events/{index}: one event with full tool input/output; events
+//   do not change, so these cannot be subscribed
+//---------------------------------------------------------------------------
+
+#ifndef UiResourcesH
+#define UiResourcesH
+
+//---------------------------------------------------------------------------
+#include "UiTools.h"
+#include <cstdlib>
+#include <string>
+
+namespace Mcp { namespace Tools {
+
+// Reported by TUiMcpServer::PublishEventCount whenever the log changes
+constexpr const char *EventsResourceUri = "clabot://events";
+
+//---------------------------------------------------------------------------
+// Integer query parameter of a resource URI ("...?offset=10&limit=5"),
+// or defaultValue when absent or not a number
+//---------------------------------------------------------------------------
+inline int GetUriQueryInt(const std::string &uri, const std::string &name, int defaultValue)
+{
+    size_t pos = uri.find('?');
+    while (pos != std::string::npos)
+    {
+        pos++;
+        if (uri.compare(pos, name.size(), name) == 0 && pos + name.size() < uri.size() &&
+            uri[pos + name.size()] == '=')
+        {
+            const char *start = uri.c_str() + pos + name.size() + 1;
+            char *end = nullptr;
+            long value = std::strtol(start, &end, 10);
+            if (end != start && value >= 0 && value <= 0x7fffffff)
+                return static_cast<int>(value);
+            return defaultValue;
+        }
+        pos = uri.find('&', pos);
+    }
+    return defaultValue;
+}
+
+//---------------------------------------------------------------------------
+// Register the event log resources with the MCP server
+// @param server The MCP server to register resources with
+// @param appState Pointer to the IAppState implementation
+//---------------------------------------------------------------------------
+inline void RegisterUiResources(TMcpServer &server, IAppState *appState)
+{
+    if (!appState)
+        return;
+
+    // clabot://events - the event log, or a slice of it
+    TMcpResource events;
+    events.Uri = EventsResourceUri;
+    events.Name = "Event log";
+    events.Description = "All events as {events: [{time, type, data}], offset, total}. "
+        "Read clabot://events?offset=N&limit=M for a slice; subscribe to be notified "
+        "when events are added or the log is cleared";
+    server.AddResource(events,
+        [appState](const std::string &uri, TMcpResourceContents &contents) {
+            int offset = GetUriQueryInt(uri, "offset", 0);
+            int limit = GetUriQueryInt(uri, "limit", 0);
+
+            json list = json::array();
+            int total = 0;
+            SyncCall([&]() {
+                for (const auto &ev : appState->GetEvents(limit, offset))
+                    list.push_back(EventToJson(ev, false));
+                total = appState->GetEventCount();
+            });
+
+            json result;
+            result["events"] = std::move(list);
+            result["offset"] = offset;
+            result["total"] = total;
+            contents.Text = result.dump();
+            return true;
+        });
+
+    // clabot://events/{index} - one event with details
+    TMcpResourceTemplate details;
+    details.UriTemplate = "clabot://events/{index}";
+    details.Name = "Event details";
+    details.Description = "One event by index, including tool input/output JSON";
+    server.AddResourceTemplate(details, "clabot://events/",
+        [appState](const std::string &uri, TMcpResourceContents &contents) {
+            std::string indexText = uri.substr(std::string("clabot://events/").size());
+            if (indexText.empty() || indexText.size() > 9 ||
+                indexText.find_first_not_of("0123456789") != std::string::npos)
+                return false;
+            int index = std::atoi(indexText.c_str());
+
+            json event;
+            bool found = false;
+            SyncCall([&]() {
+                if (index < appState->GetEventCount()) {
+                    event = EventToJson(appState->GetEventDetails(index), true);
+                    found = true;
+                }
+            });
+            if (!found)
+                return false;
+
+            event["index"] = index;
+            contents.Text = event.dump();
+            return true;
+        });
+}
+
+}} // namespace Mcp::Tools
+
+//---------------------------------------------------------------------------
+#endif
@@ -15,31 +15,212 @@
 
 //---------------------------------------------------------------------------
 #include "../McpServer.h"
+#include "../McpTypedArgs.h"
+#include "../McpMainThreadExecutor.h"
 #include "UcodeUtf8.h"
 #include "../../interfaces/uIAppState.h"
 #include <Vcl.Forms.hpp>
 #include <Vcl.StdCtrls.hpp>
 #include <Vcl.ComCtrls.hpp>
 #include <chrono>
-#include <thread>
+#include <algorithm>
 
 namespace Mcp { namespace Tools {
 
 //---------------------------------------------------------------------------
-// Helper to safely execute on main VCL thread
+// The VCL main thread as a batched executor: work posted from any thread
+// runs in one go per message-loop tick
+//---------------------------------------------------------------------------
+inline TMcpMainThreadExecutor& MainThreadExecutor()
+{
+    static TMcpMainThreadExecutor executor(
+        []() {
+            TThread::ForceQueue(nullptr, []() {
+                MCP_TRACE_SCOPE("ui.drain");
+                MainThreadExecutor().Drain();
+            });
+        },
+        []() { return GetCurrentThreadId() == MainThreadID; });
+    return executor;
+}
+
+//---------------------------------------------------------------------------
+// Helper to safely execute on main VCL thread (blocks until done)
 //---------------------------------------------------------------------------
 template<typename Func>
 void SyncCall(Func func)
 {
-    TThread::Synchronize(nullptr, [&func]() { func(); });
+    MainThreadExecutor().Invoke([&func]() { func(); });
+}
+
+// Same, recording the time blocked on the main thread in the tool's metrics.
+// Tools with a MainThread policy already run there and call straight through.
+template<typename Func>
+void SyncCall(const TMcpToolContext &ctx, Func func)
+{
+    if (MainThreadExecutor().IsMainThread())
+    {
+        func();
+        return;
+    }
+
+    MCP_TRACE_SCOPE("ui.sync_call");
+    auto start = std::chrono::steady_clock::now();
+    SyncCall([&]() {
+        MCP_TRACE_REQUEST(ctx.GetRequestId());
+        MCP_TRACE_SCOPE("ui.main_thread");
+        func();
+    });
+    ctx.RecordWait(std::chrono::steady_clock::now() - start);
+}
+
+//---------------------------------------------------------------------------
+// An event as the tools and resources return it; details adds the tool
+// input/output fields
+//---------------------------------------------------------------------------
+inline json EventToJson(const TEventData &ev, bool details)
+{
+    json eventJson = {
+        {"time", utf8(ev.Time)},
+        {"type", utf8(ev.Type)},
+        {"data", utf8(ev.Data)}
+    };
+    if (details) {
+        eventJson["toolInput"] = utf8(ev.ToolInput);
+        eventJson["toolOutput"] = utf8(ev.ToolOutput);
+        eventJson["toolUseId"] = utf8(ev.ToolUseId);
+        eventJson["requestId"] = utf8(ev.RequestId);
+        eventJson["durationMs"] = ev.DurationMs;
+    }
+    return eventJson;
+}
+
+//---------------------------------------------------------------------------
+// Annotations for tools that change UI state. Such tools are never run
+// concurrently with other batch elements.
+//---------------------------------------------------------------------------
+inline TMcpToolAnnotations ActionAnnotations(bool idempotent, bool destructive = false)
+{
+    TMcpToolAnnotations ann;
+    ann.ReadOnlyHint = false;
+    ann.IdempotentHint = idempotent;
+    ann.DestructiveHint = destructive;
+    return ann;
 }
 
+//---------------------------------------------------------------------------
+// Tool arguments (schema and decoding are generated from the field tables)
+//---------------------------------------------------------------------------
+struct TGetEventsArgs
+{
+    int Limit = 100;
+    int Offset = 0;
+    bool IncludeDetails = false;
+
+    static constexpr auto Fields()
+    {
+        return std::make_tuple(
+            McpArg("limit", &TGetEventsArgs::Limit,
+                "Maximum number of events to return (0 = all, default 100)"),
+            McpArg("offset", &TGetEventsArgs::Offset, "Skip first N events (default 0)"),
+            McpArg("include_details", &TGetEventsArgs::IncludeDetails,
+                "Include full tool input/output (default false)"));
+    }
+};
+
+struct TSetServerUrlArgs
+{
+    std::string Url;
+
+    static constexpr auto Fields()
+    {
+        return std::make_tuple(
+            McpArg("url", &TSetServerUrlArgs::Url,
+                "The server URL (e.g., http://localhost:3000)", true));
+    }
+};
+
+struct TSetAgentNameArgs
+{
+    std::string Name;
+
+    static constexpr auto Fields()
+    {
+        return std::make_tuple(
+            McpArg("name", &TSetAgentNameArgs::Name, "The agent name", true));
+    }
+};
+
+struct TSetPromptArgs
+{
+    std::string Text;
+
+    static constexpr auto Fields()
+    {
+        return std::make_tuple(
+            McpArg("text", &TSetPromptArgs::Text, "The prompt text", true));
+    }
+};
+
+struct TWaitEventsArgs
+{
+    int Count = 1;
+    int TimeoutMs = 30000;
+
+    static constexpr auto Fields()
+    {
+        return std::make_tuple(
+            McpArg("count", &TWaitEventsArgs::Count,
+                "Minimum number of events to wait for", true),
+            McpArg("timeout_ms", &TWaitEventsArgs::TimeoutMs,
+                "Timeout in milliseconds (default 30000)"));
+    }
+};
+
+struct TGetAllArgs
+{
+    int EventsLimit = 10;
+
+    static constexpr auto Fields()
+    {
+        return std::make_tuple(
+            McpArg("events_limit", &TGetAllArgs::EventsLimit,
+                "Maximum events to include (default 10)"));
+    }
+};
+
+struct TSetResumeModeArgs
+{
+    bool Resume = false;
+
+    static constexpr auto Fields()
+    {
+        return std::make_tuple(
+            McpArg("resume", &TSetResumeModeArgs::Resume,
+                "true to continue existing session, false to start new session", true));
+    }
+};
+
+struct TGetEventDetailsArgs
+{
+    int Index = -1;
+
+    static constexpr auto Fields()
+    {
+        return std::make_tuple(
+            McpArg("index", &TGetEventDetailsArgs::Index, "Event index (0-based)", true));
+    }
+};
+
 //---------------------------------------------------------------------------
 // Register all UI tools with the MCP server
 // @param server The MCP server to register tools with
 // @param appState Pointer to the IAppState implementation
+// @param eventCounter Published with the event count whenever it changes;
+//        ui_wait_events waits on it
 //---------------------------------------------------------------------------
-inline void RegisterUiTools(TMcpServer &server, IAppState *appState)
+inline void RegisterUiTools(TMcpServer &server, IAppState *appState,
+    TMcpCounterWaiter &eventCounter)
 {
     // ui_get_status - Get general UI status
     server.RegisterLambda(
@@ -51,7 +232,7 @@ inline void RegisterUiTools(TMcpServer &server, IAppState *appState)
                 return TMcpToolResult::Error("App state not initialized");
 
             json result;
-            SyncCall([&]() {
+            SyncCall(ctx, [&]() {
                 result["connected"] = appState->IsConnected();
                 result["agentId"] = utf8(appState->GetAgentId());
                 result["eventsCount"] = appState->GetEventCount();
@@ -62,39 +243,18 @@ inline void RegisterUiTools(TMcpServer &server, IAppState *appState)
     );
 
     // ui_get_events - Get list of events
-    server.RegisterLambda(
+    RegisterTypedTool<TGetEventsArgs>(server,
         "ui_get_events",
         "Get list of all events from the events list. Returns array of {time, type, data, toolInput, toolOutput, toolUseId, requestId, durationMs} objects",
-        TMcpToolSchema()
-            .AddInteger("limit", "Maximum number of events to return (0 = all, default 100)")
-            .AddInteger("offset", "Skip first N events (default 0)")
-            .AddBoolean("include_details", "Include full tool input/output (default false)", false),
-        [appState](const json &args, TMcpToolContext &ctx) -> TMcpToolResult {
+        [appState](const TGetEventsArgs &args, TMcpToolContext &ctx) -> TMcpToolResult {
             if (!appState)
                 return TMcpToolResult::Error("App state not initialized");
 
-            int limit = TMcpToolBase::GetInt(args, "limit", 100);
-            int offset = TMcpToolBase::GetInt(args, "offset", 0);
-            bool includeDetails = TMcpToolBase::GetBool(args, "include_details", false);
-
             json events = json::array();
-            SyncCall([&]() {
-                auto eventList = appState->GetEvents(limit, offset);
-                for (const auto &ev : eventList) {
-                    json eventJson = {
-                        {"time", utf8(ev.Time)},
-                        {"type", utf8(ev.Type)},
-                        {"data", utf8(ev.Data)}
-                    };
-                    if (includeDetails) {
-                        eventJson["toolInput"] = utf8(ev.ToolInput);
-                        eventJson["toolOutput"] = utf8(ev.ToolOutput);
-                        eventJson["toolUseId"] = utf8(ev.ToolUseId);
-                        eventJson["requestId"] = utf8(ev.RequestId);
-                        eventJson["durationMs"] = ev.DurationMs;
-                    }
-                    events.push_back(eventJson);
-                }
+            SyncCall(ctx, [&]() {
+                auto eventList = appState->GetEvents(args.Limit, args.Offset);
+                for (const auto &ev : eventList)
+                    events.push_back(EventToJson(ev, args.IncludeDetails));
             });
 
             json result;
@@ -114,7 +274,7 @@ inline void RegisterUiTools(TMcpServer &server, IAppState *appState)
                 return TMcpToolResult::Error("App state not initialized");
 
             json result;
-            SyncCall([&]() {
+            SyncCall(ctx, [&]() {
                 result["serverUrl"] = utf8(appState->GetServerUrl());
                 result["agentName"] = utf8(appState->GetAgentName());
                 result["agentId"] = utf8(appState->GetAgentId());
@@ -135,12 +295,13 @@ inline void RegisterUiTools(TMcpServer &server, IAppState *appState)
         "ui_click_connect",
         "Click the Connect button to connect to the orchestrator server",
         TMcpToolSchema(),
+        ActionAnnotations(false),
         [appState](const json &args, TMcpToolContext &ctx) -> TMcpToolResult {
             if (!appState)
                 return TMcpToolResult::Error("App state not initialized");
 
             bool clicked = false;
-            SyncCall([&]() {
+            SyncCall(ctx, [&]() {
                 if (appState->IsConnectEnabled()) {
                     appState->ClickConnect();
                     clicked = true;
@@ -159,12 +320,13 @@ inline void RegisterUiTools(TMcpServer &server, IAppState *appState)
         "ui_click_create_agent",
         "Click the Create Agent button to create a new agent session",
         TMcpToolSchema(),
+        ActionAnnotations(false, true),
         [appState](const json &args, TMcpToolContext &ctx) -> TMcpToolResult {
             if (!appState)
                 return TMcpToolResult::Error("App state not initialized");
 
             bool clicked = false;
-            SyncCall([&]() {
+            SyncCall(ctx, [&]() {
                 if (appState->IsCreateAgentEnabled()) {
                     appState->ClickCreateAgent();
                     clicked = true;
@@ -183,12 +345,13 @@ inline void RegisterUiTools(TMcpServer &server, IAppState *appState)
         "ui_click_send",
         "Click the Send button to send the current prompt to the agent",
         TMcpToolSchema(),
+        ActionAnnotations(false),
         [appState](const json &args, TMcpToolContext &ctx) -> TMcpToolResult {
             if (!appState)
                 return TMcpToolResult::Error("App state not initialized");
 
             bool clicked = false;
-            SyncCall([&]() {
+            SyncCall(ctx, [&]() {
                 if (appState->IsSendEnabled()) {
                     appState->ClickSend();
                     clicked = true;
@@ -207,12 +370,13 @@ inline void RegisterUiTools(TMcpServer &server, IAppState *appState)
         "ui_click_stop",
         "Click the Stop button to interrupt the current agent execution",
         TMcpToolSchema(),
+        ActionAnnotations(true, true),
         [appState](const json &args, TMcpToolContext &ctx) -> TMcpToolResult {
             if (!appState)
                 return TMcpToolResult::Error("App state not initialized");
 
             bool clicked = false;
-            SyncCall([&]() {
+            SyncCall(ctx, [&]() {
                 if (appState->IsStopEnabled()) {
                     appState->ClickStop();
                     clicked = true;
@@ -227,20 +391,19 @@ inline void RegisterUiTools(TMcpServer &server, IAppState *appState)
     );
 
     // ui_set_server_url - Set server URL
-    server.RegisterLambda(
+    RegisterTypedTool<TSetServerUrlArgs>(server,
         "ui_set_server_url",
         "Set the orchestrator server URL",
-        TMcpToolSchema()
-            .AddString("url", "The server URL (e.g., http://localhost:3000)", true),
-        [appState](const json &args, TMcpToolContext &ctx) -> TMcpToolResult {
+        ActionAnnotations(true),
+        [appState](const TSetServerUrlArgs &args, TMcpToolContext &ctx) -> TMcpToolResult {
             if (!appState)
                 return TMcpToolResult::Error("App state not initialized");
 
-            std::string url = TMcpToolBase::GetString(args, "url");
+            const std::string &url = args.Url;
             if (url.empty())
                 return TMcpToolResult::Error("URL is required");
 
-            SyncCall([&]() {
+            SyncCall(ctx, [&]() {
                 appState->SetServerUrl(u(url));
             });
 
@@ -249,20 +412,19 @@ inline void RegisterUiTools(TMcpServer &server, IAppState *appState)
     );
 
     // ui_set_agent_name - Set agent name
-    server.RegisterLambda(
+    RegisterTypedTool<TSetAgentNameArgs>(server,
         "ui_set_agent_name",
         "Set the name for the agent to be created",
-        TMcpToolSchema()
-            .AddString("name", "The agent name", true),
-        [appState](const json &args, TMcpToolContext &ctx) -> TMcpToolResult {
+        ActionAnnotations(true),
+        [appState](const TSetAgentNameArgs &args, TMcpToolContext &ctx) -> TMcpToolResult {
             if (!appState)
                 return TMcpToolResult::Error("App state not initialized");
 
-            std::string name = TMcpToolBase::GetString(args, "name");
+            const std::string &name = args.Name;
             if (name.empty())
                 return TMcpToolResult::Error("Name is required");
 
-            SyncCall([&]() {
+            SyncCall(ctx, [&]() {
                 appState->SetAgentName(u(name));
             });
 
@@ -271,18 +433,17 @@ inline void RegisterUiTools(TMcpServer &server, IAppState *appState)
     );
 
     // ui_set_prompt - Set prompt text
-    server.RegisterLambda(
+    RegisterTypedTool<TSetPromptArgs>(server,
         "ui_set_prompt",
         "Set the prompt text to send to the agent",
-        TMcpToolSchema()
-            .AddString("text", "The prompt text", true),
-        [appState](const json &args, TMcpToolContext &ctx) -> TMcpToolResult {
+        ActionAnnotations(true),
+        [appState](const TSetPromptArgs &args, TMcpToolContext &ctx) -> TMcpToolResult {
             if (!appState)
                 return TMcpToolResult::Error("App state not initialized");
 
-            std::string text = TMcpToolBase::GetString(args, "text");
+            const std::string &text = args.Text;
 
-            SyncCall([&]() {
+            SyncCall(ctx, [&]() {
                 appState->SetPrompt(u(text));
             });
 
@@ -290,65 +451,63 @@ inline void RegisterUiTools(TMcpServer &server, IAppState *appState)
         }
     );
 
-    // ui_wait_events - Wait for N events
-    server.RegisterLambda(
+    // ui_wait_events - Wait for N events. Completes from AddEvent (via
+    // eventCounter) or from the timer; no thread is held while waiting.
+    RegisterTypedAsyncTool<TWaitEventsArgs>(server,
         "ui_wait_events",
         "Wait until the events count reaches at least N, or timeout occurs",
-        TMcpToolSchema()
-            .AddInteger("count", "Minimum number of events to wait for", true)
-            .AddInteger("timeout_ms", "Timeout in milliseconds (default 30000)", false),
-        [appState](const json &args, TMcpToolContext &ctx) -> TMcpToolResult {
-            if (!appState)
-                return TMcpToolResult::Error("App state not initialized");
-
-            int targetCount = TMcpToolBase::GetInt(args, "count", 1);
-            int timeoutMs = TMcpToolBase::GetInt(args, "timeout_ms", 30000);
+        [appState, &eventCounter](const TWaitEventsArgs &args,
+            std::shared_ptr<TMcpToolContext> ctx, TMcpToolCompletion done) {
+            if (!appState) {
+                done(TMcpToolResult::Error("App state not initialized"));
+                return;
+            }
 
-            auto start = std::chrono::steady_clock::now();
-            int currentCount = 0;
+            int targetCount = args.Count;
 
-            while (true) {
-                SyncCall([&]() {
-                    currentCount = appState->GetEventCount();
-                });
+            // Re-sync the counter on the main thread, where events are added
+            SyncCall(*ctx, [&]() {
+                eventCounter.Publish(appState->GetEventCount());
+            });
 
-                if (currentCount >= targetCount) {
-                    return TMcpToolResult::Success(json{
-                        {"reached", true},
-                        {"eventsCount", currentCount},
-                        {"targetCount", targetCount}
-                    });
-                }
+            // The request deadline, if shorter, bounds the wait
+            std::chrono::milliseconds timeout(std::max(args.TimeoutMs, 0));
+            timeout = std::min(timeout, ctx->GetRemainingTime());
 
-                auto elapsed = std::chrono::steady_clock::now() - start;
-                if (std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count() >= timeoutMs) {
-                    return TMcpToolResult::Success(json{
-                        {"reached", false},
-                        {"timedOut", true},
-                        {"eventsCount", currentCount},
+            uint64_t waiterId = eventCounter.Wait(targetCount, timeout,
+                [done, targetCount](bool reached, int64_t count) {
+                    json result{
+                        {"reached", reached},
+                        {"eventsCount", count},
                         {"targetCount", targetCount}
-                    });
-                }
+                    };
+                    if (!reached)
+                        result["timedOut"] = true;
+                    done(TMcpToolResult::Success(result));
+                },
+                [ctx, targetCount](int64_t count) {
+                    ctx->ReportProgress(static_cast<double>(count), targetCount);
+                });
 
-                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            // A cancelled call stops waiting right away
+            if (waiterId != 0) {
+                ctx->GetCancellation().OnCancel([&eventCounter, waiterId]() {
+                    eventCounter.Cancel(waiterId);
+                });
             }
         }
     );
 
     // ui_get_all - Get complete UI state
-    server.RegisterLambda(
+    RegisterTypedTool<TGetAllArgs>(server,
         "ui_get_all",
         "Get complete state of the entire UI: all edit fields, all status bar panels, button states, and recent events",
-        TMcpToolSchema()
-            .AddInteger("events_limit", "Maximum events to include (default 10)", false),
-        [appState](const json &args, TMcpToolContext &ctx) -> TMcpToolResult {
+        [appState](const TGetAllArgs &args, TMcpToolContext &ctx) -> TMcpToolResult {
             if (!appState)
                 return TMcpToolResult::Error("App state not initialized");
 
-            int eventsLimit = TMcpToolBase::GetInt(args, "events_limit", 10);
-
             json result;
-            SyncCall([&]() {
+            SyncCall(ctx, [&]() {
                 // Edit fields
                 result["fields"] = json{
                     {"serverUrl", utf8(appState->GetServerUrl())},
@@ -386,14 +545,9 @@ inline void RegisterUiTools(TMcpServer &server, IAppState *appState)
 
                 // Recent events
                 json events = json::array();
-                auto eventList = appState->GetEvents(eventsLimit, 0);
-                for (const auto &ev : eventList) {
-                    events.push_back(json{
-                        {"time", utf8(ev.Time)},
-                        {"type", utf8(ev.Type)},
-                        {"data", utf8(ev.Data)}
-                    });
-                }
+                auto eventList = appState->GetEvents(args.EventsLimit, 0);
+                for (const auto &ev : eventList)
+                    events.push_back(EventToJson(ev, false));
                 result["recentEvents"] = events;
             });
 
@@ -411,7 +565,7 @@ inline void RegisterUiTools(TMcpServer &server, IAppState *appState)
                 return TMcpToolResult::Error("App state not initialized");
 
             json result;
-            SyncCall([&]() {
+            SyncCall(ctx, [&]() {
                 result["sdkSessionId"] = utf8(appState->GetSdkSessionId());
                 result["canResume"] = appState->GetCanResume();
                 result["resumeMode"] = appState->GetResumeMode();
@@ -424,18 +578,17 @@ inline void RegisterUiTools(TMcpServer &server, IAppState *appState)
     );
 
     // ui_set_resume_mode - Set resume mode on/off
-    server.RegisterLambda(
+    RegisterTypedTool<TSetResumeModeArgs>(server,
         "ui_set_resume_mode",
         "Enable or disable session resume mode. When enabled and session supports it, subsequent queries will continue the same session",
-        TMcpToolSchema()
-            .AddBoolean("resume", "true to continue existing session, false to start new session", true),
-        [appState](const json &args, TMcpToolContext &ctx) -> TMcpToolResult {
+        ActionAnnotations(true),
+        [appState](const TSetResumeModeArgs &args, TMcpToolContext &ctx) -> TMcpToolResult {
             if (!appState)
                 return TMcpToolResult::Error("App state not initialized");
 
-            bool resume = TMcpToolBase::GetBool(args, "resume", false);
+            bool resume = args.Resume;
 
-            SyncCall([&]() {
+            SyncCall(ctx, [&]() {
                 appState->SetResumeMode(resume);
             });
 
@@ -448,35 +601,36 @@ inline void RegisterUiTools(TMcpServer &server, IAppState *appState)
     );
 
     // ui_get_event_details - Get full details of an event by index
-    server.RegisterLambda(
+    RegisterTypedTool<TGetEventDetailsArgs>(server,
         "ui_get_event_details",
         "Get full details of a specific event by index, including tool input/output JSON",
-        TMcpToolSchema()
-            .AddInteger("index", "Event index (0-based)", true),
-        [appState](const json &args, TMcpToolContext &ctx) -> TMcpToolResult {
+        [appState](const TGetEventDetailsArgs &args, TMcpToolContext &ctx) -> TMcpToolResult {
             if (!appState)
                 return TMcpToolResult::Error("App state not initialized");
 
-            int index = TMcpToolBase::GetInt(args, "index", -1);
+            int index = args.Index;
             if (index < 0)
                 return TMcpToolResult::Error("Invalid index");
 
             json result;
-            SyncCall([&]() {
-                auto ev = appState->GetEventDetails(index);
-                result["time"] = utf8(ev.Time);
-                result["type"] = utf8(ev.Type);
-                result["data"] = utf8(ev.Data);
-                result["toolInput"] = utf8(ev.ToolInput);
-                result["toolOutput"] = utf8(ev.ToolOutput);
-                result["toolUseId"] = utf8(ev.ToolUseId);
-                result["requestId"] = utf8(ev.RequestId);
-                result["durationMs"] = ev.DurationMs;
+            SyncCall(ctx, [&]() {
+                result = EventToJson(appState->GetEventDetails(index), true);
             });
 
             return TMcpToolResult::Success(result);
         }
     );
+
+    // Everything except ui_wait_events reads or drives VCL controls, so it
+    // runs on the main thread; ui_wait_events only waits and stays off it
+    const char *mainThreadTools[] = {
+        "ui_get_status", "ui_get_events", "ui_get_controls",
+        "ui_click_connect", "ui_click_create_agent", "ui_click_send", "ui_click_stop",
+        "ui_set_server_url", "ui_set_agent_name", "ui_set_prompt",
+        "ui_get_all", "ui_get_session", "ui_set_resume_mode", "ui_get_event_details"
+    };
+    for (const char *name : mainThreadTools)
+        server.SetExecutionPolicy(name, TMcpExecutionPolicy::MainThread());
 }
 
 }} // namespace Mcp::Tools
@@ -15,6 +15,14 @@ namespace Mcp { namespace Transport {
 
 using TMcpRequestHandler = std::function<void(ITransportRequest&, ITransportResponse&)>;
 
+// Completion-based handler: answers through the response and calls done
+// once it is complete, possibly later and on another thread; the request
+// and response stay valid until then
+using TMcpRequestDone = std::function<void()>;
+using TMcpAsyncRequestHandler = std::function<void(ITransportRequest&, ITransportResponse&,
+    TMcpRequestDone done)>;
+using TMcpSessionEndHandler = std::function<void(const std::string &session)>;
+
 class ITransport
 {
 public:
@@ -25,6 +33,21 @@ public:
     virtual bool IsRunning() const = 0;
     virtual std::string GetName() const = 0;
     virtual void SetRequestHandler(TMcpRequestHandler handler) = 0;
+
+    // Delivers a server-initiated JSON-RPC message (TMcpServer's
+    // SetOnNotification) to the clients listening for them; dropped
+    // when none is. Thread-safe.
+    virtual void SendNotification(const std::string &notificationJson) = 0;
+
+    // Delivers a message for one client session (TMcpServer's
+    // SetOnSessionNotification) to that client only; dropped when it is
+    // not listening. Thread-safe.
+    virtual void SendNotificationTo(const std::string &session,
+        const std::string &notificationJson) = 0;
+
+    // Told when a client session ends (TMcpServer::EndSession). Set
+    // before Start.
+    virtual void SetSessionEndHandler(TMcpSessionEndHandler handler) = 0;
 };
 
 }} // namespace Mcp::Transport
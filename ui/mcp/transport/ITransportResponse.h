@@ -5,7 +5,9 @@
 #ifndef ITransportResponseH
 #define ITransportResponseH
 //---------------------------------------------------------------------------
+#include <memory>
 #include <string>
+#include "ITransportStream.h"
 //---------------------------------------------------------------------------
 
 namespace Mcp { namespace Transport {
@@ -20,6 +22,14 @@ public:
     virtual void SetContentType(const std::string &contentType) = 0;
     virtual void SetBody(const std::string &body) = 0;
     virtual void SetNoContent() = 0; // For notifications (HTTP 202)
+
+    // Sends the status and headers set so far with this content type; the
+    // body follows through the stream, which may outlive the handler.
+    // Null when the transport only sends whole bodies.
+    virtual std::shared_ptr<ITransportStream> BeginStream(const std::string &contentType)
+    {
+        return nullptr;
+    }
 };
 
 }} // namespace Mcp::Transport
@@ -0,0 +1,33 @@
+//---------------------------------------------------------------------------
+// ITransportStream.h — Response body sent in pieces (Server-Sent Events)
+//---------------------------------------------------------------------------
+
+#ifndef ITransportStreamH
+#define ITransportStreamH
+//---------------------------------------------------------------------------
+#include <string>
+//---------------------------------------------------------------------------
+
+namespace Mcp { namespace Transport {
+
+// Thread-safe: any thread may write while the request is being handled
+// and after. The response ends when the stream is closed or destroyed.
+class ITransportStream
+{
+public:
+    virtual ~ITransportStream() {}
+
+    // Sends data as the next part of the body; false once the client has
+    // gone or the stream is closed (data is dropped)
+    virtual bool Write(const std::string &data) = 0;
+
+    // Ends the response; later writes fail
+    virtual void Close() = 0;
+
+    virtual bool IsOpen() const = 0;
+};
+
+}} // namespace Mcp::Transport
+
+//---------------------------------------------------------------------------
+#endif
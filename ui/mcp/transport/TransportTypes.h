@@ -15,8 +15,9 @@ struct TCorsConfig
 {
     bool AllowLocalhost = true;
     std::vector<std::string> AllowedOrigins;
-    std::string AllowMethods = "POST, OPTIONS";
-    std::string AllowHeaders = "Content-Type, Accept";
+    std::string AllowMethods = "GET, POST, DELETE, OPTIONS";
+    std::string AllowHeaders = "Content-Type, Accept, Mcp-Session-Id";
+    std::string ExposeHeaders = "Mcp-Session-Id";
 };
 
 struct TCorsResult
@@ -29,6 +30,14 @@ struct TCorsResult
     std::string ErrorMessage;
 };
 
+// Body encoding on the wire; JSON unless negotiated otherwise
+enum class TWireFormat
+{
+    Json,
+    Cbor,
+    MsgPack
+};
+
 struct TJsonRpcParseResult
 {
     bool Ok = false;
@@ -0,0 +1,897 @@
+//---------------------------------------------------------------------------
+// EpollHttpTransport.cpp — Native HTTP/1.1 transport for MCP on Linux
+//---------------------------------------------------------------------------
+
+#include "EpollHttpTransport.h"
+#include "../../McpWorkerPool.h"
+#include "../../McpTrace.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+
+namespace Mcp { namespace Transport {
+
+namespace {
+
+// epoll_event.data of the two descriptors that are not connections
+constexpr uint64_t ListenKey = 0;
+constexpr uint64_t WakeKey = 1;
+
+constexpr size_t ReadChunk = 16 * 1024;
+
+const char* ReasonPhrase(int status)
+{
+    switch (status)
+    {
+    case 200: return "OK";
+    case 202: return "Accepted";
+    case 204: return "No Content";
+    case 400: return "Bad Request";
+    case 403: return "Forbidden";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 406: return "Not Acceptable";
+    case 413: return "Content Too Large";
+    case 415: return "Unsupported Media Type";
+    case 431: return "Request Header Fields Too Large";
+    case 500: return "Internal Server Error";
+    case 501: return "Not Implemented";
+    case 503: return "Service Unavailable";
+    case 505: return "HTTP Version Not Supported";
+    default:  return "Unknown";
+    }
+}
+
+const char* ParseErrorMessage(int status)
+{
+    switch (status)
+    {
+    case 413: return "Request body too large";
+    case 431: return "Request headers too large";
+    case 501: return "Transfer-Encoding is not supported. Send Content-Length.";
+    case 505: return "HTTP version not supported";
+    default:  return "Malformed HTTP request";
+    }
+}
+
+//---------------------------------------------------------------------------
+// EpollResponse — collects what the endpoint sets, then one HTTP response
+// (or, after BeginStream, the head of a streamed one)
+//---------------------------------------------------------------------------
+class EpollResponse : public ITransportResponse
+{
+public:
+    // Queues the head and returns the stream that carries the body
+    using TStreamOpener = std::function<std::shared_ptr<ITransportStream>(std::string head)>;
+
+    // Without this BeginStream returns null
+    void EnableStreaming(bool chunked, bool keepAlive, TStreamOpener opener)
+    {
+        FChunked = chunked;
+        FKeepAlive = keepAlive;
+        FOpenStream = std::move(opener);
+    }
+
+    bool IsStreamed() const { return FStreamed; }
+
+    void SetStatus(int code, const std::string &text = "") override
+    {
+        FStatus = code;
+        FStatusText = text;
+    }
+
+    // Replaces a header set earlier, as Indy's CustomHeaders do
+    void SetHeader(const std::string &name, const std::string &value) override
+    {
+        for (auto &header : FHeaders)
+        {
+            if (THttpRequestHead::EqualsNoCase(header.first, name))
+            {
+                header.second = value;
+                return;
+            }
+        }
+        FHeaders.emplace_back(name, value);
+    }
+
+    void SetContentType(const std::string &contentType) override
+    {
+        FContentType = contentType;
+    }
+
+    void SetBody(const std::string &body) override
+    {
+        MCP_TRACE_SCOPE("http.write_body");
+        FBody = body;
+    }
+
+    void SetNoContent() override
+    {
+        FStatus = 202;
+        FStatusText = "Accepted";
+        FContentType.clear();
+        FBody.clear();
+    }
+
+    // Chunked on HTTP/1.1; otherwise the body ends with the connection
+    std::shared_ptr<ITransportStream> BeginStream(const std::string &contentType) override
+    {
+        if (!FOpenStream || FStreamed)
+            return nullptr;
+        FContentType = contentType;
+        FStreamed = true;
+
+        std::string head;
+        AppendHead(head);
+        if (FChunked)
+            head += "Transfer-Encoding: chunked\r\n";
+        if (!FChunked || !FKeepAlive)
+            head += "Connection: close\r\n";
+        head += "\r\n";
+        return FOpenStream(std::move(head));
+    }
+
+    // Status line, headers and body; HEAD requests get the headers only
+    std::string ToHttp(bool keepAlive, bool headRequest) const
+    {
+        bool hasBody = FStatus >= 200 && FStatus != 204 && FStatus != 304;
+
+        std::string out;
+        out.reserve(FBody.size() + 160);
+        AppendHead(out);
+        if (hasBody)
+        {
+            out += "Content-Length: ";
+            out += std::to_string(FBody.size());
+            out += "\r\n";
+        }
+        if (!keepAlive)
+            out += "Connection: close\r\n";
+        out += "\r\n";
+        if (hasBody && !headRequest)
+            out += FBody;
+        return out;
+    }
+
+private:
+    int FStatus = 200;
+    std::string FStatusText;
+    std::string FContentType;
+    std::vector<std::pair<std::string, std::string>> FHeaders;
+    std::string FBody;
+
+    bool FChunked = false;
+    bool FKeepAlive = false;
+    bool FStreamed = false;
+    TStreamOpener FOpenStream;
+
+    // Status line and the headers set, without the framing ones
+    void AppendHead(std::string &out) const
+    {
+        out += "HTTP/1.1 ";
+        out += std::to_string(FStatus);
+        out += ' ';
+        out += FStatusText.empty() ? ReasonPhrase(FStatus) : FStatusText;
+        out += "\r\n";
+        if (!FContentType.empty())
+        {
+            out += "Content-Type: ";
+            out += FContentType;
+            out += "\r\n";
+        }
+        for (const auto &header : FHeaders)
+        {
+            out += header.first;
+            out += ": ";
+            out += header.second;
+            out += "\r\n";
+        }
+    }
+};
+
+} // namespace
+
+//---------------------------------------------------------------------------
+// EpollRequest — a parsed request; owns the buffer its views point into
+//---------------------------------------------------------------------------
+class EpollHttpTransport::EpollRequest : public ITransportRequest
+{
+public:
+    std::vector<char> Buffer;
+    THttpRequestHead Head;
+
+    std::string GetMethod() const override { return std::string(Head.Method); }
+    std::string GetPath() const override { return std::string(Head.Path); }
+
+    std::string GetHeader(const std::string &name) const override
+    {
+        return std::string(Head.FindHeader(name));
+    }
+
+    std::string GetBody() const override { return std::string(Head.Body); }
+};
+
+//---------------------------------------------------------------------------
+// TConnection — one client socket, owned by the event loop
+//---------------------------------------------------------------------------
+struct EpollHttpTransport::TConnection
+{
+    uint64_t Id = 0;
+    int Fd = -1;
+    std::vector<char> In;           // received; InLength bytes are used
+    size_t InLength = 0;
+    std::string Out;                // responses not yet sent
+    size_t OutSent = 0;
+    bool Busy = false;              // a request is with the handler
+    bool ContinueSent = false;      // "100 Continue" for the current request
+    bool CloseAfterWrite = false;
+    bool PeerClosed = false;
+    std::weak_ptr<EpollStream> Stream;  // the response being streamed
+    std::weak_ptr<EpollCall> Call;      // the request with the handler
+};
+
+struct EpollHttpTransport::TCompletion
+{
+    uint64_t ConnectionId;
+    std::string Response;           // bytes to send
+    bool KeepAlive;
+    bool Ends = true;               // false: part of a stream, more follows
+    std::shared_ptr<EpollStream> Stream;    // set with a stream's head
+};
+
+//---------------------------------------------------------------------------
+// EpollStream — a streamed response body; writes become completions
+//
+// Detached by the event loop when its connection closes (and by Stop),
+// after which it never touches the transport again.
+//---------------------------------------------------------------------------
+class EpollHttpTransport::EpollStream : public ITransportStream
+{
+public:
+    EpollStream(EpollHttpTransport &owner, uint64_t connectionId, bool chunked, bool keepAlive)
+        : FOwner(owner), FConnectionId(connectionId), FChunked(chunked), FKeepAlive(keepAlive)
+    {
+    }
+
+    ~EpollStream() override
+    {
+        Close();
+    }
+
+    bool Write(const std::string &data) override
+    {
+        std::lock_guard<std::mutex> lock(FMutex);
+        if (!FOpen)
+            return false;
+        if (data.empty())
+            return true;                        // an empty chunk would end the body
+
+        std::string part;
+        if (FChunked)
+        {
+            char size[20];
+            int length = std::snprintf(size, sizeof(size), "%zx\r\n", data.size());
+            part.reserve(data.size() + static_cast<size_t>(length) + 2);
+            part.append(size, static_cast<size_t>(length));
+            part += data;
+            part += "\r\n";
+        }
+        else
+        {
+            part = data;
+        }
+        FOwner.Complete(TCompletion{FConnectionId, std::move(part), FKeepAlive, false, nullptr});
+        return true;
+    }
+
+    // Chunked streams end with the last chunk and keep the connection;
+    // the others end by closing it
+    void Close() override
+    {
+        std::lock_guard<std::mutex> lock(FMutex);
+        if (!FOpen)
+            return;
+        FOpen = false;
+        FOwner.Complete(TCompletion{FConnectionId, FChunked ? "0\r\n\r\n" : "",
+            FChunked && FKeepAlive, true, nullptr});
+    }
+
+    bool IsOpen() const override
+    {
+        std::lock_guard<std::mutex> lock(FMutex);
+        return FOpen;
+    }
+
+    void Detach()
+    {
+        std::lock_guard<std::mutex> lock(FMutex);
+        FOpen = false;
+    }
+
+private:
+    EpollHttpTransport &FOwner;
+    uint64_t FConnectionId;
+    bool FChunked;
+    bool FKeepAlive;
+    mutable std::mutex FMutex;
+    bool FOpen = true;
+};
+
+//---------------------------------------------------------------------------
+// EpollCall — a request with the handler, and the response it fills in
+//
+// The response goes out from Serve when the handler is done by then, and
+// as a completion from done otherwise. Detached like a stream when its
+// connection closes (and by Stop), after which done goes nowhere.
+//---------------------------------------------------------------------------
+class EpollHttpTransport::EpollCall
+{
+public:
+    EpollCall(EpollHttpTransport &owner, uint64_t connectionId,
+        std::unique_ptr<EpollRequest> request, bool keepAlive)
+        : Request(std::move(request)), ConnectionId(connectionId), KeepAlive(keepAlive),
+          FOwner(owner)
+    {
+    }
+
+    const std::unique_ptr<EpollRequest> Request;
+    EpollResponse Response;
+    const uint64_t ConnectionId;
+    const bool KeepAlive;
+
+    // The handler is done with the response
+    void Done()
+    {
+        std::lock_guard<std::mutex> lock(FMutex);
+        if (FDone)
+            return;
+        FDone = true;
+        if (!FReturned || FDetached)
+            return;                             // Serve sends it, or nobody
+        std::string response = ToHttp();
+        if (!response.empty())
+            FOwner.Complete(TCompletion{ConnectionId, std::move(response), KeepAlive});
+    }
+
+    // Serve is back from the endpoint: the response if it is complete
+    std::string Returned()
+    {
+        std::lock_guard<std::mutex> lock(FMutex);
+        FReturned = true;
+        return FDone ? ToHttp() : std::string();
+    }
+
+    // The endpoint threw: an error in place of the response, unless its
+    // head is out already
+    std::string Failed(const std::string &message)
+    {
+        std::lock_guard<std::mutex> lock(FMutex);
+        FReturned = true;
+        FDone = true;                           // a done still to come is too late
+        if (!Response.IsStreamed())
+        {
+            Response = EpollResponse();
+            Response.SetStatus(500);
+            Response.SetContentType("application/json; charset=utf-8");
+            Response.SetBody(McpHttpEndpoint::MakeJsonRpcError("null", -32603, message));
+        }
+        return ToHttp();
+    }
+
+    void Detach()
+    {
+        std::lock_guard<std::mutex> lock(FMutex);
+        FDetached = true;
+    }
+
+private:
+    EpollHttpTransport &FOwner;
+    std::mutex FMutex;
+    bool FReturned = false;
+    bool FDone = false;
+    bool FDetached = false;
+
+    // Empty when streamed: the stream finishes the request
+    std::string ToHttp()
+    {
+        if (Response.IsStreamed())
+            return std::string();
+
+        // HTTP/1.0 clients keep the connection only when told so
+        if (KeepAlive && Request->Head.MinorVersion == 0)
+            Response.SetHeader("Connection", "keep-alive");
+        return Response.ToHttp(KeepAlive, Request->Head.Method == "HEAD");
+    }
+};
+
+EpollHttpTransport::EpollHttpTransport(const TEpollHttpConfig &config)
+    : FConfig(config), FEndpoint(config.Cors)
+{
+}
+
+EpollHttpTransport::~EpollHttpTransport()
+{
+    Stop();
+}
+
+void EpollHttpTransport::SetRequestHandler(TMcpRequestHandler handler)
+{
+    FEndpoint.SetRequestHandler(handler);
+}
+
+void EpollHttpTransport::SetAsyncRequestHandler(TMcpAsyncRequestHandler handler)
+{
+    FEndpoint.SetAsyncRequestHandler(handler);
+}
+
+void EpollHttpTransport::SendNotification(const std::string &notificationJson)
+{
+    FEndpoint.Broadcast(notificationJson);
+}
+
+void EpollHttpTransport::SendNotificationTo(const std::string &session,
+    const std::string &notificationJson)
+{
+    FEndpoint.SendTo(session, notificationJson);
+}
+
+void EpollHttpTransport::SetSessionEndHandler(TMcpSessionEndHandler handler)
+{
+    FEndpoint.SetSessionEndHandler(handler);
+}
+
+void EpollHttpTransport::Start()
+{
+    if (FRunning.load())
+        return;
+
+    std::string endpoint = FConfig.Address + ":" + std::to_string(FConfig.Port);
+    auto fail = [this, &endpoint](const char *what) {
+        int error = errno;
+        CloseDescriptors();
+        throw std::runtime_error(std::string("EpollHttpTransport: ") + what + " " + endpoint +
+            ": " + std::strerror(error));
+    };
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<uint16_t>(FConfig.Port));
+    if (inet_pton(AF_INET, FConfig.Address.c_str(), &address.sin_addr) != 1)
+        throw std::runtime_error("EpollHttpTransport: invalid address " + endpoint);
+
+    FListenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (FListenFd < 0)
+        fail("socket");
+    int one = 1;
+    setsockopt(FListenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (bind(FListenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0)
+        fail("bind");
+    if (listen(FListenFd, SOMAXCONN) < 0)
+        fail("listen");
+
+    socklen_t length = sizeof(address);
+    getsockname(FListenFd, reinterpret_cast<sockaddr*>(&address), &length);
+    FPort = ntohs(address.sin_port);
+
+    FEpollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (FEpollFd < 0)
+        fail("epoll_create1");
+    FWakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (FWakeFd < 0)
+        fail("eventfd");
+
+    epoll_event event{};
+    event.events = EPOLLIN | EPOLLET;
+    event.data.u64 = ListenKey;
+    epoll_ctl(FEpollFd, EPOLL_CTL_ADD, FListenFd, &event);
+    event.events = EPOLLIN;
+    event.data.u64 = WakeKey;
+    epoll_ctl(FEpollFd, EPOLL_CTL_ADD, FWakeFd, &event);
+
+    if (FConfig.WorkerThreads > 0)
+        FWorkers = std::make_unique<TMcpWorkerPool>(FConfig.WorkerThreads);
+
+    FNextConnectionId = WakeKey + 1;
+    FStopping = false;
+    FRunning = true;
+    FLoopThread = std::thread([this]() { EventLoop(); });
+}
+
+void EpollHttpTransport::Stop()
+{
+    if (!FRunning.load())
+        return;
+
+    // GET streams end; their last chunk goes out if the loop gets to it
+    FEndpoint.CloseStreams();
+
+    FStopping = true;
+    Wake();
+    if (FLoopThread.joinable())
+        FLoopThread.join();
+
+    // Handlers still queued or running finish; their responses are dropped,
+    // as are those of async handlers that complete later (detached below)
+    FWorkers.reset();
+
+    // Streams still held elsewhere must not reach this transport again
+    std::vector<TCompletion> completions;
+    {
+        std::lock_guard<std::mutex> lock(FCompletionMutex);
+        completions.swap(FCompletions);
+    }
+    for (TCompletion &completion : completions)
+    {
+        if (completion.Stream)
+            completion.Stream->Detach();
+    }
+    for (auto &pair : FConnections)
+    {
+        if (std::shared_ptr<EpollStream> stream = pair.second->Stream.lock())
+            stream->Detach();
+        if (std::shared_ptr<EpollCall> call = pair.second->Call.lock())
+            call->Detach();
+        close(pair.second->Fd);
+    }
+    FConnections.clear();
+    completions.clear();
+    CloseDescriptors();
+    FRunning = false;
+}
+
+void EpollHttpTransport::CloseDescriptors()
+{
+    for (int *fd : {&FListenFd, &FEpollFd, &FWakeFd})
+    {
+        if (*fd >= 0)
+            close(*fd);
+        *fd = -1;
+    }
+}
+
+void EpollHttpTransport::Wake()
+{
+    uint64_t one = 1;
+    ssize_t written = write(FWakeFd, &one, sizeof(one));
+    (void)written;
+}
+
+//---------------------------------------------------------------------------
+// Event loop
+//---------------------------------------------------------------------------
+void EpollHttpTransport::EventLoop()
+{
+    epoll_event events[64];
+    while (!FStopping.load())
+    {
+        int count = epoll_wait(FEpollFd, events, 64, -1);
+        if (count < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+
+        for (int i = 0; i < count; i++)
+        {
+            uint64_t key = events[i].data.u64;
+            if (key == ListenKey)
+            {
+                AcceptConnections();
+            }
+            else if (key == WakeKey)
+            {
+                uint64_t value;
+                ssize_t got = read(FWakeFd, &value, sizeof(value));
+                (void)got;
+                TakeCompletions();
+            }
+            else
+            {
+                auto it = FConnections.find(key);
+                if (it == FConnections.end())
+                    continue;                   // closed earlier in this batch
+                if ((events[i].events & EPOLLERR) || !Pump(*it->second))
+                    CloseConnection(key);
+            }
+        }
+    }
+}
+
+void EpollHttpTransport::AcceptConnections()
+{
+    while (true)
+    {
+        int fd = accept4(FListenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0)
+        {
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            return;                             // EAGAIN, or out of descriptors
+        }
+
+        // Responses are written whole; do not hold them back for Nagle
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        auto conn = std::make_unique<TConnection>();
+        conn->Id = FNextConnectionId++;
+        conn->Fd = fd;
+
+        // Edge-triggered: a connection is read and written until EAGAIN
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        event.data.u64 = conn->Id;
+        if (epoll_ctl(FEpollFd, EPOLL_CTL_ADD, fd, &event) < 0)
+        {
+            close(fd);
+            continue;
+        }
+        FConnections.emplace(conn->Id, std::move(conn));
+    }
+}
+
+void EpollHttpTransport::TakeCompletions()
+{
+    std::vector<TCompletion> completions;
+    {
+        std::lock_guard<std::mutex> lock(FCompletionMutex);
+        completions.swap(FCompletions);
+    }
+
+    for (TCompletion &completion : completions)
+    {
+        auto it = FConnections.find(completion.ConnectionId);
+        if (it == FConnections.end())
+        {
+            // The client went away meanwhile
+            if (completion.Stream)
+                completion.Stream->Detach();
+            continue;
+        }
+
+        TConnection &conn = *it->second;
+        if (completion.Stream)
+            conn.Stream = completion.Stream;
+        if (completion.Ends)
+        {
+            Finish(conn, std::move(completion.Response), completion.KeepAlive);
+        }
+        else
+        {
+            conn.Out += completion.Response;
+            if (conn.Out.size() - conn.OutSent > FConfig.MaxStreamBacklog)
+            {
+                CloseConnection(completion.ConnectionId);
+                continue;
+            }
+        }
+        if (!Pump(conn))
+            CloseConnection(completion.ConnectionId);
+    }
+}
+
+// Called from any thread
+void EpollHttpTransport::Complete(TCompletion completion)
+{
+    {
+        std::lock_guard<std::mutex> lock(FCompletionMutex);
+        FCompletions.push_back(std::move(completion));
+    }
+    Wake();
+}
+
+// Reads, serves and writes as far as possible without blocking; false
+// when the connection is done with
+bool EpollHttpTransport::Pump(TConnection &conn)
+{
+    size_t limit = FConfig.Limits.MaxHeaderBytes + FConfig.Limits.MaxBodyBytes;
+    while (true)
+    {
+        if (!ReadInput(conn))
+            return false;
+        bool full = conn.InLength >= limit;
+        ProcessInput(conn);
+        if (!Flush(conn))
+            return false;
+
+        // Reading stopped at the buffer limit rather than at EAGAIN: go on
+        // once a request has made room, or the edge-triggered socket
+        // would stay silent
+        if (!full || conn.InLength >= limit)
+            break;
+    }
+
+    if (!conn.Busy && conn.Out.empty() && (conn.CloseAfterWrite || conn.PeerClosed))
+        return false;
+
+    // A client that hangs up on a stream is done listening
+    if (conn.PeerClosed && !conn.Stream.expired())
+        return false;
+    return true;
+}
+
+// False on a socket error
+bool EpollHttpTransport::ReadInput(TConnection &conn)
+{
+    size_t limit = FConfig.Limits.MaxHeaderBytes + FConfig.Limits.MaxBodyBytes;
+    while (!conn.PeerClosed && !conn.CloseAfterWrite && conn.InLength < limit)
+    {
+        if (conn.In.size() - conn.InLength < ReadChunk / 4)
+            conn.In.resize(std::max(conn.In.size() * 2, conn.InLength + ReadChunk));
+
+        ssize_t n = recv(conn.Fd, conn.In.data() + conn.InLength,
+            conn.In.size() - conn.InLength, 0);
+        if (n > 0)
+        {
+            conn.InLength += static_cast<size_t>(n);
+            continue;
+        }
+        if (n == 0)
+        {
+            conn.PeerClosed = true;
+            break;
+        }
+        if (errno == EINTR)
+            continue;
+        return errno == EAGAIN || errno == EWOULDBLOCK;
+    }
+    return true;
+}
+
+// Hands the next complete request to the handler; one per connection at
+// a time, so pipelined responses go out in request order
+void EpollHttpTransport::ProcessInput(TConnection &conn)
+{
+    while (!conn.Busy && !conn.CloseAfterWrite && conn.InLength > 0)
+    {
+        auto request = std::make_unique<EpollRequest>();
+        int errorStatus = 400;
+        THttpParseStatus status = HttpRequestParser::Parse(conn.In.data(), conn.InLength,
+            FConfig.Limits, request->Head, errorStatus);
+
+        if (status == THttpParseStatus::Incomplete)
+        {
+            if (request->Head.ExpectContinue && !conn.ContinueSent)
+            {
+                conn.Out += "HTTP/1.1 100 Continue\r\n\r\n";
+                conn.ContinueSent = true;
+            }
+            return;
+        }
+
+        if (status == THttpParseStatus::Error)
+        {
+            EpollResponse resp;
+            resp.SetStatus(errorStatus);
+            resp.SetContentType("application/json; charset=utf-8");
+            resp.SetBody(McpHttpEndpoint::MakeJsonRpcError("null", -32600,
+                ParseErrorMessage(errorStatus)));
+            conn.InLength = 0;
+            Finish(conn, resp.ToHttp(false, false), false);
+            return;
+        }
+
+        // The request takes the buffer (its views point into it); bytes of
+        // pipelined requests after it move to a new one
+        size_t used = request->Head.Length;
+        std::vector<char> rest(conn.In.begin() + used, conn.In.begin() + conn.InLength);
+        request->Buffer.swap(conn.In);
+        conn.In.swap(rest);
+        conn.InLength = conn.In.size();
+        conn.ContinueSent = false;
+        conn.Busy = true;
+        Dispatch(conn, std::move(request));
+    }
+}
+
+// False on a socket error
+bool EpollHttpTransport::Flush(TConnection &conn)
+{
+    while (conn.OutSent < conn.Out.size())
+    {
+        ssize_t n = send(conn.Fd, conn.Out.data() + conn.OutSent,
+            conn.Out.size() - conn.OutSent, MSG_NOSIGNAL);
+        if (n > 0)
+        {
+            conn.OutSent += static_cast<size_t>(n);
+            continue;
+        }
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return true;                        // EPOLLOUT resumes
+        return false;
+    }
+    conn.Out.clear();
+    conn.OutSent = 0;
+    return true;
+}
+
+void EpollHttpTransport::Dispatch(TConnection &conn, std::unique_ptr<EpollRequest> request)
+{
+    bool keepAlive = request->Head.KeepAlive && !FStopping.load();
+    auto call = std::make_shared<EpollCall>(*this, conn.Id, std::move(request), keepAlive);
+    conn.Call = call;
+
+    if (!FWorkers)
+    {
+        std::string response = Serve(call);
+        if (!response.empty())
+            Finish(conn, std::move(response), keepAlive);
+        return;
+    }
+
+    FWorkers->Submit([this, call]() {
+        std::string response = Serve(call);
+        if (!response.empty())
+            Complete(TCompletion{call->ConnectionId, std::move(response), call->KeepAlive});
+    });
+}
+
+void EpollHttpTransport::Finish(TConnection &conn, std::string response, bool keepAlive)
+{
+    if (conn.Out.empty())
+        conn.Out.swap(response);
+    else
+        conn.Out += response;
+    conn.Busy = false;
+    conn.Stream.reset();
+    conn.Call.reset();
+    if (!keepAlive)
+        conn.CloseAfterWrite = true;
+}
+
+// Runs the endpoint for one request; called on a worker (or the loop).
+// Empty when the response is streamed, or the async handler is not done
+// yet: its stream, or its done, finishes the request.
+std::string EpollHttpTransport::Serve(const std::shared_ptr<EpollCall> &call)
+{
+    MCP_TRACE_SCOPE("http.request");
+    uint64_t connectionId = call->ConnectionId;
+    bool keepAlive = call->KeepAlive;
+    bool chunked = call->Request->Head.MinorVersion == 1;
+    call->Response.EnableStreaming(chunked, keepAlive,
+        [this, connectionId, chunked, keepAlive](std::string head) {
+            auto stream = std::make_shared<EpollStream>(*this, connectionId, chunked, keepAlive);
+            Complete(TCompletion{connectionId, std::move(head), keepAlive, false, stream});
+            return std::shared_ptr<ITransportStream>(stream);
+        });
+    try
+    {
+        FEndpoint.HandleAsync(*call->Request, call->Response, [call]() { call->Done(); });
+    }
+    catch (const std::exception &e)
+    {
+        return call->Failed(e.what());
+    }
+    return call->Returned();
+}
+
+void EpollHttpTransport::CloseConnection(uint64_t id)
+{
+    auto it = FConnections.find(id);
+    if (it == FConnections.end())
+        return;
+    if (std::shared_ptr<EpollStream> stream = it->second->Stream.lock())
+        stream->Detach();
+    if (std::shared_ptr<EpollCall> call = it->second->Call.lock())
+        call->Detach();
+    close(it->second->Fd);                      // also leaves the epoll set
+    FConnections.erase(it);
+}
+
+}} // namespace Mcp::Transport
@@ -0,0 +1,138 @@
+//---------------------------------------------------------------------------
+// EpollHttpTransport.h — Native HTTP/1.1 transport for MCP on Linux
+//
+// One event-loop thread owns every socket: it accepts, reads, parses
+// requests in place (HttpRequestParser) and writes responses. Handlers run
+// on a worker pool, so a slow tool call does not hold up other
+// connections. A handler set with SetAsyncRequestHandler gives its worker
+// back as soon as it returns and answers when its call completes, so long
+// polls such as ui_wait_events hold no thread at all. Connections are
+// kept alive; pipelined requests are served in order, one at a time per
+// connection. /mcp is answered by McpHttpEndpoint, exactly as
+// HttpTransport answers it under Indy.
+//
+// Streamed responses (SSE on GET /mcp, progress on POST) hold no thread:
+// writes from any thread are queued to the event loop like completed
+// responses. HTTP/1.1 streams are chunked, so the connection is kept
+// once a POST stream ends; HTTP/1.0 streams end by closing it.
+//
+// Linux only (epoll, eventfd); not part of ClaBot.cbproj.
+//---------------------------------------------------------------------------
+
+#ifndef EpollHttpTransportH
+#define EpollHttpTransportH
+//---------------------------------------------------------------------------
+#include "../ITransport.h"
+#include "../TransportTypes.h"
+#include "../http/McpHttpEndpoint.h"
+#include "HttpRequestParser.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+//---------------------------------------------------------------------------
+
+namespace Mcp {
+
+class TMcpWorkerPool;
+
+namespace Transport {
+
+struct TEpollHttpConfig
+{
+    std::string Address = "127.0.0.1";   // IPv4 address to listen on
+    int Port = 0;                        // 0: any free port (see GetPort)
+    unsigned WorkerThreads = 4;          // 0: handlers run on the event loop
+    THttpParseLimits Limits;
+    TCorsConfig Cors;
+
+    // Unsent bytes an event stream may queue before its client, which has
+    // stopped reading, is dropped
+    size_t MaxStreamBacklog = 4 * 1024 * 1024;
+};
+
+class EpollHttpTransport : public ITransport
+{
+public:
+    explicit EpollHttpTransport(const TEpollHttpConfig &config = TEpollHttpConfig());
+    ~EpollHttpTransport() override;
+
+    EpollHttpTransport(const EpollHttpTransport&) = delete;
+    EpollHttpTransport& operator=(const EpollHttpTransport&) = delete;
+
+    // Throws std::runtime_error when the address cannot be bound
+    void Start() override;
+
+    // Waits for handlers in progress, like stopping Indy does
+    void Stop() override;
+
+    bool IsRunning() const override { return FRunning.load(); }
+    std::string GetName() const override { return "http-epoll"; }
+    void SetRequestHandler(TMcpRequestHandler handler) override;
+
+    // Used instead of the request handler; set before Start
+    void SetAsyncRequestHandler(TMcpAsyncRequestHandler handler);
+
+    // Written to the GET /mcp event streams (of that session)
+    void SendNotification(const std::string &notificationJson) override;
+    void SendNotificationTo(const std::string &session,
+        const std::string &notificationJson) override;
+
+    // Called on DELETE /mcp
+    void SetSessionEndHandler(TMcpSessionEndHandler handler) override;
+
+    // The port actually bound (after Start)
+    int GetPort() const { return FPort; }
+
+private:
+    struct TConnection;
+    struct TCompletion;
+    class EpollRequest;
+    class EpollStream;
+    class EpollCall;
+
+    TEpollHttpConfig FConfig;
+    McpHttpEndpoint FEndpoint;
+    int FPort = 0;
+
+    int FListenFd = -1;
+    int FEpollFd = -1;
+    int FWakeFd = -1;                    // eventfd: completions or Stop
+    std::thread FLoopThread;
+    std::unique_ptr<TMcpWorkerPool> FWorkers;
+    std::atomic<bool> FRunning{false};
+    std::atomic<bool> FStopping{false};
+
+    // Owned by the event loop thread
+    std::unordered_map<uint64_t, std::unique_ptr<TConnection>> FConnections;
+    uint64_t FNextConnectionId = 0;
+
+    // Responses finished by workers and stream writes, picked up by the
+    // event loop in order
+    std::mutex FCompletionMutex;
+    std::vector<TCompletion> FCompletions;
+
+    void EventLoop();
+    void AcceptConnections();
+    void TakeCompletions();
+    bool Pump(TConnection &conn);
+    bool ReadInput(TConnection &conn);
+    void ProcessInput(TConnection &conn);
+    bool Flush(TConnection &conn);
+    void Dispatch(TConnection &conn, std::unique_ptr<EpollRequest> request);
+    void Finish(TConnection &conn, std::string response, bool keepAlive);
+    std::string Serve(const std::shared_ptr<EpollCall> &call);
+    void Complete(TCompletion completion);
+    void CloseConnection(uint64_t id);
+    void Wake();
+    void CloseDescriptors();
+};
+
+}} // namespace Mcp::Transport
+
+//---------------------------------------------------------------------------
+#endif
@@ -0,0 +1,270 @@
+//---------------------------------------------------------------------------
+// HttpRequestParser.h — Zero-copy HTTP/1.1 request parser
+//
+// Parses one request at the start of a receive buffer. The result refers
+// into that buffer (method, path, header names and values, body), so
+// nothing is copied or allocated; the buffer must outlive it. Bodies need
+// Content-Length: chunked requests are refused (MCP clients send JSON
+// bodies of known length).
+// Pure C++ - NO VCL dependencies.
+//---------------------------------------------------------------------------
+
+#ifndef HttpRequestParserH
+#define HttpRequestParserH
+//---------------------------------------------------------------------------
+#include <string_view>
+#include <cstddef>
+#include <cstdint>
+//---------------------------------------------------------------------------
+
+namespace Mcp { namespace Transport {
+
+struct THttpHeader
+{
+    std::string_view Name;
+    std::string_view Value;
+};
+
+struct THttpRequestHead
+{
+    static constexpr size_t MaxHeaders = 64;
+
+    std::string_view Method;
+    std::string_view Target;        // "/mcp?x=1"
+    std::string_view Path;          // "/mcp"
+    int MinorVersion = 1;           // HTTP/1.x
+    THttpHeader Headers[MaxHeaders];
+    size_t HeaderCount = 0;
+    std::string_view Body;
+    size_t Length = 0;              // bytes of the whole request
+    bool KeepAlive = true;
+    bool ExpectContinue = false;
+
+    // Value of the first header with this name (any case), or empty
+    std::string_view FindHeader(std::string_view name) const
+    {
+        for (size_t i = 0; i < HeaderCount; i++)
+        {
+            if (EqualsNoCase(Headers[i].Name, name))
+                return Headers[i].Value;
+        }
+        return std::string_view();
+    }
+
+    static bool EqualsNoCase(std::string_view a, std::string_view b)
+    {
+        if (a.size() != b.size())
+            return false;
+        for (size_t i = 0; i < a.size(); i++)
+        {
+            if (ToLower(a[i]) != ToLower(b[i]))
+                return false;
+        }
+        return true;
+    }
+
+    static bool ContainsNoCase(std::string_view text, std::string_view part)
+    {
+        for (size_t i = 0; i + part.size() <= text.size(); i++)
+        {
+            if (EqualsNoCase(text.substr(i, part.size()), part))
+                return true;
+        }
+        return false;
+    }
+
+    static char ToLower(char c)
+    {
+        return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+    }
+};
+
+enum class THttpParseStatus
+{
+    Complete,       // head is filled; Length bytes belong to the request
+    Incomplete,     // more bytes needed (ExpectContinue is set once the head is in)
+    Error           // answer with the given status and close
+};
+
+struct THttpParseLimits
+{
+    size_t MaxHeaderBytes = 64 * 1024;
+    size_t MaxBodyBytes = 16 * 1024 * 1024;
+};
+
+class HttpRequestParser
+{
+public:
+    // Parses the request at the start of data. On Error, errorStatus is
+    // the status to answer: 400, 413, 431, 501 or 505.
+    static THttpParseStatus Parse(const char *data, size_t size, const THttpParseLimits &limits,
+        THttpRequestHead &head, int &errorStatus)
+    {
+        std::string_view input(data, size);
+
+        // Empty lines before a request are ignored (RFC 9112, 2.2)
+        size_t start = 0;
+        while (start < input.size() && (input[start] == '\r' || input[start] == '\n'))
+            start++;
+
+        size_t headEnd = input.find("\r\n\r\n", start);
+        if (headEnd == std::string_view::npos)
+        {
+            if (input.size() > limits.MaxHeaderBytes)
+                return Fail(errorStatus, 431);
+            return THttpParseStatus::Incomplete;
+        }
+        if (headEnd - start > limits.MaxHeaderBytes)
+            return Fail(errorStatus, 431);
+
+        // Request line: method SP target SP HTTP/1.x
+        size_t lineEnd = input.find("\r\n", start);
+        std::string_view line = input.substr(start, lineEnd - start);
+        size_t space1 = line.find(' ');
+        size_t space2 = space1 == std::string_view::npos ?
+            std::string_view::npos : line.find(' ', space1 + 1);
+        if (space2 == std::string_view::npos || space1 == 0 || space2 == space1 + 1)
+            return Fail(errorStatus, 400);
+
+        head.Method = line.substr(0, space1);
+        head.Target = line.substr(space1 + 1, space2 - space1 - 1);
+        std::string_view version = line.substr(space2 + 1);
+        if (!IsToken(head.Method) || !IsTarget(head.Target))
+            return Fail(errorStatus, 400);
+        if (version.size() != 8 || version.compare(0, 5, "HTTP/") != 0)
+            return Fail(errorStatus, 400);
+        if (version[5] != '1' || version[6] != '.' || (version[7] != '0' && version[7] != '1'))
+            return Fail(errorStatus, 505);
+        head.MinorVersion = version[7] - '0';
+        head.Path = head.Target.substr(0, head.Target.find('?'));
+
+        // Header fields
+        head.HeaderCount = 0;
+        size_t pos = lineEnd + 2;
+        while (pos < headEnd + 2)
+        {
+            size_t end = input.find("\r\n", pos);
+            std::string_view field = input.substr(pos, end - pos);
+            pos = end + 2;
+
+            size_t colon = field.find(':');
+            if (colon == std::string_view::npos || colon == 0 ||
+                !IsToken(field.substr(0, colon)))
+                return Fail(errorStatus, 400);      // also rejects obsolete line folding
+            if (head.HeaderCount == THttpRequestHead::MaxHeaders)
+                return Fail(errorStatus, 431);
+
+            std::string_view value = Trim(field.substr(colon + 1));
+            for (char c : value)
+            {
+                if (c == '\0' || c == '\r' || c == '\n')
+                    return Fail(errorStatus, 400);
+            }
+            head.Headers[head.HeaderCount++] = THttpHeader{field.substr(0, colon), value};
+        }
+
+        // Body length
+        uint64_t contentLength = 0;
+        bool hasLength = false;
+        head.KeepAlive = head.MinorVersion == 1;
+        head.ExpectContinue = false;
+        for (size_t i = 0; i < head.HeaderCount; i++)
+        {
+            const THttpHeader &h = head.Headers[i];
+            if (THttpRequestHead::EqualsNoCase(h.Name, "Content-Length"))
+            {
+                uint64_t length;
+                if (!ParseLength(h.Value, length) || (hasLength && length != contentLength))
+                    return Fail(errorStatus, 400);
+                contentLength = length;
+                hasLength = true;
+            }
+            else if (THttpRequestHead::EqualsNoCase(h.Name, "Transfer-Encoding"))
+            {
+                return Fail(errorStatus, 501);
+            }
+            else if (THttpRequestHead::EqualsNoCase(h.Name, "Connection"))
+            {
+                if (THttpRequestHead::ContainsNoCase(h.Value, "close"))
+                    head.KeepAlive = false;
+                else if (THttpRequestHead::ContainsNoCase(h.Value, "keep-alive"))
+                    head.KeepAlive = true;
+            }
+            else if (THttpRequestHead::EqualsNoCase(h.Name, "Expect"))
+            {
+                head.ExpectContinue = THttpRequestHead::EqualsNoCase(h.Value, "100-continue");
+            }
+        }
+        if (contentLength > limits.MaxBodyBytes)
+            return Fail(errorStatus, 413);
+
+        size_t bodyStart = headEnd + 4;
+        if (input.size() - bodyStart < contentLength)
+            return THttpParseStatus::Incomplete;
+
+        head.Body = input.substr(bodyStart, static_cast<size_t>(contentLength));
+        head.Length = bodyStart + static_cast<size_t>(contentLength);
+        return THttpParseStatus::Complete;
+    }
+
+private:
+    static THttpParseStatus Fail(int &errorStatus, int status)
+    {
+        errorStatus = status;
+        return THttpParseStatus::Error;
+    }
+
+    // RFC 9110 token characters
+    static bool IsToken(std::string_view text)
+    {
+        if (text.empty())
+            return false;
+        for (char c : text)
+        {
+            unsigned char u = static_cast<unsigned char>(c);
+            bool alnum = (u >= '0' && u <= '9') || (u >= 'a' && u <= 'z') || (u >= 'A' && u <= 'Z');
+            if (!alnum && std::string_view("!#$%&'*+-.^_`|~").find(c) == std::string_view::npos)
+                return false;
+        }
+        return true;
+    }
+
+    static bool IsTarget(std::string_view text)
+    {
+        for (char c : text)
+        {
+            unsigned char u = static_cast<unsigned char>(c);
+            if (u <= 0x20 || u == 0x7F)
+                return false;
+        }
+        return true;
+    }
+
+    static std::string_view Trim(std::string_view text)
+    {
+        while (!text.empty() && (text.front() == ' ' || text.front() == '\t'))
+            text.remove_prefix(1);
+        while (!text.empty() && (text.back() == ' ' || text.back() == '\t'))
+            text.remove_suffix(1);
+        return text;
+    }
+
+    static bool ParseLength(std::string_view text, uint64_t &value)
+    {
+        if (text.empty() || text.size() > 15)
+            return false;
+        value = 0;
+        for (char c : text)
+        {
+            if (c < '0' || c > '9')
+                return false;
+            value = value * 10 + static_cast<uint64_t>(c - '0');
+        }
+        return true;
+    }
+};
+
+}} // namespace Mcp::Transport
+
+//---------------------------------------------------------------------------
+#endif
@@ -28,17 +28,31 @@ TCorsResult CorsValidator::Validate(const ITransportRequest &req, bool isPreflig
             return result;
         }
 
+        // Binary types are negotiated by McpWireFormat
         std::string acceptLower = ToLower(accept);
         if (acceptLower.find("application/json") == std::string::npos &&
-            acceptLower.find("*/*") == std::string::npos)
+            acceptLower.find("*/*") == std::string::npos &&
+            acceptLower.find("application/cbor") == std::string::npos &&
+            acceptLower.find("msgpack") == std::string::npos)
         {
             result.Allowed = false;
             result.StatusCode = 406;
-            result.ErrorMessage = "Accept header must include application/json.";
+            result.ErrorMessage = "Accept header must include application/json "
+                "(or application/cbor, application/msgpack).";
             return result;
         }
     }
 
+    return CheckOrigin(req, result);
+}
+
+TCorsResult CorsValidator::ValidateOrigin(const ITransportRequest &req) const
+{
+    return CheckOrigin(req, TCorsResult());
+}
+
+TCorsResult CorsValidator::CheckOrigin(const ITransportRequest &req, TCorsResult result) const
+{
     // Origin validation (if present)
     std::string origin = req.GetHeader("Origin");
     if (!origin.empty())
@@ -67,6 +81,8 @@ void CorsValidator::ApplyHeaders(const TCorsResult &result, ITransportResponse &
     resp.SetHeader("Access-Control-Allow-Origin", result.Origin);
     resp.SetHeader("Access-Control-Allow-Methods", FConfig.AllowMethods);
     resp.SetHeader("Access-Control-Allow-Headers", FConfig.AllowHeaders);
+    if (!FConfig.ExposeHeaders.empty())
+        resp.SetHeader("Access-Control-Expose-Headers", FConfig.ExposeHeaders);
     resp.SetHeader("Vary", "Origin");
 }
 
@@ -18,11 +18,15 @@ public:
     explicit CorsValidator(const TCorsConfig &config);
 
     TCorsResult Validate(const ITransportRequest &req, bool isPreflight) const;
+
+    // Origin only; for requests that do not negotiate a JSON body (GET)
+    TCorsResult ValidateOrigin(const ITransportRequest &req) const;
     void ApplyHeaders(const TCorsResult &result, ITransportResponse &resp) const;
 
 private:
     TCorsConfig FConfig;
 
+    TCorsResult CheckOrigin(const ITransportRequest &req, TCorsResult result) const;
     bool IsOriginAllowed(const std::string &origin) const;
     static std::string ToLower(const std::string &s);
 };
@@ -73,21 +73,20 @@ public:
         if (!FRequestInfo)
             return "";
 
-        String body;
+        // Raw bytes: the body may be UTF-8 JSON or binary CBOR/MessagePack
         if (FRequestInfo->PostStream != NULL)
         {
-            TStringStream *ss = new TStringStream(L"", TEncoding::UTF8, false);
-            ss->CopyFrom(FRequestInfo->PostStream, 0);
-            body = ss->DataString;
-            delete ss;
-            FRequestInfo->PostStream->Position = 0;
+            TStream *stream = FRequestInfo->PostStream;
+            stream->Position = 0;
+            FBody.resize(static_cast<size_t>(stream->Size));
+            if (!FBody.empty())
+                stream->ReadBuffer(&FBody[0], static_cast<NativeInt>(FBody.size()));
+            stream->Position = 0;
         }
         else
         {
-            body = FRequestInfo->UnparsedParams;
+            FBody = utf8(FRequestInfo->UnparsedParams);
         }
-
-        FBody = utf8(body);
         return FBody;
     }
 
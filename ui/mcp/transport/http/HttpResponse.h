@@ -6,17 +6,152 @@
 #define HttpResponseH
 //---------------------------------------------------------------------------
 #include "../ITransportResponse.h"
+#include "../ITransportStream.h"
 #include "UcodeUtf8.h"
+#include "../../McpTrace.h"
+#include <System.Classes.hpp>
 #include <IdHTTPServer.hpp>
+#include <IdGlobal.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
 //---------------------------------------------------------------------------
 
 namespace Mcp { namespace Transport {
 
+//---------------------------------------------------------------------------
+// HttpStream — a response body written to the Indy connection by its own
+// connection thread
+//
+// Indy ends the response when OnCommandGet returns, so HttpTransport
+// keeps the connection thread in Flush while the stream is open. Write
+// only queues, so the threads that send notifications (the timer thread,
+// the VCL thread) never block on a slow client; a client that lets more
+// than MaxBacklog bytes pile up is dropped. The headers go out with the
+// first flush, on that thread too. The body ends with the connection (no
+// Content-Length).
+//---------------------------------------------------------------------------
+class HttpStream : public ITransportStream
+{
+public:
+    // Unsent bytes a stream may queue before its client is dropped, as
+    // TEpollHttpConfig::MaxStreamBacklog
+    static const size_t DefaultMaxBacklog = 4 * 1024 * 1024;
+
+    HttpStream(TIdContext *context, TIdHTTPResponseInfo *responseInfo,
+        size_t maxBacklog = DefaultMaxBacklog)
+        : FContext(context), FHeaderInfo(responseInfo), FMaxBacklog(maxBacklog)
+    {
+    }
+
+    ~HttpStream() override
+    {
+        Close();
+    }
+
+    bool Write(const std::string &data) override
+    {
+        std::lock_guard<std::mutex> lock(FMutex);
+        if (!FOpen || FClosing)
+            return false;
+        if (FQueuedBytes + data.size() > FMaxBacklog)
+        {
+            // The client has stopped reading
+            Drop();
+            return false;
+        }
+        FQueue.push_back(data);
+        FQueuedBytes += data.size();
+        FChanged.notify_all();
+        return true;
+    }
+
+    // Data already queued is still sent
+    void Close() override
+    {
+        std::lock_guard<std::mutex> lock(FMutex);
+        FClosing = true;
+        FChanged.notify_all();
+    }
+
+    bool IsOpen() const override
+    {
+        std::lock_guard<std::mutex> lock(FMutex);
+        return FOpen && !FClosing;
+    }
+
+    // Connection thread only: waits up to timeout for queued data and
+    // writes it. False once the stream is done (closed and flushed, or the
+    // client has gone); idle tells that the timeout passed with nothing
+    // to write.
+    bool Flush(std::chrono::milliseconds timeout, bool &idle)
+    {
+        std::deque<std::string> pending;
+        {
+            std::unique_lock<std::mutex> lock(FMutex);
+            idle = !FChanged.wait_for(lock, timeout,
+                [this]() { return !FQueue.empty() || FHeaderInfo || FClosing || !FOpen; });
+            if (!FOpen)
+                return false;
+            if (FQueue.empty() && !FHeaderInfo)
+                return !FClosing;
+            pending.swap(FQueue);
+            FQueuedBytes = 0;
+        }
+
+        // The blocking writes happen here, outside the lock
+        try
+        {
+            if (FHeaderInfo)
+            {
+                FHeaderInfo->WriteHeader();
+                FHeaderInfo = nullptr;
+            }
+            for (const std::string &data : pending)
+            {
+                FContext->Connection->IOHandler->Write(
+                    RawToBytes(data.data(), static_cast<int>(data.size())));
+            }
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(FMutex);
+            Drop();
+            return false;
+        }
+        return true;
+    }
+
+private:
+    // FMutex held
+    void Drop()
+    {
+        FOpen = false;
+        FQueue.clear();
+        FQueuedBytes = 0;
+        FChanged.notify_all();
+    }
+
+    TIdContext *FContext;
+    TIdHTTPResponseInfo *FHeaderInfo;    // until the headers are written; Flush only
+    size_t FMaxBacklog;
+    mutable std::mutex FMutex;
+    std::condition_variable FChanged;
+    std::deque<std::string> FQueue;
+    size_t FQueuedBytes = 0;
+    bool FOpen = true;                   // false once the client has gone
+    bool FClosing = false;               // Close called; the queue drains
+};
+
 class HttpResponse : public ITransportResponse
 {
 public:
-    explicit HttpResponse(TIdHTTPResponseInfo *responseInfo)
-        : FResponseInfo(responseInfo)
+    // Streaming (BeginStream) needs the connection's context
+    explicit HttpResponse(TIdHTTPResponseInfo *responseInfo, TIdContext *context = nullptr)
+        : FResponseInfo(responseInfo), FContext(context)
     {
     }
 
@@ -47,7 +182,19 @@ public:
     {
         if (!FResponseInfo)
             return;
-        FResponseInfo->ContentText = u(body);
+        MCP_TRACE_SCOPE("http.write_body");
+        // Bytes go out as-is, so binary (CBOR/MessagePack) bodies survive
+        // and JSON skips the round trip through a UTF-16 String
+        TMemoryStream *stream = new TMemoryStream();
+        if (!body.empty())
+            stream->WriteBuffer(body.data(), static_cast<NativeInt>(body.size()));
+        stream->Position = 0;
+
+        ReleaseContentStream();
+        FResponseInfo->ContentText = "";
+        FResponseInfo->ContentStream = stream;
+        FResponseInfo->FreeContentStream = true;
+        FResponseInfo->ContentLength = static_cast<__int64>(body.size());
     }
 
     void SetNoContent() override
@@ -57,12 +204,40 @@ public:
         FResponseInfo->ResponseNo = 202;
         FResponseInfo->ResponseText = "Accepted";
         FResponseInfo->ContentText = "";
+        ReleaseContentStream();
         FResponseInfo->ContentType = "";
         FResponseInfo->ContentLength = 0;
     }
 
+    std::shared_ptr<ITransportStream> BeginStream(const std::string &contentType) override
+    {
+        if (!FResponseInfo || !FContext || FStream)
+            return nullptr;
+        FResponseInfo->ContentType = u(contentType);
+        FResponseInfo->ContentText = "";
+        ReleaseContentStream();
+        FResponseInfo->ContentLength = -1;
+        FResponseInfo->CloseConnection = true;
+        FStream = std::make_shared<HttpStream>(FContext, FResponseInfo);
+        return FStream;
+    }
+
+    // The stream BeginStream started, if any
+    std::shared_ptr<HttpStream> GetStream() const { return FStream; }
+
 private:
+    // A body set earlier for the same response is replaced, not leaked
+    void ReleaseContentStream()
+    {
+        TStream *previous = FResponseInfo->ContentStream;
+        FResponseInfo->ContentStream = NULL;
+        if (previous && FResponseInfo->FreeContentStream)
+            delete previous;
+    }
+
     TIdHTTPResponseInfo *FResponseInfo = nullptr;
+    TIdContext *FContext = nullptr;
+    std::shared_ptr<HttpStream> FStream;
 };
 
 }} // namespace Mcp::Transport
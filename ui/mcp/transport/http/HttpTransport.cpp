@@ -3,12 +3,20 @@
 //---------------------------------------------------------------------------
 
 #include "HttpTransport.h"
-#include <cstdio>
+#include "McpSse.h"
 
 namespace Mcp { namespace Transport {
 
+namespace {
+
+// How often an idle event stream is written to; a write is the only way
+// to notice that its client has gone
+const std::chrono::seconds StreamKeepAliveInterval(15);
+
+} // namespace
+
 HttpTransport::HttpTransport(TIdHTTPServer *server, const TCorsConfig &corsConfig)
-    : FServer(server), FCorsValidator(corsConfig)
+    : FServer(server), FEndpoint(corsConfig)
 {
 }
 
@@ -20,6 +28,9 @@ void HttpTransport::Start()
 
 void HttpTransport::Stop()
 {
+    // Deactivating waits for every connection thread, including those
+    // holding event streams open
+    FEndpoint.CloseStreams();
     if (FServer)
         FServer->Active = false;
 }
@@ -31,135 +42,55 @@ bool HttpTransport::IsRunning() const
 
 void HttpTransport::SetRequestHandler(TMcpRequestHandler handler)
 {
-    FHandler = handler;
+    FEndpoint.SetRequestHandler(handler);
 }
 
-void HttpTransport::HandleCommandGet(TIdContext *, TIdHTTPRequestInfo *requestInfo,
-    TIdHTTPResponseInfo *responseInfo)
+void HttpTransport::SendNotification(const std::string &notificationJson)
 {
-    if (!requestInfo || !responseInfo)
-        return;
-
-    HttpRequest req(requestInfo);
-    HttpResponse resp(responseInfo);
-
-    HandleMcpRequest(req, resp);
+    FEndpoint.Broadcast(notificationJson);
 }
 
-void HttpTransport::HandleMcpRequest(HttpRequest &req, HttpResponse &resp)
+void HttpTransport::SendNotificationTo(const std::string &session,
+    const std::string &notificationJson)
 {
-    std::string path = req.GetPath();
-    if (!McpHttpRouter::IsMcpPath(path))
-    {
-        resp.SetStatus(404, "Not Found");
-        resp.SetContentType("application/json; charset=utf-8");
-        resp.SetBody("{\"error\":\"not found\"}");
-        return;
-    }
-
-    std::string method = req.GetMethod();
-    if (method == "GET" && path == "/mcp")
-    {
-        resp.SetStatus(405, "Method Not Allowed");
-        resp.SetContentType("application/json; charset=utf-8");
-        resp.SetBody(MakeJsonRpcError("null", -32600,
-            "SSE transport not supported. Use POST."));
-        return;
-    }
-
-    bool isPreflight = (method == "OPTIONS");
-    if (isPreflight)
-    {
-        TCorsResult cors = FCorsValidator.Validate(req, true);
-        if (!cors.Allowed)
-        {
-            if (cors.HasOrigin)
-                FCorsValidator.ApplyHeaders(cors, resp);
-            resp.SetStatus(cors.StatusCode);
-            resp.SetContentType("application/json; charset=utf-8");
-            resp.SetBody(MakeJsonRpcError("null", -32600, cors.ErrorMessage));
-            return;
-        }
-
-        if (cors.HasOrigin)
-            FCorsValidator.ApplyHeaders(cors, resp);
+    FEndpoint.SendTo(session, notificationJson);
+}
 
-        resp.SetStatus(204, "No Content");
-        resp.SetContentType("");
-        resp.SetBody("");
-        return;
-    }
+void HttpTransport::SetSessionEndHandler(TMcpSessionEndHandler handler)
+{
+    FEndpoint.SetSessionEndHandler(handler);
+}
 
-    if (method != "POST")
-    {
-        resp.SetStatus(405, "Method Not Allowed");
-        resp.SetContentType("application/json; charset=utf-8");
-        resp.SetBody(MakeJsonRpcError("null", -32600,
-            "Method not allowed. Use POST."));
+void HttpTransport::HandleCommandGet(TIdContext *context, TIdHTTPRequestInfo *requestInfo,
+    TIdHTTPResponseInfo *responseInfo)
+{
+    if (!requestInfo || !responseInfo)
         return;
-    }
 
-    TCorsResult cors = FCorsValidator.Validate(req, false);
-    if (!cors.Allowed)
+    std::shared_ptr<HttpStream> stream;
     {
-        if (cors.HasOrigin)
-            FCorsValidator.ApplyHeaders(cors, resp);
-        resp.SetStatus(cors.StatusCode);
-        resp.SetContentType("application/json; charset=utf-8");
-        resp.SetBody(MakeJsonRpcError("null", -32600, cors.ErrorMessage));
-        return;
-    }
-
-    if (cors.HasOrigin)
-        FCorsValidator.ApplyHeaders(cors, resp);
+        MCP_TRACE_SCOPE("http.request");
+        HttpRequest req(requestInfo);
+        HttpResponse resp(responseInfo, context);
 
-    std::string body = req.GetBody();
-    std::string routedBody = McpHttpRouter::ApplyLegacyRouting(path, body);
-    HttpRequest routedReq(req.GetNative(), routedBody, true);
-
-    if (!FHandler)
-    {
-        resp.SetStatus(500, "Internal Server Error");
-        resp.SetContentType("application/json; charset=utf-8");
-        resp.SetBody(MakeJsonRpcError("null", -32603,
-            "MCP handler not initialized"));
-        return;
+        FEndpoint.Handle(req, resp);
+        stream = resp.GetStream();
     }
 
-    FHandler(routedReq, resp);
-}
-
-std::string HttpTransport::MakeJsonRpcError(const std::string &id, int code,
-    const std::string &message)
-{
-    std::string escaped;
-    escaped.reserve(message.size());
-    for (unsigned char c : message)
+    // An open stream keeps this connection thread, which writes what other
+    // threads queue on it, until it is closed or its client goes away. A
+    // POST handler returns once its response turns into a stream (see
+    // McpSseResponse::Wait), so progress events go out as they are queued
+    // and the result, written when the call completes, closes the stream.
+    if (stream)
     {
-        switch (c)
+        bool idle = false;
+        while (stream->Flush(StreamKeepAliveInterval, idle))
         {
-        case '\\': escaped += "\\\\"; break;
-        case '"':  escaped += "\\\""; break;
-        case '\r': escaped += "\\r"; break;
-        case '\n': escaped += "\\n"; break;
-        case '\t': escaped += "\\t"; break;
-        default:
-            if (c < 0x20)
-            {
-                char buf[7];
-                snprintf(buf, sizeof(buf), "\\u%04X", c);
-                escaped += buf;
-            }
-            else
-            {
-                escaped += static_cast<char>(c);
-            }
+            if (idle)
+                stream->Write(McpSse::Comment("keep-alive"));
         }
     }
-
-    return std::string("{\"jsonrpc\":\"2.0\",\"id\":") + id +
-        ",\"error\":{\"code\":" + std::to_string(code) +
-        ",\"message\":\"" + escaped + "\"}}";
 }
 
 }} // namespace Mcp::Transport
@@ -7,10 +7,10 @@
 //---------------------------------------------------------------------------
 #include "../ITransport.h"
 #include "../TransportTypes.h"
-#include "CorsValidator.h"
 #include "HttpRequest.h"
 #include "HttpResponse.h"
-#include "McpHttpRouter.h"
+#include "McpHttpEndpoint.h"
+#include "../../McpTrace.h"
 #include <IdHTTPServer.hpp>
 #include <memory>
 //---------------------------------------------------------------------------
@@ -29,18 +29,21 @@ public:
     std::string GetName() const override { return "http"; }
     void SetRequestHandler(TMcpRequestHandler handler) override;
 
+    // Written to the GET /mcp event streams (of that session)
+    void SendNotification(const std::string &notificationJson) override;
+    void SendNotificationTo(const std::string &session,
+        const std::string &notificationJson) override;
+
+    // Called on DELETE /mcp
+    void SetSessionEndHandler(TMcpSessionEndHandler handler) override;
+
     // Indy event adapter (call from OnCommandGet)
     void HandleCommandGet(TIdContext *context, TIdHTTPRequestInfo *requestInfo,
         TIdHTTPResponseInfo *responseInfo);
 
 private:
     TIdHTTPServer *FServer;
-    TMcpRequestHandler FHandler;
-    CorsValidator FCorsValidator;
-
-    void HandleMcpRequest(HttpRequest &req, HttpResponse &resp);
-    static std::string MakeJsonRpcError(const std::string &id, int code,
-        const std::string &message);
+    McpHttpEndpoint FEndpoint;
 };
 
 }} // namespace Mcp::Transport
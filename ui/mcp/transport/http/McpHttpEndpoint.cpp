@@ -0,0 +1,410 @@
+//---------------------------------------------------------------------------
+// McpHttpEndpoint.cpp — The /mcp HTTP endpoint, independent of the server
+//---------------------------------------------------------------------------
+
+#include "McpHttpEndpoint.h"
+#include "McpHttpRouter.h"
+#include "McpSse.h"
+#include "McpWireFormat.h"
+#include "../../McpJsonWriter.h"
+#include "../../McpTrace.h"
+#include <algorithm>
+#include <condition_variable>
+#include <random>
+
+namespace Mcp { namespace Transport {
+
+namespace {
+
+//---------------------------------------------------------------------------
+// RoutedRequest — the original request with the routed JSON-RPC body and
+// the session it belongs to
+//---------------------------------------------------------------------------
+class RoutedRequest : public ITransportRequest
+{
+public:
+    RoutedRequest(const ITransportRequest &inner, std::string body, std::string session)
+        : FInner(inner), FBody(std::move(body)), FSession(std::move(session))
+    {
+    }
+
+    std::string GetMethod() const override { return FInner.GetMethod(); }
+    std::string GetPath() const override { return FInner.GetPath(); }
+
+    std::string GetHeader(const std::string &name) const override
+    {
+        if (name == McpHttpEndpoint::SessionHeader)
+            return FSession;
+        return FInner.GetHeader(name);
+    }
+
+    std::string GetBody() const override { return FBody; }
+
+private:
+    const ITransportRequest &FInner;
+    std::string FBody;
+    std::string FSession;
+};
+
+// A JSON-RPC request with the async handler, and what it answers through
+struct TPendingCall
+{
+    TPendingCall(const ITransportRequest &req, std::string body, std::string session,
+        ITransportResponse &resp, TWireFormat format)
+        : Request(req, std::move(body), std::move(session)), Response(resp, format)
+    {
+    }
+
+    RoutedRequest Request;
+    WireFormatResponse Response;
+};
+
+// 128 random bits, hex: the id is all a client shows to claim a session
+std::string NewSessionId()
+{
+    static const char digits[] = "0123456789abcdef";
+    std::random_device random;
+    std::string id;
+    id.reserve(32);
+    for (int word = 0; word < 4; ++word)
+    {
+        unsigned bits = random();
+        for (int nibble = 0; nibble < 8; ++nibble, bits >>= 4)
+            id += digits[bits & 0xF];
+    }
+    return id;
+}
+
+} // namespace
+
+McpHttpEndpoint::McpHttpEndpoint(const TCorsConfig &corsConfig)
+    : FCorsValidator(corsConfig)
+{
+}
+
+void McpHttpEndpoint::SetRequestHandler(TMcpRequestHandler handler)
+{
+    FHandler = handler;
+}
+
+void McpHttpEndpoint::SetAsyncRequestHandler(TMcpAsyncRequestHandler handler)
+{
+    FAsyncHandler = handler;
+}
+
+void McpHttpEndpoint::SetSessionEndHandler(TMcpSessionEndHandler handler)
+{
+    FSessionEndHandler = handler;
+}
+
+void McpHttpEndpoint::Handle(ITransportRequest &req, ITransportResponse &resp)
+{
+    // The async handler may finish on another thread
+    std::mutex mutex;
+    std::condition_variable finished;
+    bool done = false;
+    HandleAsync(req, resp, [&]() {
+        std::lock_guard<std::mutex> lock(mutex);
+        done = true;
+        finished.notify_all();
+    });
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [&done]() { return done; });
+}
+
+void McpHttpEndpoint::HandleAsync(ITransportRequest &req, ITransportResponse &resp,
+    TMcpRequestDone done)
+{
+    std::string path = req.GetPath();
+    if (!McpHttpRouter::IsMcpPath(path))
+    {
+        resp.SetStatus(404, "Not Found");
+        resp.SetContentType("application/json; charset=utf-8");
+        resp.SetBody("{\"error\":\"not found\"}");
+        return done();
+    }
+
+    std::string method = req.GetMethod();
+    if (method == "GET" && path == "/mcp")
+    {
+        OpenEventStream(req, resp);
+        return done();
+    }
+    if (method == "DELETE" && path == "/mcp")
+    {
+        EndSession(req, resp);
+        return done();
+    }
+
+    bool isPreflight = (method == "OPTIONS");
+    if (isPreflight)
+    {
+        TCorsResult cors = FCorsValidator.Validate(req, true);
+        if (!cors.Allowed)
+        {
+            if (cors.HasOrigin)
+                FCorsValidator.ApplyHeaders(cors, resp);
+            resp.SetStatus(cors.StatusCode);
+            resp.SetContentType("application/json; charset=utf-8");
+            resp.SetBody(MakeJsonRpcError("null", -32600, cors.ErrorMessage));
+            return done();
+        }
+
+        if (cors.HasOrigin)
+            FCorsValidator.ApplyHeaders(cors, resp);
+
+        resp.SetStatus(204, "No Content");
+        resp.SetContentType("");
+        resp.SetBody("");
+        return done();
+    }
+
+    if (method != "POST")
+    {
+        resp.SetStatus(405, "Method Not Allowed");
+        resp.SetContentType("application/json; charset=utf-8");
+        resp.SetBody(MakeJsonRpcError("null", -32600,
+            "Method not allowed. Use POST."));
+        return done();
+    }
+
+    TCorsResult cors = FCorsValidator.Validate(req, false);
+    if (!cors.Allowed)
+    {
+        if (cors.HasOrigin)
+            FCorsValidator.ApplyHeaders(cors, resp);
+        resp.SetStatus(cors.StatusCode);
+        resp.SetContentType("application/json; charset=utf-8");
+        resp.SetBody(MakeJsonRpcError("null", -32600, cors.ErrorMessage));
+        return done();
+    }
+
+    if (cors.HasOrigin)
+        FCorsValidator.ApplyHeaders(cors, resp);
+
+    // CBOR / MessagePack bodies are converted here; the handler sees JSON
+    TWireFormat requestFormat = McpWireFormat::FromContentType(req.GetHeader("Content-Type"));
+    TWireFormat responseFormat = McpWireFormat::ForResponse(req.GetHeader("Accept"),
+        requestFormat);
+    WireFormatResponse encodedResp(resp, responseFormat);
+
+    std::string body;
+    {
+        MCP_TRACE_SCOPE("http.read_body");
+        body = req.GetBody();
+    }
+    if (requestFormat != TWireFormat::Json)
+    {
+        MCP_TRACE_SCOPE("wire.decode");
+        std::string jsonText;
+        std::string error;
+        if (!McpWireFormat::ToJsonText(requestFormat, body, jsonText, error))
+        {
+            encodedResp.SetStatus(200, "OK");
+            encodedResp.SetContentType("application/json; charset=utf-8");
+            encodedResp.SetBody(MakeJsonRpcError("null", -32700,
+                "Parse error: " + error));
+            return done();
+        }
+        body.swap(jsonText);
+    }
+
+    std::string routedBody;
+    {
+        MCP_TRACE_SCOPE("http.route");
+        routedBody = McpHttpRouter::ApplyLegacyRouting(path, body);
+    }
+
+    // A client that initializes without a session is given one; it sends
+    // it back on every later request
+    std::string session = req.GetHeader(SessionHeader);
+    if (session.empty() && McpHttpRouter::IsInitialize(routedBody))
+    {
+        session = NewSessionId();
+        encodedResp.SetHeader(SessionHeader, session);
+    }
+
+    if (FAsyncHandler)
+    {
+        // What the handler answers through outlives this call
+        auto call = std::make_shared<TPendingCall>(req, std::move(routedBody),
+            std::move(session), resp, responseFormat);
+        FAsyncHandler(call->Request, call->Response, [call, done]() { done(); });
+        return;
+    }
+
+    if (!FHandler)
+    {
+        encodedResp.SetStatus(500, "Internal Server Error");
+        encodedResp.SetContentType("application/json; charset=utf-8");
+        encodedResp.SetBody(MakeJsonRpcError("null", -32603,
+            "MCP handler not initialized"));
+        return done();
+    }
+
+    RoutedRequest routedReq(req, std::move(routedBody), std::move(session));
+    FHandler(routedReq, encodedResp);
+    done();
+}
+
+void McpHttpEndpoint::Broadcast(const std::string &messageJson)
+{
+    Write(nullptr, messageJson);
+}
+
+void McpHttpEndpoint::SendTo(const std::string &session, const std::string &messageJson)
+{
+    Write(&session, messageJson);
+}
+
+// To every stream, or to the streams of *session
+void McpHttpEndpoint::Write(const std::string *session, const std::string &messageJson)
+{
+    std::vector<std::shared_ptr<ITransportStream>> streams;
+    {
+        std::lock_guard<std::mutex> lock(FStreamMutex);
+        for (const TSessionStream &entry : FStreams)
+        {
+            if (!session || entry.Session == *session)
+                streams.push_back(entry.Stream);
+        }
+    }
+    if (streams.empty())
+        return;
+
+    // Written outside the lock: a slow client must not hold up the others
+    std::string event = McpSse::Event(messageJson);
+    bool dropped = false;
+    for (const auto &stream : streams)
+    {
+        if (!stream->Write(event))
+            dropped = true;
+    }
+
+    if (dropped)
+    {
+        std::lock_guard<std::mutex> lock(FStreamMutex);
+        DropClosedStreams();
+    }
+}
+
+// FStreamMutex held
+void McpHttpEndpoint::DropClosedStreams()
+{
+    FStreams.erase(std::remove_if(FStreams.begin(), FStreams.end(),
+        [](const TSessionStream &entry) { return !entry.Stream->IsOpen(); }),
+        FStreams.end());
+}
+
+void McpHttpEndpoint::CloseStreams()
+{
+    std::vector<TSessionStream> streams;
+    {
+        std::lock_guard<std::mutex> lock(FStreamMutex);
+        streams.swap(FStreams);
+    }
+    for (const auto &entry : streams)
+        entry.Stream->Close();
+}
+
+// GET /mcp: the stream for server-initiated messages
+void McpHttpEndpoint::OpenEventStream(ITransportRequest &req, ITransportResponse &resp)
+{
+    TCorsResult cors = FCorsValidator.ValidateOrigin(req);
+    if (cors.HasOrigin)
+        FCorsValidator.ApplyHeaders(cors, resp);
+    if (!cors.Allowed)
+    {
+        resp.SetStatus(cors.StatusCode);
+        resp.SetContentType("application/json; charset=utf-8");
+        resp.SetBody(MakeJsonRpcError("null", -32600, cors.ErrorMessage));
+        return;
+    }
+
+    if (!McpSse::Accepts(req))
+    {
+        resp.SetStatus(406, "Not Acceptable");
+        resp.SetContentType("application/json; charset=utf-8");
+        resp.SetBody(MakeJsonRpcError("null", -32600,
+            "GET opens an event stream; send Accept: text/event-stream."));
+        return;
+    }
+
+    resp.SetHeader("Cache-Control", "no-cache");
+    std::shared_ptr<ITransportStream> stream = resp.BeginStream(McpSse::ContentType);
+    if (!stream)
+    {
+        resp.SetStatus(405, "Method Not Allowed");
+        resp.SetContentType("application/json; charset=utf-8");
+        resp.SetBody(MakeJsonRpcError("null", -32600,
+            "SSE transport not supported. Use POST."));
+        return;
+    }
+
+    // Sent at once, so the client sees the stream open
+    stream->Write(McpSse::Comment("stream open"));
+
+    std::lock_guard<std::mutex> lock(FStreamMutex);
+    DropClosedStreams();
+    FStreams.push_back(TSessionStream{req.GetHeader(SessionHeader), std::move(stream)});
+}
+
+// DELETE /mcp: the client is done with its session
+void McpHttpEndpoint::EndSession(ITransportRequest &req, ITransportResponse &resp)
+{
+    TCorsResult cors = FCorsValidator.ValidateOrigin(req);
+    if (cors.HasOrigin)
+        FCorsValidator.ApplyHeaders(cors, resp);
+    if (!cors.Allowed)
+    {
+        resp.SetStatus(cors.StatusCode);
+        resp.SetContentType("application/json; charset=utf-8");
+        resp.SetBody(MakeJsonRpcError("null", -32600, cors.ErrorMessage));
+        return;
+    }
+
+    std::string session = req.GetHeader(SessionHeader);
+    if (session.empty())
+    {
+        resp.SetStatus(400, "Bad Request");
+        resp.SetContentType("application/json; charset=utf-8");
+        resp.SetBody(MakeJsonRpcError("null", -32600, "Missing Mcp-Session-Id."));
+        return;
+    }
+
+    if (FSessionEndHandler)
+        FSessionEndHandler(session);
+
+    std::vector<std::shared_ptr<ITransportStream>> streams;
+    {
+        std::lock_guard<std::mutex> lock(FStreamMutex);
+        for (auto it = FStreams.begin(); it != FStreams.end();)
+        {
+            if (it->Session == session)
+            {
+                streams.push_back(std::move(it->Stream));
+                it = FStreams.erase(it);
+            }
+            else
+                ++it;
+        }
+    }
+    for (const auto &stream : streams)
+        stream->Close();
+
+    resp.SetStatus(204, "No Content");
+    resp.SetContentType("");
+    resp.SetBody("");
+}
+
+std::string McpHttpEndpoint::MakeJsonRpcError(const std::string &id, int code,
+    const std::string &message)
+{
+    TMcpJsonWriter writer(message.size() + 96);
+    writer.Raw("{\"jsonrpc\":\"2.0\",\"id\":").Raw(id)
+        .Raw(",\"error\":{\"code\":").Integer(code)
+        .Raw(",\"message\":").String(message).Raw("}}");
+    return writer.Take();
+}
+
+}} // namespace Mcp::Transport
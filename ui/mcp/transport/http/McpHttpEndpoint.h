@@ -0,0 +1,92 @@
+//---------------------------------------------------------------------------
+// McpHttpEndpoint.h — The /mcp HTTP endpoint, independent of the server
+//
+// Path check, CORS, CBOR/MessagePack negotiation and legacy routing for
+// one request, on the ITransportRequest/ITransportResponse interfaces.
+// HttpTransport (Indy) and EpollHttpTransport (Linux) both serve /mcp
+// through it, so they answer identically.
+//
+// GET /mcp with Accept: text/event-stream opens a Server-Sent Events
+// stream (MCP Streamable HTTP) that Broadcast feeds with server-initiated
+// notifications. Streams are not resumable: there are no event ids, and
+// messages sent while a client is away are lost.
+//
+// An initialize request without an Mcp-Session-Id is answered with a new
+// one. The handler sees the session in the request's Mcp-Session-Id;
+// clients that never send one share the empty session. A GET stream
+// belongs to the session it was opened with, and DELETE /mcp ends one.
+//---------------------------------------------------------------------------
+
+#ifndef McpHttpEndpointH
+#define McpHttpEndpointH
+//---------------------------------------------------------------------------
+#include "../ITransport.h"
+#include "../TransportTypes.h"
+#include "CorsValidator.h"
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+//---------------------------------------------------------------------------
+
+namespace Mcp { namespace Transport {
+
+class McpHttpEndpoint
+{
+public:
+    static constexpr const char *SessionHeader = "Mcp-Session-Id";
+
+    explicit McpHttpEndpoint(const TCorsConfig &corsConfig = TCorsConfig());
+
+    // Set before the transport starts serving. The async handler, when
+    // set, is used instead of the other.
+    void SetRequestHandler(TMcpRequestHandler handler);
+    void SetAsyncRequestHandler(TMcpAsyncRequestHandler handler);
+    void SetSessionEndHandler(TMcpSessionEndHandler handler);
+
+    // Answers one HTTP request; the handler gets JSON-RPC requests only
+    void Handle(ITransportRequest &req, ITransportResponse &resp);
+
+    // As Handle, but calls done once the response is complete, which with
+    // the async handler may be after this returns; req and resp must stay
+    // valid until then
+    void HandleAsync(ITransportRequest &req, ITransportResponse &resp, TMcpRequestDone done);
+
+    // Sends a JSON-RPC message to every open GET stream; streams whose
+    // client has gone are dropped. Thread-safe.
+    void Broadcast(const std::string &messageJson);
+
+    // As Broadcast, to the streams of one session only
+    void SendTo(const std::string &session, const std::string &messageJson);
+
+    // Ends every GET stream (before the transport stops)
+    void CloseStreams();
+
+    static std::string MakeJsonRpcError(const std::string &id, int code,
+        const std::string &message);
+
+private:
+    struct TSessionStream
+    {
+        std::string Session;
+        std::shared_ptr<ITransportStream> Stream;
+    };
+
+    TMcpRequestHandler FHandler;
+    TMcpAsyncRequestHandler FAsyncHandler;
+    TMcpSessionEndHandler FSessionEndHandler;
+    CorsValidator FCorsValidator;
+
+    std::mutex FStreamMutex;
+    std::vector<TSessionStream> FStreams;
+
+    void OpenEventStream(ITransportRequest &req, ITransportResponse &resp);
+    void EndSession(ITransportRequest &req, ITransportResponse &resp);
+    void Write(const std::string *session, const std::string &messageJson);
+    void DropClosedStreams();
+};
+
+}} // namespace Mcp::Transport
+
+//---------------------------------------------------------------------------
+#endif
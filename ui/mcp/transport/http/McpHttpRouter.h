@@ -23,6 +23,18 @@ public:
             path == "/mcp/tools/call";
     }
 
+    // A single initialize request; bodies that cannot be one are turned
+    // down without parsing
+    static bool IsInitialize(const std::string &body)
+    {
+        if (body.find("\"initialize\"") == std::string::npos)
+            return false;
+
+        nlohmann::json j;
+        TJsonRpcParseResult parsed = ParseJson(body, j);
+        return parsed.Ok && parsed.Method == "initialize";
+    }
+
     static std::string ApplyLegacyRouting(const std::string &path, const std::string &body)
     {
         std::string legacyMethod = LegacyMethodForPath(path);
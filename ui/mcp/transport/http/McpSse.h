@@ -0,0 +1,163 @@
+//---------------------------------------------------------------------------
+// McpSse.h — Server-Sent Events framing for Streamable HTTP
+//
+// JSON-RPC messages go out as "message" events, one per event. A POST
+// answered through McpSseResponse stays a plain JSON response unless
+// something about the request (progress) has to go out first; only then
+// does the response become an event stream, with the result as its last
+// event.
+//---------------------------------------------------------------------------
+
+#ifndef McpSseH
+#define McpSseH
+//---------------------------------------------------------------------------
+#include "../ITransportRequest.h"
+#include "../ITransportResponse.h"
+#include "../ITransportStream.h"
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+//---------------------------------------------------------------------------
+
+namespace Mcp { namespace Transport {
+
+class McpSse
+{
+public:
+    static constexpr const char *ContentType = "text/event-stream";
+
+    // "event: message" with the text as data; each line of a multi-line
+    // text gets its own "data:" field
+    static std::string Event(const std::string &data)
+    {
+        std::string out;
+        out.reserve(data.size() + 32);
+        out += "event: message\n";
+        size_t start = 0;
+        while (true)
+        {
+            size_t end = data.find('\n', start);
+            out += "data: ";
+            if (end == std::string::npos)
+            {
+                out.append(data, start, std::string::npos);
+                out += '\n';
+                break;
+            }
+            out.append(data, start, end - start);
+            out += '\n';
+            start = end + 1;
+        }
+        out += '\n';
+        return out;
+    }
+
+    // Ignored by clients; keeps idle streams from looking dead
+    static std::string Comment(const std::string &text)
+    {
+        return ": " + text + "\n\n";
+    }
+
+    static bool Accepts(const ITransportRequest &req)
+    {
+        std::string accept = req.GetHeader("Accept");
+        for (char &c : accept)
+        {
+            if (c >= 'A' && c <= 'Z')
+                c = static_cast<char>(c - 'A' + 'a');
+        }
+        return accept.find(ContentType) != std::string::npos;
+    }
+};
+
+//---------------------------------------------------------------------------
+// McpSseResponse — a JSON-RPC response that can turn into an event stream
+//
+// Hold it in a shared_ptr and pass SendNotification to
+// TMcpServer::HandleRequest: a tool may report progress from any thread,
+// even after Finish, when the response is gone and the call does nothing.
+//
+// With TMcpServer::HandleRequestAsync, Finish runs from its callback and
+// the handler returns after Wait: the transport then feeds the stream, if
+// one was started, until Finish closes it (a tool that HandleRequestAsync
+// runs inline still holds the thread). Once streaming, the response given
+// to the constructor is no longer used.
+//---------------------------------------------------------------------------
+class McpSseResponse
+{
+public:
+    McpSseResponse(const ITransportRequest &req, ITransportResponse &resp)
+        : FResponse(&resp), FClientAccepts(McpSse::Accepts(req))
+    {
+    }
+
+    // The first one starts the stream; dropped when the client did not
+    // accept text/event-stream or the transport cannot stream
+    void SendNotification(const std::string &notificationJson)
+    {
+        std::lock_guard<std::mutex> lock(FMutex);
+        if (!FResponse || !FClientAccepts)
+            return;
+        if (!FStream)
+        {
+            FResponse->SetHeader("Cache-Control", "no-cache");
+            FStream = FResponse->BeginStream(McpSse::ContentType);
+            if (!FStream)
+            {
+                FClientAccepts = false;
+                return;
+            }
+            FChanged.notify_all();
+        }
+        FStream->Write(McpSse::Event(notificationJson));
+    }
+
+    // Blocks until the handler's thread is no longer needed: Finish has
+    // run, or the response has become a stream
+    void Wait()
+    {
+        std::unique_lock<std::mutex> lock(FMutex);
+        FChanged.wait(lock, [this]() { return !FResponse || FStream; });
+    }
+
+    // Sends the response, as the last event when streaming; an empty one
+    // (notifications) is 202 Accepted
+    void Finish(const std::string &responseJson)
+    {
+        std::lock_guard<std::mutex> lock(FMutex);
+        if (!FResponse)
+            return;
+        if (FStream)
+        {
+            if (!responseJson.empty())
+                FStream->Write(McpSse::Event(responseJson));
+            FStream->Close();
+            FStream.reset();
+        }
+        else if (responseJson.empty())
+        {
+            FResponse->SetNoContent();
+        }
+        else
+        {
+            FResponse->SetStatus(200, "OK");
+            FResponse->SetContentType("application/json; charset=utf-8");
+            FResponse->SetBody(responseJson);
+        }
+        FResponse = nullptr;
+        FChanged.notify_all();
+    }
+
+private:
+    std::mutex FMutex;
+    std::condition_variable FChanged;
+    ITransportResponse *FResponse;
+    bool FClientAccepts;
+    std::shared_ptr<ITransportStream> FStream;
+};
+
+}} // namespace Mcp::Transport
+
+//---------------------------------------------------------------------------
+#endif
@@ -0,0 +1,197 @@
+//---------------------------------------------------------------------------
+// McpWireFormat.h — JSON / CBOR / MessagePack negotiation for /mcp
+//
+// The request format comes from Content-Type; the response format from
+// Accept, falling back to the request's format. Binary bodies are
+// converted at the transport edge, so TMcpServer only ever sees JSON.
+//---------------------------------------------------------------------------
+
+#ifndef McpWireFormatH
+#define McpWireFormatH
+//---------------------------------------------------------------------------
+#include "../ITransportResponse.h"
+#include "../TransportTypes.h"
+#include "../../McpTrace.h"
+#include "../../../external/nlohmann/json.hpp"
+#include <string>
+#include <cctype>
+//---------------------------------------------------------------------------
+
+namespace Mcp { namespace Transport {
+
+class McpWireFormat
+{
+public:
+    static TWireFormat FromContentType(const std::string &contentType)
+    {
+        std::string type = ToLower(contentType);
+        if (Contains(type, "application/cbor"))
+            return TWireFormat::Cbor;
+        if (IsMsgPackType(type))
+            return TWireFormat::MsgPack;
+        return TWireFormat::Json;
+    }
+
+    // The first binary type listed in Accept wins; an Accept that names
+    // neither binary type nor JSON (absent, */*) gets the request format
+    static TWireFormat ForResponse(const std::string &accept, TWireFormat requestFormat)
+    {
+        std::string types = ToLower(accept);
+        size_t cbor = types.find("application/cbor");
+        size_t msgpack = FindMsgPackType(types);
+        if (cbor != std::string::npos || msgpack != std::string::npos)
+            return cbor < msgpack ? TWireFormat::Cbor : TWireFormat::MsgPack;
+        if (Contains(types, "application/json"))
+            return TWireFormat::Json;
+        return requestFormat;
+    }
+
+    static const char* ContentType(TWireFormat format)
+    {
+        switch (format)
+        {
+        case TWireFormat::Cbor:    return "application/cbor";
+        case TWireFormat::MsgPack: return "application/msgpack";
+        default:                   return "application/json; charset=utf-8";
+        }
+    }
+
+    // Binary body -> JSON text for the server
+    static bool ToJsonText(TWireFormat format, const std::string &body, std::string &jsonText,
+        std::string &error)
+    {
+        try
+        {
+            nlohmann::json value = (format == TWireFormat::Cbor)
+                ? nlohmann::json::from_cbor(body)
+                : nlohmann::json::from_msgpack(body);
+            jsonText = value.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace);
+            return true;
+        }
+        catch (const std::exception &e)
+        {
+            error = e.what();
+            return false;
+        }
+    }
+
+    // Server JSON text -> binary body; false if the text is not JSON
+    static bool FromJsonText(TWireFormat format, const std::string &jsonText, std::string &body)
+    {
+        nlohmann::json value = nlohmann::json::parse(jsonText, nullptr, false);
+        if (value.is_discarded())
+            return false;
+
+        body.clear();
+        if (format == TWireFormat::Cbor)
+            nlohmann::json::to_cbor(value, body);
+        else
+            nlohmann::json::to_msgpack(value, body);
+        return true;
+    }
+
+private:
+    static bool Contains(const std::string &s, const char *part)
+    {
+        return s.find(part) != std::string::npos;
+    }
+
+    static bool IsMsgPackType(const std::string &type)
+    {
+        return FindMsgPackType(type) != std::string::npos;
+    }
+
+    static size_t FindMsgPackType(const std::string &types)
+    {
+        size_t best = std::string::npos;
+        for (const char *name : {"application/msgpack", "application/x-msgpack",
+                                 "application/vnd.msgpack"})
+        {
+            size_t pos = types.find(name);
+            if (pos < best)
+                best = pos;
+        }
+        return best;
+    }
+
+    static std::string ToLower(const std::string &s)
+    {
+        std::string out = s;
+        for (auto &c : out)
+            c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        return out;
+    }
+};
+
+//---------------------------------------------------------------------------
+// WireFormatResponse — re-encodes the JSON body a handler writes
+//---------------------------------------------------------------------------
+class WireFormatResponse : public ITransportResponse
+{
+public:
+    WireFormatResponse(ITransportResponse &inner, TWireFormat format)
+        : FInner(inner), FFormat(format)
+    {
+    }
+
+    void SetStatus(int code, const std::string &text = "") override
+    {
+        FInner.SetStatus(code, text);
+    }
+
+    void SetHeader(const std::string &name, const std::string &value) override
+    {
+        FInner.SetHeader(name, value);
+    }
+
+    void SetContentType(const std::string &contentType) override
+    {
+        if (FFormat == TWireFormat::Json || contentType.empty())
+            FInner.SetContentType(contentType);
+        else
+            FInner.SetContentType(McpWireFormat::ContentType(FFormat));
+    }
+
+    void SetBody(const std::string &body) override
+    {
+        if (FFormat == TWireFormat::Json || body.empty())
+        {
+            FInner.SetBody(body);
+            return;
+        }
+
+        MCP_TRACE_SCOPE("wire.encode");
+        std::string encoded;
+        if (McpWireFormat::FromJsonText(FFormat, body, encoded))
+        {
+            FInner.SetBody(encoded);
+        }
+        else
+        {
+            FInner.SetContentType(McpWireFormat::ContentType(TWireFormat::Json));
+            FInner.SetBody(body);
+        }
+    }
+
+    void SetNoContent() override
+    {
+        FInner.SetNoContent();
+    }
+
+    // Event streams carry JSON text; binary formats answer in one body
+    std::shared_ptr<ITransportStream> BeginStream(const std::string &contentType) override
+    {
+        if (FFormat != TWireFormat::Json)
+            return nullptr;
+        return FInner.BeginStream(contentType);
+    }
+
+private:
+    ITransportResponse &FInner;
+    TWireFormat FFormat;
+};
+
+}} // namespace Mcp::Transport
+
+//---------------------------------------------------------------------------
+#endif
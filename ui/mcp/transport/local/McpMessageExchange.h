@@ -0,0 +1,105 @@
+//---------------------------------------------------------------------------
+// McpMessageExchange.h — One JSON-RPC message through a request handler
+//
+// The local transports (stdio, Unix socket) carry bare JSON-RPC messages.
+// Each one goes to the same TMcpRequestHandler the HTTP transports use,
+// presented as a POST /mcp with a JSON body and nothing else: no headers
+// to parse, no CORS, no legacy routing; the connection's session id is
+// presented as Mcp-Session-Id. Replies are whole messages. The
+// handler cannot stream (BeginStream is null), so progress about a
+// request is not sent; server-initiated notifications are.
+// Pure C++ - NO VCL dependencies.
+//---------------------------------------------------------------------------
+
+#ifndef McpMessageExchangeH
+#define McpMessageExchangeH
+//---------------------------------------------------------------------------
+#include "../ITransport.h"
+#include "../../McpJsonWriter.h"
+#include <exception>
+#include <string>
+#include <utility>
+//---------------------------------------------------------------------------
+
+namespace Mcp { namespace Transport {
+
+class McpMessageRequest : public ITransportRequest
+{
+public:
+    McpMessageRequest(std::string body, const std::string &session)
+        : FBody(std::move(body)), FSession(session)
+    {
+    }
+
+    std::string GetMethod() const override { return "POST"; }
+    std::string GetPath() const override { return "/mcp"; }
+
+    std::string GetHeader(const std::string &name) const override
+    {
+        if (name == "Content-Type" || name == "Accept")
+            return "application/json";
+        if (name == "Mcp-Session-Id")
+            return FSession;
+        return std::string();
+    }
+
+    std::string GetBody() const override { return FBody; }
+
+private:
+    std::string FBody;
+    std::string FSession;
+};
+
+// Keeps the body; status and headers have no meaning here
+class McpMessageResponse : public ITransportResponse
+{
+public:
+    void SetStatus(int code, const std::string &text = "") override {}
+    void SetHeader(const std::string &name, const std::string &value) override {}
+    void SetContentType(const std::string &contentType) override {}
+    void SetBody(const std::string &body) override { FBody = body; }
+    void SetNoContent() override { FBody.clear(); }
+
+    std::string& GetBody() { return FBody; }
+
+private:
+    std::string FBody;
+};
+
+class McpMessageExchange
+{
+public:
+    // The reply to one message; empty when none is due (notifications).
+    // session tells the messages of one connection from another's.
+    static std::string Handle(const TMcpRequestHandler &handler, std::string message,
+        const std::string &session = std::string())
+    {
+        if (!handler)
+            return MakeError(-32603, "MCP handler not initialized");
+
+        McpMessageRequest req(std::move(message), session);
+        McpMessageResponse resp;
+        try
+        {
+            handler(req, resp);
+        }
+        catch (const std::exception &e)
+        {
+            return MakeError(-32603, e.what());
+        }
+        return std::move(resp.GetBody());
+    }
+
+    static std::string MakeError(int code, const std::string &message)
+    {
+        TMcpJsonWriter writer(message.size() + 96);
+        writer.Raw("{\"jsonrpc\":\"2.0\",\"id\":null,\"error\":{\"code\":").Integer(code)
+            .Raw(",\"message\":").String(message).Raw("}}");
+        return writer.Take();
+    }
+};
+
+}} // namespace Mcp::Transport
+
+//---------------------------------------------------------------------------
+#endif
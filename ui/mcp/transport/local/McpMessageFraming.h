@@ -0,0 +1,175 @@
+//---------------------------------------------------------------------------
+// McpMessageFraming.h — Message boundaries on local byte streams
+//
+// McpLineFramer: newline-delimited JSON, as the MCP stdio transport sends
+// it. A trailing '\r' is dropped and blank lines are skipped.
+// McpLengthFramer: a 4-byte big-endian length, then that many bytes.
+//
+// Both take bytes as they arrive and hand out whole messages. A message
+// over the size limit is reported once. The line framer then skips to the
+// next newline; a length-prefixed stream cannot find its next message and
+// has to be closed.
+// Pure C++ - NO VCL dependencies.
+//---------------------------------------------------------------------------
+
+#ifndef McpMessageFramingH
+#define McpMessageFramingH
+//---------------------------------------------------------------------------
+#include <cstddef>
+#include <cstdint>
+#include <string>
+//---------------------------------------------------------------------------
+
+namespace Mcp { namespace Transport {
+
+enum class TFrameStatus
+{
+    Message,        // message holds the next message
+    NeedMore,       // no whole message buffered yet
+    TooLarge        // a message over the limit was dropped
+};
+
+class McpLineFramer
+{
+public:
+    explicit McpLineFramer(size_t maxMessageBytes)
+        : FMaxMessageBytes(maxMessageBytes)
+    {
+    }
+
+    void Append(const char *data, size_t size)
+    {
+        FBuffer.append(data, size);
+    }
+
+    TFrameStatus Next(std::string &message)
+    {
+        while (true)
+        {
+            size_t newline = FBuffer.find('\n', FScanned);
+            if (newline == std::string::npos)
+                return Incomplete();
+
+            size_t start = FStart;
+            size_t end = newline;
+            FStart = FScanned = newline + 1;
+            if (FDiscarding)
+            {
+                FDiscarding = false;        // the rest of a line already reported
+                continue;
+            }
+
+            if (end > start && FBuffer[end - 1] == '\r')
+                end--;
+            if (end == start)
+                continue;
+            if (end - start > FMaxMessageBytes)
+                return TFrameStatus::TooLarge;
+            message.assign(FBuffer, start, end - start);
+            return TFrameStatus::Message;
+        }
+    }
+
+private:
+    std::string FBuffer;
+    size_t FStart = 0;              // first byte of the current line
+    size_t FScanned = 0;            // no newline before this
+    size_t FMaxMessageBytes;
+    bool FDiscarding = false;
+
+    // Drops consumed bytes; an overlong partial line is dropped as well.
+    // One byte of slack: a partial line may end in the '\r' of its "\r\n".
+    TFrameStatus Incomplete()
+    {
+        bool tooLarge = !FDiscarding && FBuffer.size() - FStart > FMaxMessageBytes + 1;
+        if (tooLarge || FDiscarding)
+        {
+            FDiscarding = true;
+            FBuffer.clear();
+            FStart = FScanned = 0;
+            return tooLarge ? TFrameStatus::TooLarge : TFrameStatus::NeedMore;
+        }
+
+        FBuffer.erase(0, FStart);
+        FScanned = FBuffer.size();
+        FStart = 0;
+        return TFrameStatus::NeedMore;
+    }
+};
+
+class McpLengthFramer
+{
+public:
+    static constexpr size_t HeaderBytes = 4;
+
+    explicit McpLengthFramer(size_t maxMessageBytes)
+        : FMaxMessageBytes(maxMessageBytes)
+    {
+    }
+
+    void Append(const char *data, size_t size)
+    {
+        FBuffer.append(data, size);
+    }
+
+    // TooLarge is final: every later call returns it too
+    TFrameStatus Next(std::string &message)
+    {
+        if (FFailed)
+            return TFrameStatus::TooLarge;
+
+        size_t available = FBuffer.size() - FStart;
+        if (available < HeaderBytes)
+            return Incomplete();
+
+        const unsigned char *header =
+            reinterpret_cast<const unsigned char*>(FBuffer.data() + FStart);
+        uint32_t length = (uint32_t(header[0]) << 24) | (uint32_t(header[1]) << 16) |
+            (uint32_t(header[2]) << 8) | uint32_t(header[3]);
+        if (length > FMaxMessageBytes)
+        {
+            FFailed = true;
+            FBuffer.clear();
+            FStart = 0;
+            return TFrameStatus::TooLarge;
+        }
+        if (available - HeaderBytes < length)
+            return Incomplete();
+
+        message.assign(FBuffer, FStart + HeaderBytes, length);
+        FStart += HeaderBytes + length;
+        return TFrameStatus::Message;
+    }
+
+    // Header and message, ready to send
+    static std::string Frame(const std::string &message)
+    {
+        uint32_t length = static_cast<uint32_t>(message.size());
+        std::string out;
+        out.reserve(HeaderBytes + message.size());
+        out += static_cast<char>((length >> 24) & 0xFF);
+        out += static_cast<char>((length >> 16) & 0xFF);
+        out += static_cast<char>((length >> 8) & 0xFF);
+        out += static_cast<char>(length & 0xFF);
+        out += message;
+        return out;
+    }
+
+private:
+    std::string FBuffer;
+    size_t FStart = 0;
+    size_t FMaxMessageBytes;
+    bool FFailed = false;
+
+    TFrameStatus Incomplete()
+    {
+        FBuffer.erase(0, FStart);
+        FStart = 0;
+        return TFrameStatus::NeedMore;
+    }
+};
+
+}} // namespace Mcp::Transport
+
+//---------------------------------------------------------------------------
+#endif
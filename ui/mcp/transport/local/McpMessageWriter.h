@@ -0,0 +1,135 @@
+//---------------------------------------------------------------------------
+// McpMessageWriter.h — Outbound queue of a local transport's client
+//
+// Send queues a frame and returns at once; a writer thread of its own
+// writes the frames, in order, with the (blocking) write it was given. A
+// worker replying or the server's timer thread notifying never waits for
+// the client. A client that stops reading is dropped once the frames
+// waiting behind the one being written pass the backlog limit: Send then
+// returns false, and so does every Send after it.
+// Pure C++ - NO VCL dependencies.
+//---------------------------------------------------------------------------
+
+#ifndef McpMessageWriterH
+#define McpMessageWriterH
+//---------------------------------------------------------------------------
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+//---------------------------------------------------------------------------
+
+namespace Mcp { namespace Transport {
+
+class McpMessageWriter
+{
+public:
+    // Writes one whole frame; false when the client has gone
+    using TWriteFunc = std::function<bool(const std::string &frame)>;
+
+    McpMessageWriter(TWriteFunc write, size_t maxBacklog)
+        : FWrite(std::move(write)), FMaxBacklog(maxBacklog)
+    {
+    }
+
+    ~McpMessageWriter()
+    {
+        Stop();
+    }
+
+    McpMessageWriter(const McpMessageWriter&) = delete;
+    McpMessageWriter& operator=(const McpMessageWriter&) = delete;
+
+    void Start()
+    {
+        std::lock_guard<std::mutex> lock(FMutex);
+        if (FThread.joinable())
+            return;
+        FRunning = true;
+        FFailed = false;
+        FThread = std::thread([this]() { WriteLoop(); });
+    }
+
+    // Writes what is queued, then returns; frames sent meanwhile are
+    // dropped
+    void Stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(FMutex);
+            if (!FThread.joinable())
+                return;
+            FRunning = false;
+            FChanged.notify_all();
+        }
+        FThread.join();
+        FThread = std::thread();
+    }
+
+    // False when the frame is dropped: not running, the client has gone,
+    // or it is too far behind
+    bool Send(std::string frame)
+    {
+        std::lock_guard<std::mutex> lock(FMutex);
+        if (!FRunning || FFailed)
+            return false;
+        // A frame larger than the limit still goes out on its own
+        if (!FQueue.empty() && FQueuedBytes + frame.size() > FMaxBacklog)
+        {
+            Fail();
+            return false;
+        }
+        FQueuedBytes += frame.size();
+        FQueue.push_back(std::move(frame));
+        FChanged.notify_all();
+        return true;
+    }
+
+private:
+    TWriteFunc FWrite;
+    size_t FMaxBacklog;
+
+    std::mutex FMutex;
+    std::condition_variable FChanged;
+    std::deque<std::string> FQueue;
+    size_t FQueuedBytes = 0;             // in FQueue, not the frame being written
+    bool FRunning = false;
+    bool FFailed = false;
+    std::thread FThread;
+
+    void WriteLoop()
+    {
+        std::unique_lock<std::mutex> lock(FMutex);
+        while (true)
+        {
+            FChanged.wait(lock, [this]() { return !FQueue.empty() || !FRunning; });
+            if (FQueue.empty())
+                return;                         // stopped, all written
+
+            std::string frame = std::move(FQueue.front());
+            FQueue.pop_front();
+            FQueuedBytes -= frame.size();
+            lock.unlock();
+            bool written = FWrite(frame);
+            lock.lock();
+            if (!written)
+                Fail();
+        }
+    }
+
+    // FMutex held
+    void Fail()
+    {
+        FFailed = true;
+        FQueue.clear();
+        FQueuedBytes = 0;
+    }
+};
+
+}} // namespace Mcp::Transport
+
+//---------------------------------------------------------------------------
+#endif
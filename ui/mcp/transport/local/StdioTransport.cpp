@@ -0,0 +1,198 @@
+//---------------------------------------------------------------------------
+// StdioTransport.cpp — MCP over standard input/output (newline-delimited)
+//---------------------------------------------------------------------------
+
+#include "StdioTransport.h"
+#include "McpMessageExchange.h"
+#include "McpMessageFraming.h"
+#include "../../McpWorkerPool.h"
+#include "../../McpTrace.h"
+
+#include <poll.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+namespace Mcp { namespace Transport {
+
+StdioTransport::StdioTransport(const TStdioConfig &config)
+    : FConfig(config),
+      FWriter([this](const std::string &line) { return WriteOutput(line); }, config.MaxBacklog)
+{
+}
+
+StdioTransport::~StdioTransport()
+{
+    Stop();
+}
+
+void StdioTransport::SetRequestHandler(TMcpRequestHandler handler)
+{
+    FHandler = handler;
+}
+
+void StdioTransport::SetSessionEndHandler(TMcpSessionEndHandler handler)
+{
+    FSessionEndHandler = handler;
+}
+
+void StdioTransport::Start()
+{
+    if (FRunning.load())
+        return;
+
+    if (pipe(FWakeFds) < 0)
+        throw std::runtime_error(std::string("StdioTransport: pipe: ") + std::strerror(errno));
+
+    if (FConfig.WorkerThreads > 0)
+        FWorkers = std::make_unique<TMcpWorkerPool>(FConfig.WorkerThreads);
+    FWriter.Start();
+
+    {
+        std::lock_guard<std::mutex> lock(FInputMutex);
+        FInputOpen = true;
+    }
+    FRunning = true;
+    FReader = std::thread([this]() { ReadLoop(); });
+}
+
+void StdioTransport::Stop()
+{
+    if (!FRunning.load())
+        return;
+
+    char wake = 1;
+    ssize_t written = write(FWakeFds[1], &wake, 1);
+    (void)written;
+    if (FReader.joinable())
+        FReader.join();
+
+    FWorkers.reset();
+    FWriter.Stop();
+    CloseWakePipe();
+    FRunning = false;
+}
+
+void StdioTransport::CloseWakePipe()
+{
+    for (int &fd : FWakeFds)
+    {
+        if (fd >= 0)
+            close(fd);
+        fd = -1;
+    }
+}
+
+void StdioTransport::WaitForInputEnd()
+{
+    std::unique_lock<std::mutex> lock(FInputMutex);
+    FInputEnded.wait(lock, [this]() { return !FInputOpen; });
+}
+
+void StdioTransport::SendNotification(const std::string &notificationJson)
+{
+    WriteLine(notificationJson);
+}
+
+void StdioTransport::SendNotificationTo(const std::string &session,
+    const std::string &notificationJson)
+{
+    if (session == Session)
+        WriteLine(notificationJson);
+}
+
+void StdioTransport::ReadLoop()
+{
+    McpLineFramer framer(FConfig.MaxMessageBytes);
+    char chunk[64 * 1024];
+    while (true)
+    {
+        pollfd fds[2] = {{FConfig.InputFd, POLLIN, 0}, {FWakeFds[0], POLLIN, 0}};
+        if (poll(fds, 2, -1) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        if (fds[1].revents != 0)
+            break;                              // Stop
+
+        ssize_t n = read(FConfig.InputFd, chunk, sizeof(chunk));
+        if (n < 0 && (errno == EINTR || errno == EAGAIN))
+            continue;
+        if (n <= 0)
+        {
+            if (FSessionEndHandler)
+                FSessionEndHandler(Session);
+            break;                              // end of input
+        }
+
+        framer.Append(chunk, static_cast<size_t>(n));
+        std::string message;
+        TFrameStatus status;
+        while ((status = framer.Next(message)) != TFrameStatus::NeedMore)
+        {
+            if (status == TFrameStatus::TooLarge)
+                WriteLine(McpMessageExchange::MakeError(-32600, "Message too large"));
+            else
+                Dispatch(std::move(message));
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(FInputMutex);
+    FInputOpen = false;
+    FInputEnded.notify_all();
+}
+
+void StdioTransport::Dispatch(std::string message)
+{
+    if (!FWorkers)
+    {
+        std::string reply = McpMessageExchange::Handle(FHandler, std::move(message), Session);
+        if (!reply.empty())
+            WriteLine(reply);
+        return;
+    }
+
+    auto shared = std::make_shared<std::string>(std::move(message));
+    FWorkers->Submit([this, shared]() {
+        MCP_TRACE_SCOPE("stdio.request");
+        std::string reply = McpMessageExchange::Handle(FHandler, std::move(*shared), Session);
+        if (!reply.empty())
+            WriteLine(reply);
+    });
+}
+
+// Queued as one line, so replies from several workers never interleave
+void StdioTransport::WriteLine(const std::string &message)
+{
+    std::string line;
+    line.reserve(message.size() + 1);
+    line += message;
+    line += '\n';
+    FWriter.Send(std::move(line));
+}
+
+// On the writer thread
+bool StdioTransport::WriteOutput(const std::string &line)
+{
+    size_t sent = 0;
+    while (sent < line.size())
+    {
+        ssize_t n = write(FConfig.OutputFd, line.data() + sent, line.size() - sent);
+        if (n > 0)
+        {
+            sent += static_cast<size_t>(n);
+            continue;
+        }
+        if (n < 0 && errno == EINTR)
+            continue;
+        return false;                           // the client has gone
+    }
+    return true;
+}
+
+}} // namespace Mcp::Transport
@@ -0,0 +1,107 @@
+//---------------------------------------------------------------------------
+// StdioTransport.h — MCP over standard input/output (newline-delimited)
+//
+// One JSON-RPC message per line in each direction, as MCP clients speak
+// to servers they launch. A reader thread splits the input into messages
+// (McpLineFramer). Handlers run on a worker pool, so replies may come back
+// in a different order than the requests; each carries its id. Writes to
+// the output are whole lines, one at a time, queued for a writer thread
+// (McpMessageWriter): a client that stops reading is dropped once
+// MaxBacklog bytes wait for it, rather than holding up the sender.
+//
+// POSIX (poll, pipe); not part of ClaBot.cbproj. Writing to a closed
+// output raises SIGPIPE, which a server process should ignore.
+//---------------------------------------------------------------------------
+
+#ifndef StdioTransportH
+#define StdioTransportH
+//---------------------------------------------------------------------------
+#include "../ITransport.h"
+#include "McpMessageWriter.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+//---------------------------------------------------------------------------
+
+namespace Mcp {
+
+class TMcpWorkerPool;
+
+namespace Transport {
+
+struct TStdioConfig
+{
+    int InputFd = 0;                     // stdin
+    int OutputFd = 1;                    // stdout
+    unsigned WorkerThreads = 4;          // 0: handlers run on the reader
+    size_t MaxMessageBytes = 16 * 1024 * 1024;
+
+    // Unsent bytes queued for a client that has stopped reading; past
+    // them, nothing more is written to it
+    size_t MaxBacklog = 4 * 1024 * 1024;
+};
+
+class StdioTransport : public ITransport
+{
+public:
+    explicit StdioTransport(const TStdioConfig &config = TStdioConfig());
+    ~StdioTransport() override;
+
+    StdioTransport(const StdioTransport&) = delete;
+    StdioTransport& operator=(const StdioTransport&) = delete;
+
+    // Throws std::runtime_error when the wake pipe cannot be created
+    void Start() override;
+
+    // Waits for handlers in progress; their replies, and whatever else is
+    // queued, are still written
+    void Stop() override;
+
+    bool IsRunning() const override { return FRunning.load(); }
+    std::string GetName() const override { return "stdio"; }
+    void SetRequestHandler(TMcpRequestHandler handler) override;
+
+    // Written to the output as a line of its own
+    void SendNotification(const std::string &notificationJson) override;
+
+    // The one client is session "stdio"; it ends with the input
+    void SendNotificationTo(const std::string &session,
+        const std::string &notificationJson) override;
+    void SetSessionEndHandler(TMcpSessionEndHandler handler) override;
+
+    // Blocks until the input ends (the client closed it) or Stop is called
+    void WaitForInputEnd();
+
+private:
+    static constexpr const char *Session = "stdio";
+
+    TStdioConfig FConfig;
+    TMcpRequestHandler FHandler;
+    TMcpSessionEndHandler FSessionEndHandler;
+
+    int FWakeFds[2] = {-1, -1};          // pipe: Stop wakes the reader
+    std::thread FReader;
+    std::unique_ptr<TMcpWorkerPool> FWorkers;
+    std::atomic<bool> FRunning{false};
+
+    McpMessageWriter FWriter;
+
+    std::mutex FInputMutex;
+    std::condition_variable FInputEnded;
+    bool FInputOpen = false;
+
+    void ReadLoop();
+    void Dispatch(std::string message);
+    void WriteLine(const std::string &message);
+    bool WriteOutput(const std::string &line);
+    void CloseWakePipe();
+};
+
+}} // namespace Mcp::Transport
+
+//---------------------------------------------------------------------------
+#endif
@@ -0,0 +1,311 @@
+//---------------------------------------------------------------------------
+// UnixSocketTransport.cpp — MCP over a Unix domain socket
+//---------------------------------------------------------------------------
+
+#include "UnixSocketTransport.h"
+#include "McpMessageExchange.h"
+#include "McpMessageFraming.h"
+#include "McpMessageWriter.h"
+#include "../../McpWorkerPool.h"
+#include "../../McpTrace.h"
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+namespace Mcp { namespace Transport {
+
+//---------------------------------------------------------------------------
+// TClient — one connection; shared with the handlers replying to it
+//---------------------------------------------------------------------------
+struct UnixSocketTransport::TClient
+{
+    int Fd = -1;
+    std::string Session;                // "unix-<n>", scopes request ids
+    std::thread Reader;
+    std::atomic<bool> Finished{false};  // the reader has returned
+    McpMessageWriter Writer;
+
+    TClient(int fd, std::string session, size_t maxBacklog)
+        : Fd(fd), Session(std::move(session)),
+          Writer([this](const std::string &frame) { return WriteFrame(frame); }, maxBacklog)
+    {
+        Writer.Start();
+    }
+
+    ~TClient()
+    {
+        Writer.Stop();
+        if (Fd >= 0)
+            close(Fd);
+    }
+
+    // Queued; a client too far behind is disconnected
+    bool Send(const std::string &message)
+    {
+        if (Writer.Send(McpLengthFramer::Frame(message)))
+            return true;
+        shutdown(Fd, SHUT_RDWR);                // ends the reader, and the session
+        return false;
+    }
+
+private:
+    // On the writer thread; frames are written whole, one at a time
+    bool WriteFrame(const std::string &frame)
+    {
+        size_t sent = 0;
+        while (sent < frame.size())
+        {
+            ssize_t n = send(Fd, frame.data() + sent, frame.size() - sent, MSG_NOSIGNAL);
+            if (n > 0)
+                sent += static_cast<size_t>(n);
+            else if (n < 0 && errno == EINTR)
+                continue;
+            else
+                return false;                   // the client has gone
+        }
+        return true;
+    }
+};
+
+UnixSocketTransport::UnixSocketTransport(const TUnixSocketConfig &config)
+    : FConfig(config)
+{
+}
+
+UnixSocketTransport::~UnixSocketTransport()
+{
+    Stop();
+}
+
+void UnixSocketTransport::SetRequestHandler(TMcpRequestHandler handler)
+{
+    FHandler = handler;
+}
+
+void UnixSocketTransport::SetSessionEndHandler(TMcpSessionEndHandler handler)
+{
+    FSessionEndHandler = handler;
+}
+
+void UnixSocketTransport::Start()
+{
+    if (FRunning.load())
+        return;
+
+    auto fail = [this](const char *what) {
+        int error = errno;
+        if (FListenFd >= 0)
+            close(FListenFd);
+        FListenFd = -1;
+        throw std::runtime_error(std::string("UnixSocketTransport: ") + what + " " +
+            FConfig.Path + ": " + std::strerror(error));
+    };
+
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (FConfig.Path.empty() || FConfig.Path.size() >= sizeof(address.sun_path))
+        throw std::runtime_error("UnixSocketTransport: invalid path " + FConfig.Path);
+    std::memcpy(address.sun_path, FConfig.Path.c_str(), FConfig.Path.size() + 1);
+
+    // A socket file left by a server that did not stop cleanly
+    struct stat info;
+    if (lstat(FConfig.Path.c_str(), &info) == 0 && S_ISSOCK(info.st_mode))
+        unlink(FConfig.Path.c_str());
+
+    FListenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (FListenFd < 0)
+        fail("socket");
+
+    // Created private: there is no other access check on this path
+    mode_t previousMask = umask(0177);
+    int bound = bind(FListenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    umask(previousMask);
+    if (bound < 0)
+        fail("bind");
+    if (listen(FListenFd, SOMAXCONN) < 0)
+        fail("listen");
+
+    if (FConfig.WorkerThreads > 0)
+        FWorkers = std::make_unique<TMcpWorkerPool>(FConfig.WorkerThreads);
+
+    FStopping = false;
+    FRunning = true;
+    FAcceptThread = std::thread([this]() { AcceptLoop(); });
+}
+
+void UnixSocketTransport::Stop()
+{
+    if (!FRunning.load())
+        return;
+
+    // shutdown() wakes the blocked accept() and every blocked recv()
+    FStopping = true;
+    shutdown(FListenFd, SHUT_RDWR);
+    if (FAcceptThread.joinable())
+        FAcceptThread.join();
+
+    std::vector<std::shared_ptr<TClient>> clients;
+    {
+        std::lock_guard<std::mutex> lock(FClientMutex);
+        clients.swap(FClients);
+    }
+    for (const auto &client : clients)
+        shutdown(client->Fd, SHUT_RDWR);
+    for (const auto &client : clients)
+    {
+        if (client->Reader.joinable())
+            client->Reader.join();
+    }
+
+    // Handlers still queued or running finish; their replies are dropped
+    FWorkers.reset();
+
+    close(FListenFd);
+    FListenFd = -1;
+    unlink(FConfig.Path.c_str());
+    FRunning = false;
+}
+
+void UnixSocketTransport::SendNotification(const std::string &notificationJson)
+{
+    std::vector<std::shared_ptr<TClient>> clients;
+    {
+        std::lock_guard<std::mutex> lock(FClientMutex);
+        clients = FClients;
+    }
+    for (const auto &client : clients)
+    {
+        if (!client->Finished.load())
+            client->Send(notificationJson);
+    }
+}
+
+void UnixSocketTransport::SendNotificationTo(const std::string &session,
+    const std::string &notificationJson)
+{
+    std::shared_ptr<TClient> target;
+    {
+        std::lock_guard<std::mutex> lock(FClientMutex);
+        for (const auto &client : FClients)
+        {
+            if (client->Session == session)
+            {
+                target = client;
+                break;
+            }
+        }
+    }
+    if (target && !target->Finished.load())
+        target->Send(notificationJson);
+}
+
+void UnixSocketTransport::AcceptLoop()
+{
+    while (!FStopping.load())
+    {
+        int fd = accept4(FListenFd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0)
+        {
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            if (errno == EMFILE || errno == ENFILE)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                continue;
+            }
+            return;                             // shut down by Stop
+        }
+
+        JoinFinishedClients();
+
+        auto client = std::make_shared<TClient>(fd, "unix-" + std::to_string(++FClientCount),
+            FConfig.MaxBacklog);
+        std::lock_guard<std::mutex> lock(FClientMutex);
+        if (FStopping.load())
+            return;                             // Stop has taken the list
+        FClients.push_back(client);
+        client->Reader = std::thread([this, client]() { ReadLoop(client); });
+    }
+}
+
+// Clients whose reader has returned leave the list here, on the accept
+// thread, so a server with many short connections does not collect them
+void UnixSocketTransport::JoinFinishedClients()
+{
+    std::vector<std::shared_ptr<TClient>> finished;
+    {
+        std::lock_guard<std::mutex> lock(FClientMutex);
+        auto split = std::stable_partition(FClients.begin(), FClients.end(),
+            [](const std::shared_ptr<TClient> &client) { return !client->Finished.load(); });
+        finished.assign(split, FClients.end());
+        FClients.erase(split, FClients.end());
+    }
+    for (const auto &client : finished)
+        client->Reader.join();
+}
+
+void UnixSocketTransport::ReadLoop(const std::shared_ptr<TClient> &client)
+{
+    McpLengthFramer framer(FConfig.MaxMessageBytes);
+    char chunk[64 * 1024];
+    while (true)
+    {
+        ssize_t n = recv(client->Fd, chunk, sizeof(chunk), 0);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            break;
+
+        framer.Append(chunk, static_cast<size_t>(n));
+        std::string message;
+        TFrameStatus status;
+        while ((status = framer.Next(message)) == TFrameStatus::Message)
+            Dispatch(client, std::move(message));
+        if (status == TFrameStatus::TooLarge)
+        {
+            // The stream cannot be resynchronized after a bad length; the
+            // error goes out before the connection closes
+            client->Send(McpMessageExchange::MakeError(-32600, "Message too large"));
+            client->Writer.Stop();
+            break;
+        }
+    }
+
+    // Replies still pending fail quietly once the peer is gone
+    shutdown(client->Fd, SHUT_RDWR);
+    client->Finished = true;
+    if (FSessionEndHandler)
+        FSessionEndHandler(client->Session);
+}
+
+void UnixSocketTransport::Dispatch(const std::shared_ptr<TClient> &client, std::string message)
+{
+    if (!FWorkers)
+    {
+        std::string reply = McpMessageExchange::Handle(FHandler, std::move(message),
+            client->Session);
+        if (!reply.empty())
+            client->Send(reply);
+        return;
+    }
+
+    auto shared = std::make_shared<std::string>(std::move(message));
+    FWorkers->Submit([this, client, shared]() {
+        MCP_TRACE_SCOPE("unix.request");
+        std::string reply = McpMessageExchange::Handle(FHandler, std::move(*shared),
+            client->Session);
+        if (!reply.empty())
+            client->Send(reply);
+    });
+}
+
+}} // namespace Mcp::Transport
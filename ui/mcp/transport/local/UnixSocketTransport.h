@@ -0,0 +1,101 @@
+//---------------------------------------------------------------------------
+// UnixSocketTransport.h — MCP over a Unix domain socket
+//
+// Messages in both directions are length-prefixed (McpLengthFramer: a
+// 4-byte big-endian length, then the JSON text). Each client connection
+// has a reader thread; handlers run on a shared worker pool, so replies
+// may come back in a different order than the requests. Notifications
+// go to every connected client. What is sent to a client is queued for
+// its own writer thread (McpMessageWriter); one that stops reading is
+// disconnected once MaxBacklog bytes wait for it. The socket file is created with mode
+// 0600: only the user running the server can connect.
+//
+// POSIX (AF_UNIX); not part of ClaBot.cbproj.
+//---------------------------------------------------------------------------
+
+#ifndef UnixSocketTransportH
+#define UnixSocketTransportH
+//---------------------------------------------------------------------------
+#include "../ITransport.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+//---------------------------------------------------------------------------
+
+namespace Mcp {
+
+class TMcpWorkerPool;
+
+namespace Transport {
+
+struct TUnixSocketConfig
+{
+    std::string Path;                    // socket file; replaced if stale
+    unsigned WorkerThreads = 4;          // 0: handlers run on the reader
+    size_t MaxMessageBytes = 16 * 1024 * 1024;
+
+    // Unsent bytes queued for a client that has stopped reading before it
+    // is disconnected
+    size_t MaxBacklog = 4 * 1024 * 1024;
+};
+
+class UnixSocketTransport : public ITransport
+{
+public:
+    explicit UnixSocketTransport(const TUnixSocketConfig &config);
+    ~UnixSocketTransport() override;
+
+    UnixSocketTransport(const UnixSocketTransport&) = delete;
+    UnixSocketTransport& operator=(const UnixSocketTransport&) = delete;
+
+    // Throws std::runtime_error when the path cannot be bound
+    void Start() override;
+
+    // Disconnects every client, waits for handlers in progress and
+    // removes the socket file
+    void Stop() override;
+
+    bool IsRunning() const override { return FRunning.load(); }
+    std::string GetName() const override { return "unix"; }
+    void SetRequestHandler(TMcpRequestHandler handler) override;
+
+    // Sent to every connected client
+    void SendNotification(const std::string &notificationJson) override;
+
+    // Each connection is a session of its own; it ends on disconnect
+    void SendNotificationTo(const std::string &session,
+        const std::string &notificationJson) override;
+    void SetSessionEndHandler(TMcpSessionEndHandler handler) override;
+
+private:
+    struct TClient;
+
+    TUnixSocketConfig FConfig;
+    TMcpRequestHandler FHandler;
+    TMcpSessionEndHandler FSessionEndHandler;
+
+    int FListenFd = -1;
+    std::thread FAcceptThread;
+    std::unique_ptr<TMcpWorkerPool> FWorkers;
+    std::atomic<bool> FRunning{false};
+    std::atomic<bool> FStopping{false};
+
+    std::mutex FClientMutex;
+    std::vector<std::shared_ptr<TClient>> FClients;
+    uint64_t FClientCount = 0;           // accept thread only
+
+    void AcceptLoop();
+    void ReadLoop(const std::shared_ptr<TClient> &client);
+    void Dispatch(const std::shared_ptr<TClient> &client, std::string message);
+    void JoinFinishedClients();
+};
+
+}} // namespace Mcp::Transport
+
+//---------------------------------------------------------------------------
+#endif
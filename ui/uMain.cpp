@@ -105,6 +105,8 @@ void __fastcall TfrmMain::btnCreateAgentClick(TObject *Sender)
             // Clear events
             lvEvents->Items->Clear();
             FEventStore.Clear();
+            if (FMcpServer)
+                FMcpServer->PublishEventCount(0);
             mmoDetails->Clear();
             FSelectedEventIndex = -1;
 
@@ -238,12 +240,16 @@ void TfrmMain::UpdateStatus(const UnicodeString &Status)
     } else {
         StatusBar->Panels->Items[3]->Text = "Session: -";
     }
+    if (FMcpServer)
+        FMcpServer->NotifyStateChanged();
 }
 //---------------------------------------------------------------------------
 void TfrmMain::AddEvent(const TEventData &eventData)
 {
     // Store full event data
     FEventStore.Add(eventData);
+    if (FMcpServer)
+        FMcpServer->PublishEventCount(FEventStore.Count());
 
     // Add to ListView
     TListItem *item = lvEvents->Items->Add();
@@ -284,6 +290,8 @@ void TfrmMain::SetControlsState(bool Connected, bool AgentCreated, bool Running)
     edtPrompt->Enabled = AgentCreated && !Running;
     btnSend->Enabled = AgentCreated && !Running;
     btnStop->Enabled = Running;
+    if (FMcpServer)
+        FMcpServer->NotifyStateChanged();
 }
 //---------------------------------------------------------------------------
 void TfrmMain::UpdateSessionInfo()
@@ -303,6 +311,8 @@ void TfrmMain::UpdateSessionInfo()
 
     // Enable/disable continue radio button based on canResume
     rbContinue->Enabled = FState.CanResume && !FState.Running;
+    if (FMcpServer)
+        FMcpServer->NotifyStateChanged();
 }
 //---------------------------------------------------------------------------
 void TfrmMain::ShowEventDetails(int index)
@@ -359,11 +369,15 @@ void __fastcall TfrmMain::lvEventsSelectItem(TObject *Sender, TListItem *Item, b
 void __fastcall TfrmMain::rbNewSessionClick(TObject *Sender)
 {
     FState.ResumeMode = false;
+    if (FMcpServer)
+        FMcpServer->NotifyStateChanged();
 }
 //---------------------------------------------------------------------------
 void __fastcall TfrmMain::rbContinueClick(TObject *Sender)
 {
     FState.ResumeMode = true;
+    if (FMcpServer)
+        FMcpServer->NotifyStateChanged();
 }
 //---------------------------------------------------------------------------
 UnicodeString TfrmMain::GetStatusText() const
@@ -7,8 +7,10 @@
 
 #include "uMcpServer.h"
 #include "mcp/tools/UiTools.h"
+#include "mcp/tools/UiResources.h"
 #include "mcp/transport/http/HttpRequest.h"
 #include "mcp/transport/http/HttpResponse.h"
+#include "mcp/transport/http/McpSse.h"
 
 //---------------------------------------------------------------------------
 #pragma package(smart_init)
@@ -19,6 +21,30 @@ TUiMcpServer::TUiMcpServer()
     // Create MCP server
     FMcpServer = std::make_unique<Mcp::TMcpServer>("ClaBot-UI-MCP", "1.0.0");
 
+    // Read-only tool calls in a batch run concurrently
+    FMcpServer->SetBatchConcurrency(4);
+
+    // Tool results also go out as structuredContent for clients that read
+    // it. The text block stays: the server speaks MCP 2024-11-05, whose
+    // clients only know content.
+    FMcpServer->SetToolOutputFormat(Mcp::TMcpToolOutputFormat::StructuredWithText);
+
+    // Tools that touch controls run on the VCL thread. They are posted to
+    // the batched executor: calls arriving together share one message-loop
+    // tick, and at most 8 are outstanding at a time so the UI stays responsive.
+    FAlive = std::make_shared<bool>(true);
+    std::shared_ptr<bool> alive = FAlive;
+    FMcpServer->SetMainThreadDispatcher([alive](std::function<void()> func) {
+        Mcp::Tools::MainThreadExecutor().Post([alive, func]() {
+            if (*alive)
+                func();
+        });
+    }, 8);
+
+    // Event count that ui_wait_events waits on
+    FEventCounter = std::make_unique<Mcp::TMcpCounterWaiter>(
+        FMcpServer->GetTimerService());
+
     // Create HTTP server
     FHttpServer = std::make_unique<TIdHTTPServer>(nullptr);
 
@@ -31,24 +57,55 @@ TUiMcpServer::TUiMcpServer()
     // Set up HTTP event handler
     FHttpServer->OnCommandGet = OnCommandGet;
 
-    // Set up MCP request handler
+    // Set up MCP request handler. Progress of a tools/call (ui_wait_events)
+    // streams back as SSE events when the client accepts them; otherwise
+    // the response is plain JSON. The connection thread leaves the handler
+    // as soon as a stream starts and writes its events as they come; the
+    // result finishes the stream. The client's Mcp-Session-Id scopes its
+    // request ids, so it can only cancel its own requests.
     FTransport->SetRequestHandler(
         [this](Mcp::Transport::ITransportRequest &req,
                Mcp::Transport::ITransportResponse &resp) {
-            std::string body = req.GetBody();
-            std::string result = FMcpServer->HandleRequest(body);
-
-            resp.SetStatus(200, "OK");
-            resp.SetContentType("application/json; charset=utf-8");
-            resp.SetBody(result);
+            auto out = std::make_shared<Mcp::Transport::McpSseResponse>(req, resp);
+            FMcpServer->HandleRequestAsync(req.GetBody(),
+                [out](const std::string &result) { out->Finish(result); },
+                [out](const std::string &notification) {
+                    out->SendNotification(notification);
+                },
+                req.GetHeader("Mcp-Session-Id"));
+            out->Wait();
         }
     );
+
+    // List changes go to every GET /mcp event stream, resource updates to
+    // the streams of the sessions subscribed to them
+    FMcpServer->SetOnNotification([this](const std::string &notification) {
+        if (FTransport)
+            FTransport->SendNotification(notification);
+    });
+    FMcpServer->SetOnSessionNotification(
+        [this](const std::string &session, const std::string &notification) {
+            if (FTransport)
+                FTransport->SendNotificationTo(session, notification);
+        });
+    FTransport->SetSessionEndHandler([this](const std::string &session) {
+        FMcpServer->EndSession(session);
+    });
 }
 
 //---------------------------------------------------------------------------
 TUiMcpServer::~TUiMcpServer()
 {
     Stop();
+    if (FAlive)
+        *FAlive = false;
+
+    // The transport goes first; late timer notifications find no handler
+    if (FMcpServer)
+    {
+        FMcpServer->SetOnNotification(nullptr);
+        FMcpServer->SetOnSessionNotification(nullptr);
+    }
 }
 
 //---------------------------------------------------------------------------
@@ -70,6 +127,9 @@ void TUiMcpServer::Start(int port)
 //---------------------------------------------------------------------------
 void TUiMcpServer::Stop()
 {
+    // Release waiting calls first: stopping Indy waits for its connections
+    if (FEventCounter)
+        FEventCounter->CancelAll();
     if (FTransport)
         FTransport->Stop();
 }
@@ -83,8 +143,35 @@ bool TUiMcpServer::IsRunning() const
 //---------------------------------------------------------------------------
 void TUiMcpServer::RegisterUiTools(IAppState *appState)
 {
-    if (FMcpServer && appState)
-        Mcp::Tools::RegisterUiTools(*FMcpServer, appState);
+    if (!FMcpServer || !appState)
+        return;
+
+    Mcp::Tools::RegisterUiTools(*FMcpServer, appState, *FEventCounter);
+    Mcp::Tools::RegisterUiResources(*FMcpServer, appState);
+
+    // Agents poll these in tight loops; answer repeats without a trip to
+    // the main thread. The TTL bounds staleness for edits made by hand.
+    const std::chrono::milliseconds cacheTtl(250);
+    FMcpServer->EnableResultCache("ui_get_status", cacheTtl);
+    FMcpServer->EnableResultCache("ui_get_all", cacheTtl);
+    FMcpServer->EnableResultCache("ui_get_session", cacheTtl);
+}
+
+//---------------------------------------------------------------------------
+void TUiMcpServer::PublishEventCount(int count)
+{
+    NotifyStateChanged();
+    if (FEventCounter)
+        FEventCounter->Publish(count);
+    if (FMcpServer)
+        FMcpServer->NotifyResourceUpdated(Mcp::Tools::EventsResourceUri);
+}
+
+//---------------------------------------------------------------------------
+void TUiMcpServer::NotifyStateChanged()
+{
+    if (FMcpServer)
+        FMcpServer->BumpStateGeneration();
 }
 
 //---------------------------------------------------------------------------
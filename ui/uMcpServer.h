@@ -35,17 +35,29 @@ public:
     // Check if server is running
     bool IsRunning() const;
 
-    // Register UI tools (call after Start, before using)
+    // Register UI tools and the event log resources (call after Start, before using)
     void RegisterUiTools(IAppState *appState);
 
     // Get the MCP server (for additional tool registration)
     Mcp::TMcpServer* GetMcpServer() { return FMcpServer.get(); }
 
+    // Report the current number of events (call on every change);
+    // wakes ui_wait_events callers and clabot://events subscribers
+    void PublishEventCount(int count);
+
+    // Report any other UI state change (status bar, buttons, session);
+    // drops cached results of the polling tools
+    void NotifyStateChanged();
+
 private:
     std::unique_ptr<TIdHTTPServer> FHttpServer;
     std::unique_ptr<Mcp::TMcpServer> FMcpServer;
+    std::unique_ptr<Mcp::TMcpCounterWaiter> FEventCounter;
     std::unique_ptr<Mcp::Transport::HttpTransport> FTransport;
 
+    // Cleared on destruction; main-thread calls posted earlier are dropped
+    std::shared_ptr<bool> FAlive;
+
     // Indy event handler
     void __fastcall OnCommandGet(TIdContext *AContext,
         TIdHTTPRequestInfo *ARequestInfo, TIdHTTPResponseInfo *AResponseInfo);